@@ -149,14 +149,14 @@ namespace v1 {
 static std::vector<unsigned char> generate_sequence(size_t size){
   std::vector<unsigned char> v(size);
   unsigned int seed = 0;
-  for(int i=0; i<v[i]; i++){
+  for(size_t i=0; i<v.size(); i++){
     v[i] = rand_r(&seed) & 0xFF;
   }
   return v;
 }
 
 #define MIN_SIZE (1 << 5)
-#define MAX_SIZE (1 << 10)
+#define MAX_SIZE (1 << 16)
 
 static const std::vector<unsigned char> data = generate_sequence(MAX_SIZE);
 
@@ -170,8 +170,39 @@ static void base64_iroha_encode(benchmark::State& state) {
   while (state.KeepRunning()) {
     base64::vendor::base64_encode(data.data(), state.range(0));
   }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void base64_simd_encode(benchmark::State& state) {
+  const std::vector<unsigned char> message(data.begin(),
+                                           data.begin() + state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(base64::encode(message));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void base64_iroha_decode(benchmark::State& state) {
+  const std::string encoded =
+      base64::vendor::base64_encode(data.data(), state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(base64::vendor::base64_decode(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+static void base64_simd_decode(benchmark::State& state) {
+  const std::string encoded =
+      base64::vendor::base64_encode(data.data(), state.range(0));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(base64::decode(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
 }
 
 BENCHMARK(base64_iroha_encode)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(base64_simd_encode)->Range(MIN_SIZE, MAX_SIZE);
 BENCHMARK(base64_v1_encode)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(base64_iroha_decode)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(base64_simd_decode)->Range(MIN_SIZE, MAX_SIZE);
 BENCHMARK_MAIN();
@@ -0,0 +1,69 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <crypto/hash.hpp>
+#include <main_generated.h>
+#include <service/flatbuffer_service.h>
+
+static std::vector<uint8_t> generate_tx() {
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto currency = flatbuffer_service::asset::CreateCurrency(
+      "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+  std::vector<uint8_t> sigblob(64, 'a');
+  std::vector<flatbuffers::Offset<::iroha::Signature>> signatures{
+      ::iroha::CreateSignatureDirect(fbb, "TxPubKey1", &sigblob, 100000)};
+  std::vector<uint8_t> data(256, 'd');
+
+  fbb.Finish(::iroha::CreateTransactionDirect(
+      fbb, "Creator PubKey", iroha::Command::Add,
+      ::iroha::CreateAddDirect(fbb, "AccPubKey", &currency).Union(),
+      &signatures, nullptr, 100000,
+      ::iroha::CreateAttachmentDirect(fbb, "text/plain", &data)));
+  return {fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize()};
+}
+
+static const std::vector<uint8_t> txbuf = generate_tx();
+static const std::string root =
+    "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a";
+
+static void TX_digest_toString(benchmark::State& state) {
+  const auto tx = flatbuffers::GetRoot<::iroha::Transaction>(txbuf.data());
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(
+        hash::sha3_256_hex(flatbuffer_service::toString(*tx) + root));
+  }
+}
+
+static void TX_digest_canonical(benchmark::State& state) {
+  const auto tx = flatbuffers::GetRoot<::iroha::Transaction>(txbuf.data());
+  while (state.KeepRunning()) {
+    hash::Sha3_256 sha;
+    flatbuffer_service::transaction::absorbSignedFields(sha, *tx);
+    sha.update(root);
+    benchmark::DoNotOptimize(sha.hexdigest());
+  }
+}
+
+/**
+ * Old sumeragi::detail::hash (pretty-printed string) against the
+ * streaming canonical digest.
+ */
+BENCHMARK(TX_digest_toString);
+BENCHMARK(TX_digest_canonical);
+
+BENCHMARK_MAIN();
@@ -18,24 +18,66 @@
 #ifndef IROHA_REPOSITORY_H
 #define IROHA_REPOSITORY_H
 
+#include <crypto/hash.hpp>
 #include <main_generated.h>
+#include <functional>
+#include <vector>
 
 namespace repository {
 void init();
 
+// run apply on the writer thread, the only one that writes the store; no
+// other write happens between the appends, commits and uncommitted reads
+// made inside it
+void write(const std::function<void()>& apply);
+
 void append(const iroha::Transaction& tx);
 
+// make the transactions appended so far visible to readers
+void commit();
+
 std::vector<const iroha::Asset*> findAssetByPublicKey(
     const flatbuffers::String& key);
 
-bool existAccountOf(const flatbuffers::String& key);
+// uncommitted also sees appended transactions and is served by the writer
+// thread; otherwise it reads the committed state on the calling thread
+bool existAccountOf(const flatbuffers::String& key, bool uncommitted = false);
 
 bool checkUserCanPermission(const flatbuffers::String& key);
 
-const std::string getMerkleRoot();
+hash::Hash32 getMerkleRoot();
 
 const ::iroha::Transaction* getTransaction(size_t index);
 
+// index of the last committed transaction, indices start at 1
+size_t getTransactionCount();
+
+// visit committed transactions [from, to) as raw flatbuffers, until visit
+// returns false; data is valid only inside visit
+void forEachTransaction(
+    size_t from, size_t to,
+    const std::function<bool(size_t, const uint8_t*, size_t)>& visit);
+
+// append already committed transactions of another peer and commit them
+void appendBatch(std::vector<std::vector<uint8_t>>& txs);
+
+// merkle root over the hashes of committed transactions [from, to)
+hash::Hash32 getRangeRoot(size_t from, size_t to);
+
+// the same root over transactions received from another peer
+hash::Hash32 rangeRootOf(const std::vector<std::vector<uint8_t>>& txs);
+
+// nodes [first, first + count) of the given level of the merkle tree over
+// committed transactions [1, to); a node of level l covers 2^l transactions
+std::vector<hash::Hash32> getMerkleNodes(size_t to, size_t level, size_t first,
+                                         size_t count);
+
+// drop committed transactions from index from on. The state has no undo,
+// so [1, from) is replayed into a fresh store; call it on a stopped peer.
+// Calls from other threads wait for the replay; pointers they got before
+// still point into the old store, which stays mapped until exit.
+void truncate(size_t from);
+
 namespace front_repository {
 void initialize_repository();
 }
@@ -48,6 +90,13 @@ std::vector<const iroha::AccountPermissionDomain*> getPermissionDomainOf(
     const flatbuffers::String& key);
 std::vector<const iroha::AccountPermissionAsset*> getPermissionAssetOf(
     const flatbuffers::String& key);
+// bitmask of ametsuchi::permission::Capability, uncommitted as for
+// existAccountOf
+uint8_t getAssetCapabilitiesOf(const flatbuffers::String& key,
+                               const flatbuffers::String& ledger_name,
+                               const flatbuffers::String& domain_name,
+                               const flatbuffers::String& asset_name,
+                               bool uncommitted = false);
 };
 };
 
@@ -24,15 +24,107 @@
 #include <crypto/hash.hpp>
 #include <service/flatbuffer_service.h>
 #include <service/connection.hpp>
+#include <utils/logger.hpp>
+#include <utils/metrics.hpp>
+#include <utils/tracing.hpp>
+#include <thread_pool.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <future>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sys/stat.h>
+#include <unistd.h>
 
 namespace repository {
 
 static std::unique_ptr<ametsuchi::Ametsuchi> db;
 const std::string folder = "/tmp/ametsuchi/";
 
+namespace {
+// db is replaced under an exclusive lock, every other use holds it shared:
+// gRPC threads read it while truncate() swaps it
+std::shared_timed_mutex db_mutex;
+
+// stores truncate() replaced. getTransaction, findAssetByPublicKey and the
+// permission getters return pointers into the mapping, which callers keep
+// after the lock is gone, so a replaced store is never closed; its files
+// are already unlinked and it is never written again
+std::vector<std::unique_ptr<ametsuchi::Ametsuchi>> retired;
+using Shared = std::shared_lock<std::shared_timed_mutex>;
+using Exclusive = std::unique_lock<std::shared_timed_mutex>;
+
+void replaceDb(std::unique_ptr<ametsuchi::Ametsuchi> next) {
+  Exclusive lock(db_mutex);
+  db = std::move(next);
+}
+
+// LMDB binds a write transaction to the thread that began it, and
+// Ametsuchi begins the next append transaction in commit(): the store is
+// opened, written, read uncommitted and closed on this thread only, which
+// also keeps the executor and the synchronizer from interleaving writes
+ThreadPool &writer() {
+  static ThreadPool pool(ThreadPoolOptions{
+      .threads_count = 1, .worker_queue_size = 1024,
+  });
+  return pool;
+}
+thread_local bool onWriter = false;
+
+// runs f on the writer thread and waits for it; f must not wait for
+// db_mutex held by its caller, so callers take the lock inside f
+template <class F>
+auto onWriterThread(F &&f) -> decltype(f()) {
+  if (onWriter) return f();
+  std::packaged_task<decltype(f())()> task(std::forward<F>(f));
+  auto result = task.get_future();
+  writer().process([&task] {
+    onWriter = true;
+    task();
+  });
+  return result.get();
+}
+
+void appendBatchLocked(std::vector<std::vector<uint8_t>> &txs);
+void commitLocked();
+
+metrics::Histogram &latency(const char *op) {
+  return metrics::histogram("iroha_ametsuchi_seconds",
+                            "Time of an Ametsuchi write", {{"op", op}});
+}
+metrics::Histogram &appendLatency = latency("append");
+metrics::Histogram &commitLatency = latency("commit");
+
+void collectStat(const std::string &name, const std::string &help,
+                 const metrics::Labels &labels,
+                 size_t (*field)(const MDB_stat &)) {
+  metrics::collect(name, help, metrics::Type::Gauge, labels, [field] {
+    Shared lock(db_mutex);
+    return db == nullptr ? 0.0 : static_cast<double>(field(db->stat()));
+  });
+}
+
+void collectStats() {
+  collectStat("iroha_lmdb_entries", "Entries of the LMDB main database", {},
+              [](const MDB_stat &st) -> size_t { return st.ms_entries; });
+  collectStat("iroha_lmdb_depth", "Depth of the LMDB main B-tree", {},
+              [](const MDB_stat &st) -> size_t { return st.ms_depth; });
+  collectStat("iroha_lmdb_page_size_bytes", "LMDB page size", {},
+              [](const MDB_stat &st) -> size_t { return st.ms_psize; });
+  collectStat("iroha_lmdb_pages", "Pages of the LMDB main database",
+              {{"type", "branch"}},
+              [](const MDB_stat &st) -> size_t { return st.ms_branch_pages; });
+  collectStat("iroha_lmdb_pages", "Pages of the LMDB main database",
+              {{"type", "leaf"}},
+              [](const MDB_stat &st) -> size_t { return st.ms_leaf_pages; });
+  collectStat("iroha_lmdb_pages", "Pages of the LMDB main database",
+              {{"type", "overflow"}},
+              [](const MDB_stat &st) -> size_t { return st.ms_overflow_pages; });
+}
+}  // namespace
+
 void init() {
   struct stat st;
   int ret = stat((folder + "data.mdb").c_str(), &st);
@@ -46,82 +138,275 @@ void init() {
     std::cout << folder + "lock.mdb already exists.\n";
     exit(0);
   }
-  db = std::make_unique<ametsuchi::Ametsuchi>(folder);
+  onWriterThread(
+    [] { replaceDb(std::make_unique<ametsuchi::Ametsuchi>(folder)); });
+  collectStats();
 }
 
+namespace {
+// a shared lock on db, opened first if it is not yet
+Shared sharedDb() {
+  Shared lock(db_mutex);
+  if (db == nullptr) {
+    lock.unlock();
+    init();
+    lock.lock();
+  }
+  return lock;
+}
+}  // namespace
+
+void write(const std::function<void()> &apply) { onWriterThread(apply); }
+
 void append(const iroha::Transaction &tx) {
   auto buf = flatbuffer_service::transaction::GetTxPointer(tx);
-  db->append(&buf.value());
+  metrics::ScopedTimer timing(appendLatency);
+  tracing::Span span("ametsuchi.append");
+  onWriterThread([&] {
+    Shared lock(db_mutex);
+    db->append(&buf.value());
+  });
+}
+
+void commit() {
+  onWriterThread([] {
+    Shared lock(db_mutex);
+    commitLocked();
+  });
 }
 
 const ::iroha::Transaction *getTransaction(size_t index) {
+  Shared lock(db_mutex);
   return db->getTransaction(index, false);
 }
 
+size_t getTransactionCount() {
+  Shared lock(db_mutex);
+  if (db == nullptr) return 0;
+  return db->getTransactionCount();
+}
+
+void forEachTransaction(
+  size_t from, size_t to,
+  const std::function<bool(size_t, const uint8_t *, size_t)> &visit) {
+  Shared lock(db_mutex);
+  if (db == nullptr) return;
+  db->getTransactionRange(
+    from, to, [&](size_t index, const ametsuchi::AM_val &tx) {
+      return visit(index, static_cast<const uint8_t *>(tx.data), tx.size);
+    });
+}
+
+void appendBatch(std::vector<std::vector<uint8_t>> &txs) {
+  onWriterThread([&] {
+    Shared lock(db_mutex);
+    appendBatchLocked(txs);
+  });
+}
+
+namespace {
+void appendBatchLocked(std::vector<std::vector<uint8_t>> &txs) {
+  std::vector<std::vector<uint8_t> *> batch;
+  batch.reserve(txs.size());
+  for (auto &tx : txs) batch.push_back(&tx);
+  {
+    metrics::ScopedTimer timing(appendLatency);
+    db->append(batch);
+  }
+  commitLocked();
+}
+
+void commitLocked() {
+  metrics::ScopedTimer timing(commitLatency);
+  tracing::Span span("ametsuchi.commit");
+  db->commit();
+}
+
+// the leaf tx_store pushes to its merkle tree
+ametsuchi::merkle::hash_t leafOf(const uint8_t *data, size_t size) {
+  ametsuchi::merkle::hash_t leaf{};
+  auto hash = flatbuffers::GetRoot<iroha::Transaction>(data)->hash();
+  if (hash != nullptr && hash->size() == leaf.size()) {
+    std::copy(hash->begin(), hash->end(), leaf.begin());
+  } else {
+    leaf = ametsuchi::merkle::MerkleTree::hash(data, size);
+  }
+  return leaf;
+}
+}  // namespace
+
+hash::Hash32 getRangeRoot(size_t from, size_t to) {
+  std::vector<ametsuchi::merkle::hash_t> leafs;
+  if (to > from) leafs.reserve(to - from);
+  forEachTransaction(from, to,
+                     [&](size_t, const uint8_t *data, size_t size) {
+                       leafs.push_back(leafOf(data, size));
+                       return true;
+                     });
+  return hash::Hash32{ametsuchi::merkle::MerkleTree::root_of(std::move(leafs))};
+}
+
+hash::Hash32 rangeRootOf(const std::vector<std::vector<uint8_t>> &txs) {
+  std::vector<ametsuchi::merkle::hash_t> leafs;
+  leafs.reserve(txs.size());
+  for (auto &tx : txs) leafs.push_back(leafOf(tx.data(), tx.size()));
+  return hash::Hash32{ametsuchi::merkle::MerkleTree::root_of(std::move(leafs))};
+}
+
+std::vector<hash::Hash32> getMerkleNodes(size_t to, size_t level, size_t first,
+                                         size_t count) {
+  const size_t width = size_t(1) << level;
+  const size_t from = first * width + 1;
+  const size_t end = std::min(to, (first + count) * width + 1);
+  if (from >= end) return {};
+
+  std::vector<ametsuchi::merkle::hash_t> leafs;
+  leafs.reserve(end - from);
+  forEachTransaction(from, end, [&](size_t, const uint8_t *data, size_t size) {
+    leafs.push_back(leafOf(data, size));
+    return true;
+  });
+
+  std::vector<hash::Hash32> nodes;
+  for (auto &node :
+       ametsuchi::merkle::MerkleTree::level_of(std::move(leafs), level)) {
+    nodes.push_back(hash::Hash32{node});
+  }
+  return nodes;
+}
+
+void truncate(size_t from) {
+  onWriterThread([from] {
+    const std::string old_folder =
+      folder.substr(0, folder.size() - 1) + ".truncated/";
+
+    // readers wait for the replay instead of reading a partial db
+    Exclusive lock(db_mutex);
+    if (rename(folder.c_str(), old_folder.c_str()) != 0) {
+      logger::error("repository") << "can not move " << folder;
+      return;
+    }
+
+    // the old store stays open: its files move, its mapping does not
+    auto old = std::move(db);
+    db = std::make_unique<ametsuchi::Ametsuchi>(folder);
+
+    // replay in batches, one commit each
+    const size_t batch_size = 1024;
+    for (size_t begin = 1; begin < from; begin += batch_size) {
+      std::vector<std::vector<uint8_t>> txs;
+      old->getTransactionRange(
+        begin, std::min(from, begin + batch_size),
+        [&](size_t, const ametsuchi::AM_val &tx) {
+          auto data = static_cast<const uint8_t *>(tx.data);
+          txs.emplace_back(data, data + tx.size);
+          return true;
+        });
+      if (txs.empty()) break;
+      appendBatchLocked(txs);
+    }
+
+    std::remove((old_folder + "data.mdb").c_str());
+    std::remove((old_folder + "lock.mdb").c_str());
+    rmdir(old_folder.c_str());
+    retired.push_back(std::move(old));
+    logger::info("repository") << "truncated to " << db->getTransactionCount()
+                               << " transactions";
+  });
+}
+
 std::vector<const iroha::Asset *> findAssetByPublicKey(
   const flatbuffers::String &key) {
-  flatbuffers::FlatBufferBuilder fbb;
+  Shared lock(db_mutex);
   return db->accountGetAllAssets(&key);
 }
 
-bool existAccountOf(const flatbuffers::String &key) {
-  return false;
+bool existAccountOf(const flatbuffers::String &key, bool uncommitted) {
+  if (uncommitted) {
+    return onWriterThread([&] {
+      Shared lock(db_mutex);
+      return db->accountExists(&key, true);
+    });
+  }
+  Shared lock(db_mutex);
+  return db->accountExists(&key, false);
 }
 
 bool checkUserCanPermission(const flatbuffers::String &key) {
   return false;
 }
 
-const std::string getMerkleRoot() {
-  if (db == nullptr) return "";
-  return hash::sha3_256_hex(std::vector<uint8_t>{
-    db->getMerkleRoot().begin(), db->getMerkleRoot().end()});
+hash::Hash32 getMerkleRoot() {
+  Shared lock(db_mutex);
+  if (db == nullptr) return hash::Hash32{};
+  return hash::Hash32{db->getMerkleRoot()};
 }
 
 namespace permission {
 
 std::vector<const iroha::AccountPermissionLedger *> getPermissionLedgerOf(
   const flatbuffers::String &key) {
+  Shared lock(db_mutex);
   return db->assetGetPermissionLedger(&key);
 }
 
 std::vector<const iroha::AccountPermissionDomain *> getPermissionDomainOf(
   const flatbuffers::String &key) {
+  Shared lock(db_mutex);
   return db->assetGetPermissionDomain(&key);
 }
 
 std::vector<const iroha::AccountPermissionAsset *> getPermissionAssetOf(
   const flatbuffers::String &key) {
+  Shared lock(db_mutex);
   return db->assetGetPermissionAsset(&key);
 }
+
+uint8_t getAssetCapabilitiesOf(const flatbuffers::String &key,
+                               const flatbuffers::String &ledger_name,
+                               const flatbuffers::String &domain_name,
+                               const flatbuffers::String &asset_name,
+                               bool uncommitted) {
+  const auto get = [&] {
+    Shared lock(db_mutex);
+    return db->assetGetCapabilities(&key, &ledger_name, &domain_name,
+                                    &asset_name, uncommitted);
+  };
+  return uncommitted ? onWriterThread(get) : get();
+}
 }
 namespace front_repository {
 void initialize_repository() {
   connection::iroha::AssetRepositoryImpl::AccountGetAsset::receive(
-    [=](const std::string & /* from */, flatbuffers::unique_ptr_t &&query_ptr)
-      -> std::vector<const ::iroha::Asset *> {
-      const iroha::AssetQuery &query =
-        *flatbuffers::GetRoot<iroha::AssetQuery>(query_ptr.get());
-      auto ln = query.ledger_name();
-      auto dn = query.domain_name();
-      auto an = query.asset_name();
-      if (ln == nullptr || dn == nullptr || an == nullptr) {
-        return db->accountGetAllAssets(query.pubKey(), query.uncommitted());
+    [=](const std::string & /* from */, const iroha::AssetQuery &query,
+        const connection::iroha::AssetRepositoryImpl::AccountGetAsset::
+          AssetVisitor &visit) {
+      // a null name means every asset of the account
+      const auto get = [&] {
+        Shared lock(db_mutex);
+        db->accountVisitAssets(
+          query.pubKey(), query.ledger_name(), query.domain_name(),
+          query.asset_name(),
+          [&](const ametsuchi::AM_val &val) {
+            visit(static_cast<const uint8_t *>(val.data), val.size);
+          },
+          query.uncommitted());
+      };
+      if (query.uncommitted()) {
+        onWriterThread(get);
       } else {
-        std::vector<const ::iroha::Asset *> res{db->accountGetAsset(
-          query.pubKey(), ln, dn, an, query.uncommitted())};
-        return res;
+        get();
       }
     });
 }
 
 bool existAccountOf(const flatbuffers::String &key) {
-  if (db == nullptr) init();
+  auto lock = sharedDb();
   return false;
 }
 
 bool checkUserCanPermission(const flatbuffers::String &key) {
-  if (db == nullptr) init();
+  auto lock = sharedDb();
 
   return false;
 }
@@ -129,17 +414,17 @@ bool checkUserCanPermission(const flatbuffers::String &key) {
 namespace permission {
 
 std::vector<const iroha::AccountPermissionLedger*> getPermissionLedgerOf(const flatbuffers::String &key) {
-  if (db == nullptr) init();
+  auto lock = sharedDb();
   return db->assetGetPermissionLedger(&key);
 }
 
 std::vector<const iroha::AccountPermissionDomain*> getPermissionDomainOf(const flatbuffers::String &key) {
-  if (db == nullptr) init();
+  auto lock = sharedDb();
   return db->assetGetPermissionDomain(&key);
 }
 
 std::vector<const iroha::AccountPermissionAsset*> getPermissionAssetOf(const flatbuffers::String &key){
-  if (db == nullptr) init();
+  auto lock = sharedDb();
   return db->assetGetPermissionAsset(&key);
 }
 
@@ -148,23 +433,18 @@ std::vector<const iroha::AccountPermissionAsset*> getPermissionAssetOf(const fla
 namespace front_repository{
 void initialize_repository(){
   connection::iroha::AssetRepositoryImpl::AccountGetAsset::receive([=](
-    const std::string & /* from */, flatbuffers::unique_ptr_t &&query_ptr) -> std::vector<const ::iroha::Asset *>{
-    if(db == nullptr) init();
-    const iroha::AssetQuery& query = *flatbuffers::GetRoot<iroha::AssetQuery>(query_ptr.get());
-    auto ln = query.ledger_name();
-    auto dn = query.domain_name();
-    auto an = query.asset_name();
-    if(ln == nullptr || dn == nullptr || an == nullptr) {
-      return db->accountGetAllAssets(query.pubKey(), query.uncommitted());
-    }else{
-      std::vector<const ::iroha::Asset *> res{db->accountGetAsset(query.pubKey(), ln, dn, an, query.uncommitted())};
-      return res;
-    }
+    const std::string & /* from */, const iroha::AssetQuery &query,
+    const connection::iroha::AssetRepositoryImpl::AccountGetAsset::AssetVisitor &visit){
+    auto lock = sharedDb();
+    db->accountVisitAssets(query.pubKey(), query.ledger_name(), query.domain_name(),
+      query.asset_name(), [&](const ametsuchi::AM_val &val){
+        visit(static_cast<const uint8_t *>(val.data), val.size);
+      }, query.uncommitted());
   });
 
   connection::memberShipService::SyncImpl::getTransactions::receive([=](
     const std::string & /* from */, flatbuffers::unique_ptr_t &&query_ptr) -> std::vector<const ::iroha::Transaction*>{
-    if(db == nullptr) init();
+    auto lock = sharedDb();
     const iroha::Ping& ping = *flatbuffers::GetRoot<iroha::Ping>(query_ptr.get());
     std::vector<const ::iroha::Transaction*> ret;
     size_t index = stoi(ping.message()->str());
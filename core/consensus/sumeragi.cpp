@@ -18,21 +18,33 @@
 #include <infra/config/iroha_config_with_json.hpp>
 #include <infra/config/peer_service_with_json.hpp>
 #include <membership_service/peer_service.hpp>
-#include <thread_pool.hpp>
 #include <utils/explore.hpp>
 #include <utils/logger.hpp>
+#include <utils/metrics.hpp>
+#include <utils/priority_pool.hpp>
+#include <utils/probes.hpp>
 #include <utils/timer.hpp>
+#include <utils/tracing.hpp>
 #include <runtime/runtime.hpp>
 
+#include <endpoint_generated.h>
 #include <main_generated.h>
+#include <thread_pool.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <cstring>
 #include <deque>
+#include <future>
 #include <map>
+#include <mutex>
+#include <numeric>
 #include <queue>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <ametsuchi/repository.hpp>
 #include <service/connection.hpp>
 #include "sumeragi.hpp"
@@ -56,21 +68,117 @@ namespace sumeragi {
     using iroha::Signature;
     using iroha::Transaction;
 
-    std::map<std::string, std::string> txCache;
+    std::unordered_map<hash::Hash32, std::string> txCache;
+
+    // votes and commits of other peers run on the Consensus lane, client
+    // transactions on the Ingress lane, so a flood of clients can't delay a round
+    static scheduling::PriorityPoolOptions poolOptions() {
+        auto& config = config::IrohaConfigManager::getInstance();
+        scheduling::PriorityPoolOptions options;
+        options.threads = config.getConcurrency(0);
+        options.reserved = config.getSumeragiReservedWorkers(1);
+        options.queueSize[static_cast<size_t>(scheduling::Lane::Consensus)] =
+                config.getSumeragiLaneQueueSize("consensus", 4096);
+        options.queueSize[static_cast<size_t>(scheduling::Lane::Ingress)] =
+                config.getSumeragiLaneQueueSize("ingress", 1024);
+        options.cpus = config.getSumeragiCpuAffinity({});
+        return options;
+    }
+
+    static scheduling::PriorityPool pool(poolOptions());
 
-    static ThreadPool pool(ThreadPoolOptions{
-        .threads_count =
-                 config::IrohaConfigManager::getInstance().getConcurrency(0),
-        .worker_queue_size =
-                 config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
-    });
+    namespace stats {
+        metrics::Counter& toriiReceived = metrics::counter(
+                "iroha_torii_transactions_total", "Transactions received from clients");
+        metrics::Counter& toriiRejected = metrics::counter(
+                "iroha_torii_rejected_total", "Client transactions refused, the ingress lane was full");
+        metrics::Counter& committed = metrics::counter(
+                "iroha_sumeragi_committed_transactions_total", "Transactions a commit appended to the ledger");
+
+        metrics::Histogram& stage(const std::string& name) {
+            return metrics::histogram("iroha_sumeragi_stage_seconds",
+                                      "Time spent in each step of a consensus round",
+                                      {{"stage", name}});
+        }
+        metrics::Histogram& process = stage("process");
+        metrics::Histogram& apply = stage("apply");
+        metrics::Histogram& resolve = stage("resolve");
+
+        void collectPool() {
+            const std::pair<const char*, scheduling::Lane> lanes[] = {
+                    {"consensus", scheduling::Lane::Consensus},
+                    {"ingress", scheduling::Lane::Ingress}};
+            for (const auto& lane : lanes) {
+                const auto l = lane.second;
+                const metrics::Labels labels{{"lane", lane.first}};
+                metrics::collect("iroha_sumeragi_queue_depth", "Tasks waiting in a lane",
+                                 metrics::Type::Gauge, labels,
+                                 [l] { return pool.stats(l).depth; });
+                metrics::collect("iroha_sumeragi_queue_executed_total", "Tasks run from a lane",
+                                 metrics::Type::Counter, labels,
+                                 [l] { return pool.stats(l).executed; });
+                metrics::collect("iroha_sumeragi_queue_rejected_total",
+                                 "Tasks refused, the lane was full",
+                                 metrics::Type::Counter, labels,
+                                 [l] { return pool.stats(l).rejected; });
+                metrics::collect("iroha_sumeragi_queue_wait_seconds_mean",
+                                 "Mean time a task waited in a lane",
+                                 metrics::Type::Gauge, labels,
+                                 [l] { return pool.stats(l).meanWaitMicros * 1e-6; });
+                metrics::collect("iroha_sumeragi_queue_wait_seconds_max",
+                                 "Longest time a task waited in a lane",
+                                 metrics::Type::Gauge, labels,
+                                 [l] { return pool.stats(l).maxWaitMicros * 1e-6; });
+            }
+        }
+    }  // namespace stats
 
     namespace detail {
 
-        std::string hash(const Transaction& tx, const std::string& root) {
-            return hash::sha3_256_hex(flatbuffer_service::toString(tx) + root);
+        hash::Hash32 hash(const Transaction& tx, const hash::Hash32& root) {
+            hash::Sha3_256 sha;
+            flatbuffer_service::transaction::absorbSignedFields(sha, tx);
+            sha.update(root.data(), root.size());
+            return sha.digest();
         };
 
+        // the same on every peer whatever its ledger, to tell transactions apart
+        hash::Hash32 digest(const Transaction& tx) {
+            hash::Sha3_256 sha;
+            flatbuffer_service::transaction::absorbSignedFields(sha, tx);
+            return sha.digest();
+        }
+
+        /**
+         * Trace of the transaction of an event: the span running on this
+         * thread if it traces the same transaction, else the one the sender
+         * put in the event, else a new trace sampled by the transaction
+         * digest.
+         */
+        tracing::Context traceOf(const ConsensusEvent& event) {
+            if (!tracing::enabled()) return {};
+            tracing::TraceId id;
+            if (event.transactions() != nullptr && event.transactions()->size() != 0) {
+                const auto tx = event.transactions()->Get(0)->tx();
+                if (tx == nullptr) return {};
+                const auto digest = hash::sha3_256(tx->data(), tx->size());
+                std::memcpy(id.data(), digest.data(), id.size());
+            } else if (event.digests() != nullptr && event.digests()->size() >= id.size()) {
+                std::memcpy(id.data(), event.digests()->data(), id.size());
+            } else {
+                return {};
+            }
+
+            const auto current = tracing::current();
+            if (current.sampled && current.trace == id) return current;
+            auto context = tracing::root(id);
+            if (event.trace() != nullptr) {
+                context.span = event.trace()->span();
+                context.sampled = event.trace()->sampled();
+            }
+            return context;
+        }
+
         bool eventSignatureIsEmpty(const ::iroha::ConsensusEvent& event) {
             if (event.peerSignatures() != nullptr) {
                 return event.peerSignatures()->size() == 0;
@@ -79,19 +187,101 @@ namespace sumeragi {
             }
         }
 
+        bool hasSignatureOf(const ::iroha::ConsensusEvent& event,
+                            const std::string& publicKey) {
+            if (event.peerSignatures() == nullptr) return false;
+            for (const auto sig : *event.peerSignatures()) {
+                if (sig->publicKey() != nullptr && sig->publicKey()->str() == publicKey) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // the leader signs a proposal first, the others append their signatures
+        bool signedFirstBy(const ::iroha::ConsensusEvent& event, const hash::Hash32& hash,
+                           const std::string& publicKey) {
+            if (event.peerSignatures() == nullptr || event.peerSignatures()->size() == 0) {
+                return false;
+            }
+            const auto first = event.peerSignatures()->Get(0);
+            if (first->publicKey() == nullptr || first->signature() == nullptr ||
+                first->publicKey()->str() != publicKey) {
+                return false;
+            }
+            return signature::verify(
+                    std::string(first->signature()->begin(), first->signature()->end()),
+                    std::string(hash.begin(), hash.end()), publicKey);
+        }
+
+        // commits arrive from the Verify stream and from collectors, one at a time
+        std::mutex commitMutex;
+
+        /**
+         * Appends the transactions of a committed event not appended yet. A
+         * transaction is known by its digest, not its hash with the root,
+         * so the commit of every collector appends it once.
+         */
+        void applyCommit(const ::iroha::ConsensusEvent& event) {
+            std::lock_guard<std::mutex> lock(commitMutex);
+            std::vector<const Transaction*> block;
+            for (const auto wrapper : *event.transactions()) {
+                const auto txptr = wrapper->tx_nested_root();
+                if (txCache.emplace(detail::digest(*txptr), "commited").second) {
+                    block.push_back(txptr);
+                }
+            }
+            if (block.empty()) return;
+            tracing::Span span("sumeragi.commit");
+            std::vector<bool> appended;
+            {
+                metrics::ScopedTimer timing(stats::apply);
+                IROHA_PROBE1(commit_start, block.size());
+                appended = runtime::processBlock(block);
+                IROHA_PROBE1(commit_end, block.size());
+            }
+            stats::committed.inc(std::count(appended.begin(), appended.end(), true));
+
+            // only what the ledger holds moves the validator order
+            bool trustChanged = false;
+            for (size_t i = 0; i < block.size(); i++) {
+                if (!appended[i]) continue;
+                const auto tx = block[i];
+                if (tx->command_type() == ::iroha::Command::PeerSetTrust) {
+                    // a score is what its creator measured, one of many
+                    const auto cmd = tx->command_as_PeerSetTrust();
+                    trustChanged |= peer::transaction::executor::reportTrust(
+                            tx->creatorPubKey()->str(), cmd->peerPubKey()->str(),
+                            cmd->trust());
+                } else if (tx->command_type() == ::iroha::Command::PeerChangeTrust) {
+                    const auto cmd = tx->command_as_PeerChangeTrust();
+                    trustChanged |= peer::transaction::executor::changeTrust(
+                            cmd->peerPubKey()->str(), cmd->delta());
+                }
+            }
+            if (trustChanged) {
+                determineConsensusOrder();
+            }
+        }
+
     }  // namespace detail
 
     struct Context {
-        bool isSumeragi = false;      // am I the leader or am I not?
+        bool rotateLeader = false;    // the leader changes with the ledger height
+        bool latencyOrder = false;    // order validators by trust score
         std::uint64_t maxFaulty = 0;  // f
         std::uint64_t proxyTailNdx = 0;
         std::int32_t panicCount = 0;
         std::int64_t commitedCount = 0;
         std::uint64_t numValidatingPeers = 0;
+        std::uint64_t numCollectors = 0;  // 0: every validator rebroadcasts
         std::string myPublicKey;
         std::string myPrivateKey;
         std::string myIp;
         std::deque<std::unique_ptr<peer::Node>> validatingPeers;
+        // position in the chain => index in validatingPeers, replaced as a
+        // whole by determineConsensusOrder()
+        std::shared_ptr<const std::vector<std::uint64_t>> order;
 
         explore::sumeragi::PrintProgress printProgress;
 
@@ -129,6 +319,11 @@ namespace sumeragi {
                 this->proxyTailNdx = this->validatingPeers.size() - 1;
             }
 
+            // collectors are the proxy tail and the peers just before it
+            this->numCollectors = std::min<std::uint64_t>(
+                    config::IrohaConfigManager::getInstance().getSumeragiCollectors(0),
+                    this->proxyTailNdx + 1);
+
             this->panicCount = 0;
 
             this->myPublicKey =
@@ -136,16 +331,305 @@ namespace sumeragi {
             this->myIp = config::PeerServiceConfig::getInstance().getMyIp();
             this->myPrivateKey =
                     config::PeerServiceConfig::getInstance().getMyPrivateKey();
-            this->isSumeragi =
-                    this->validatingPeers.at(0)->publicKey == this->myPublicKey;
+            this->rotateLeader =
+                    config::IrohaConfigManager::getInstance().getSumeragiLeaderRotation(false);
+            this->latencyOrder =
+                    config::IrohaConfigManager::getInstance().getSumeragiLatencyOrder(false);
             logger::info("sumeragi") << "update finished";
 
             this->printProgress.MAX = 100;
         }
+
+        /**
+         * Index of the leader of a proposal at the ledger height, the
+         * height the leader put in the event, so the peers that sign it
+         * agree on the leader even if their own ledger is behind or ahead.
+         * It is validatingPeers[0], or the peer picked by the height when
+         * the leader rotates, so it changes on every commit.
+         */
+        std::uint64_t leaderNdx(std::uint64_t height) const {
+            return this->rotateLeader ? height % this->numValidatingPeers : 0;
+        }
+
+        // i-th peer of the chain of validators that starts at the leader
+        const peer::Node& peerAt(std::uint64_t leader, std::uint64_t i) const {
+            const auto order = std::atomic_load(&this->order);
+            return *this->validatingPeers.at(order->at((leader + i) % this->numValidatingPeers));
+        }
     };
 
     std::unique_ptr<Context> context = nullptr;
 
+    /**
+     * Transaction bodies travel apart from consensus: the leader publishes
+     * each body to every peer once, consensus events carry their digests
+     * only, and a peer that missed a body fetches it when it needs it.
+     */
+    namespace payload {
+
+        bool enabled() {
+            static const bool on = config::IrohaConfigManager::getInstance()
+                    .getSumeragiPayloadDissemination(false);
+            return on;
+        }
+
+        // bodies are dropped oldest first
+        const size_t maxBodies = 65536;
+
+        std::mutex mutex;
+        std::unordered_map<hash::Hash32, std::vector<uint8_t>> bodies;
+        std::deque<hash::Hash32> order;
+
+        void store(const uint8_t* data, size_t size) {
+            const auto digest = hash::sha3_256(data, size);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (bodies.find(digest) != bodies.end()) return;
+            if (order.size() >= maxBodies) {
+                bodies.erase(order.front());
+                order.pop_front();
+            }
+            bodies.emplace(digest, std::vector<uint8_t>(data, data + size));
+            order.push_back(digest);
+        }
+
+        bool find(const hash::Hash32& digest, std::vector<uint8_t>& body) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = bodies.find(digest);
+            if (it == bodies.end()) return false;
+            body = it->second;
+            return true;
+        }
+
+        bool isDigestEvent(const ConsensusEvent& event) {
+            return event.digests() != nullptr &&
+                   (event.transactions() == nullptr || event.transactions()->size() == 0);
+        }
+
+        // sends the bodies, built on the first proposal with one thread per peer
+        ThreadPool& publisher() {
+            static ThreadPool pool(ThreadPoolOptions{
+                .threads_count = std::max<size_t>(1, context->validatingPeers.size() - 1),
+                .worker_queue_size =
+                    config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
+            });
+            return pool;
+        }
+
+        /**
+         * Sends the bodies of a new event to every other peer in the
+         * background, the leader goes on without waiting for the acks. A
+         * peer the bodies did not reach in time fetches them from the leader.
+         */
+        void publish(const ConsensusEvent& event) {
+            auto txs = std::make_shared<std::vector<std::vector<uint8_t>>>();
+            for (const auto wrapper : *event.transactions()) {
+                store(wrapper->tx()->data(), wrapper->tx()->size());
+                txs->emplace_back(wrapper->tx()->begin(), wrapper->tx()->end());
+            }
+
+            for (const auto& peer : context->validatingPeers) {
+                if (peer->publicKey == context->myPublicKey) continue;
+                try {
+                    publisher().process([txs, ip = peer->ip] {
+                        if (!connection::memberShipService::SumeragiImpl::Publish::send(ip, *txs)) {
+                            logger::warning("sumeragi") << ip << " did not acknowledge the bodies";
+                        }
+                    });
+                } catch (const std::runtime_error& e) {
+                    logger::warning("sumeragi") << "bodies not published to " << peer->ip
+                                                << ": " << e.what();
+                }
+            }
+        }
+
+        // asks ip for the bodies at indexes, empty where it has none
+        std::vector<std::vector<uint8_t>> fetch(const std::string& ip,
+                                                const std::vector<hash::Hash32>& digests,
+                                                const std::vector<size_t>& indexes) {
+            std::vector<hash::Hash32> request;
+            for (auto i : indexes) request.push_back(digests[i]);
+            std::vector<std::vector<uint8_t>> fetched;
+            if (!connection::memberShipService::SumeragiImpl::FetchPayload::send(
+                    ip, request, fetched)) {
+                fetched.clear();
+            }
+            fetched.resize(indexes.size());
+            return fetched;
+        }
+
+        // keeps the fetched bodies that match their digest and are not found yet
+        void accept(const std::vector<std::vector<uint8_t>>& fetched,
+                    const std::vector<size_t>& indexes,
+                    const std::vector<hash::Hash32>& digests,
+                    std::vector<std::vector<uint8_t>>& txs,
+                    std::vector<bool>& found) {
+            for (size_t j = 0; j < indexes.size(); j++) {
+                const auto i = indexes[j];
+                const auto& body = fetched[j];
+                if (found[i] || body.empty() ||
+                    hash::sha3_256(body.data(), body.size()) != digests[i]) {
+                    continue;
+                }
+                store(body.data(), body.size());
+                txs[i] = body;
+                found[i] = true;
+            }
+        }
+
+        /**
+         * Puts the bodies back into a digest event: from the local store,
+         * else fetched from the leader of the event, then from every other
+         * peer at once. A call gives up after a second, so does this after
+         * two.
+         * @return nullptr if a body was not found anywhere
+         */
+        flatbuffers::unique_ptr_t resolve(const ConsensusEvent& event) {
+            metrics::ScopedTimer timing(stats::resolve);
+            tracing::Span span("payload.resolve");
+            const auto count = event.digests()->size() / hash::Hash32::size();
+            std::vector<hash::Hash32> digests(count);
+            std::vector<std::vector<uint8_t>> txs(count);
+            std::vector<bool> found(count);
+            const auto missing = [&] {
+                std::vector<size_t> res;
+                for (size_t i = 0; i < count; i++) {
+                    if (!found[i]) res.push_back(i);
+                }
+                return res;
+            };
+            for (size_t i = 0; i < count; i++) {
+                std::memcpy(digests[i].bytes.data(),
+                            event.digests()->data() + i * hash::Hash32::size(),
+                            hash::Hash32::size());
+                found[i] = find(digests[i], txs[i]);
+            }
+
+            // the leader published the bodies, it has them all
+            const auto& leader = context->peerAt(context->leaderNdx(event.height()), 0);
+            auto indexes = missing();
+            if (!indexes.empty() && leader.publicKey != context->myPublicKey) {
+                accept(fetch(leader.ip, digests, indexes), indexes, digests, txs, found);
+                indexes = missing();
+            }
+
+            if (!indexes.empty()) {
+                std::vector<std::future<std::vector<std::vector<uint8_t>>>> answers;
+                for (const auto& peer : context->validatingPeers) {
+                    if (peer->publicKey == context->myPublicKey ||
+                        peer->publicKey == leader.publicKey) {
+                        continue;
+                    }
+                    answers.push_back(std::async(std::launch::async, [&, ip = peer->ip] {
+                        return fetch(ip, digests, indexes);
+                    }));
+                }
+                for (auto& answer : answers) {
+                    accept(answer.get(), indexes, digests, txs, found);
+                }
+                indexes = missing();
+            }
+            if (!indexes.empty()) {
+                logger::error("sumeragi") << indexes.size()
+                                          << " transaction bodies not found, event dropped";
+                return nullptr;
+            }
+
+            auto resolved = flatbuffer_service::fromDigestEvent(event, txs);
+            if (!resolved) {
+                logger::error("sumeragi") << resolved.error();
+                return nullptr;
+            }
+            flatbuffers::unique_ptr_t res;
+            resolved.move_value(res);
+            return res;
+        }
+
+        // the digest event to put on the wire, nullptr to send event as is
+        flatbuffers::unique_ptr_t stripped(const ConsensusEvent& event) {
+            if (!enabled() || event.transactions() == nullptr ||
+                event.transactions()->size() == 0) {
+                return nullptr;
+            }
+            auto digestEvent = flatbuffer_service::toDigestEvent(event);
+            if (!digestEvent) {
+                logger::error("sumeragi") << digestEvent.error();
+                return nullptr;
+            }
+            flatbuffers::unique_ptr_t res;
+            digestEvent.move_value(res);
+            return res;
+        }
+
+        // stripped(event), carrying the sending span if it is traced
+        flatbuffers::unique_ptr_t traced(const ConsensusEvent& event,
+                                         const tracing::Context& trace) {
+            auto res = stripped(event);
+            if (!trace.sampled) return res;
+            auto withTrace = flatbuffer_service::withTrace(
+                    res ? *flatbuffers::GetRoot<ConsensusEvent>(res.get()) : event,
+                    ::iroha::TraceContext(trace.span, true));
+            if (!withTrace) {
+                logger::error("sumeragi") << withTrace.error();
+                return res;
+            }
+            withTrace.move_value(res);
+            return res;
+        }
+
+        void sendAll(const ConsensusEvent& event) {
+            tracing::Span span("sumeragi.send");
+            span.attr("peer", "all");
+            IROHA_PROBE1(sendall_start, static_cast<int>(event.code()));
+            auto wire = traced(event, span.context());
+            connection::iroha::SumeragiImpl::Verify::sendAll(
+                    wire ? *flatbuffers::GetRoot<ConsensusEvent>(wire.get()) : event);
+            IROHA_PROBE1(sendall_end, static_cast<int>(event.code()));
+        }
+
+        void send(const std::string& ip, const ConsensusEvent& event) {
+            tracing::Span span("sumeragi.send");
+            span.attr("peer", ip);
+            auto wire = traced(event, span.context());
+            connection::iroha::SumeragiImpl::Verify::send(
+                    ip, wire ? *flatbuffers::GetRoot<ConsensusEvent>(wire.get()) : event);
+        }
+
+    }  // namespace payload
+
+    namespace forwarding {
+
+        // transactions forwarded already are remembered, oldest dropped first
+        const size_t maxForwarded = 4096;
+
+        std::mutex mutex;
+        std::unordered_set<hash::Hash32> forwarded;
+        std::deque<hash::Hash32> order;
+
+        /**
+         * Sends a new transaction to its leader. A transaction is forwarded
+         * once per peer: if it comes back, peers disagree on the leader for
+         * a while and the transaction is proposed here instead of bouncing.
+         * It is known by its digest, which does not move with the ledger.
+         * @return false if the transaction must be proposed here
+         */
+        bool forward(const Transaction& tx, const std::string& ip) {
+            const auto digest = detail::digest(tx);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!forwarded.insert(digest).second) return false;
+                if (order.size() >= maxForwarded) {
+                    forwarded.erase(order.front());
+                    order.pop_front();
+                }
+                order.push_back(digest);
+            }
+            tracing::Span span("sumeragi.forward");
+            span.attr("peer", ip);
+            return connection::memberShipService::SumeragiImpl::Torii::send(ip, tx);
+        }
+
+    }  // namespace forwarding
+
     void initializeSumeragi() {
         logger::info("sumeragi") << "Sumeragi setted";
         logger::info("sumeragi") << "set number of validatingPeer";
@@ -154,7 +638,9 @@ namespace sumeragi {
 
         connection::iroha::SumeragiImpl::Torii::receive(
                 [](const std::string& from, flatbuffers::unique_ptr_t&& transaction) {
+                    IROHA_PROBE1(torii_receive, from.c_str());
                     context->printProgress.print(1, "receive transaction!");
+                    stats::toriiReceived.inc();
 
                     auto eventUniqPtr = flatbuffer_service::toConsensusEvent(
                             *flatbuffers::GetRoot<::iroha::Transaction>(transaction.get()));
@@ -163,21 +649,115 @@ namespace sumeragi {
                         context->printProgress.print(2, "make tx consensusEvent");
                         flatbuffers::unique_ptr_t ptr;
                         eventUniqPtr.move_value(ptr);
+                        tracing::Span span("torii.receive", detail::traceOf(
+                                *flatbuffers::GetRoot<ConsensusEvent>(ptr.get())));
+                        span.attr("from", from);
                         // send processTransaction(event) as a task to processing pool
                         // this returns std::future<void> object
                         // (std::future).get() method locks processing until result of
                         // processTransaction will be available but processTransaction returns
                         // void, so we don't have to call it and wait
-                        auto&& task = [e = std::move(ptr)]() mutable {
+                        auto&& task = [e = std::move(ptr), trace = span.context(),
+                                       queued = tracing::now()]() mutable {
+                            tracing::record("sumeragi.queue", trace, queued);
+                            tracing::Scope scope(trace);
                             processTransaction(std::move(e));
                         };
                         context->printProgress.print(3, "send event to processTransaction");
-                        pool.process(std::move(task));
+                        if (!pool.process(scheduling::Lane::Ingress, std::move(task))) {
+                            logger::warning("sumeragi") << "ingress lane is full, drop transaction";
+                            stats::toriiRejected.inc();
+                        }
                     } else {
                         logger::error("sumeragi") << eventUniqPtr.error();
                     }
                 });
 
+        connection::iroha::SumeragiImpl::ToriiBatch::receive(
+                [](const std::string& from, const ::iroha::TransactionBatch& batch) {
+                    IROHA_PROBE1(torii_batch_receive, from.c_str());
+                    const auto received = tracing::now();
+                    std::vector<::iroha::Code> codes;
+                    std::vector<flatbuffers::unique_ptr_t> events;
+                    std::vector<tracing::Context> traces;
+                    if (batch.transactions() != nullptr) {
+                        stats::toriiReceived.inc(batch.transactions()->size());
+                        codes.reserve(batch.transactions()->size());
+                        events.reserve(batch.transactions()->size());
+                        for (const auto wrapper : *batch.transactions()) {
+                            const auto tx = wrapper->tx();
+                            if (tx == nullptr) {
+                                codes.push_back(::iroha::Code::FAIL);
+                                continue;
+                            }
+                            flatbuffers::Verifier verifier(tx->data(), tx->size());
+                            if (!verifier.VerifyBuffer<::iroha::Transaction>(nullptr)) {
+                                codes.push_back(::iroha::Code::FAIL);
+                                continue;
+                            }
+                            auto eventUniqPtr = flatbuffer_service::toConsensusEvent(
+                                    *wrapper->tx_nested_root());
+                            if (eventUniqPtr) {
+                                flatbuffers::unique_ptr_t ptr;
+                                eventUniqPtr.move_value(ptr);
+                                traces.push_back(detail::traceOf(
+                                        *flatbuffers::GetRoot<ConsensusEvent>(ptr.get())));
+                                tracing::record("torii.receive", traces.back(), received);
+                                events.push_back(std::move(ptr));
+                                codes.push_back(::iroha::Code::UNDECIDED);
+                            } else {
+                                logger::error("sumeragi") << eventUniqPtr.error();
+                                codes.push_back(::iroha::Code::FAIL);
+                            }
+                        }
+                    }
+                    context->printProgress.print(2, "make batch consensusEvents");
+
+                    // the whole batch is one task of the processing pool
+                    if (!events.empty()) {
+                        auto&& task = [es = std::move(events), ts = std::move(traces),
+                                       queued = tracing::now()]() mutable {
+                            for (size_t i = 0; i < es.size(); i++) {
+                                tracing::record("sumeragi.queue", ts[i], queued);
+                                tracing::Scope scope(ts[i]);
+                                processTransaction(std::move(es[i]));
+                            }
+                        };
+                        if (!pool.process(scheduling::Lane::Ingress, std::move(task))) {
+                            logger::warning("sumeragi") << "ingress lane is full, drop batch";
+                            stats::toriiRejected.inc(std::count(
+                                    codes.begin(), codes.end(), ::iroha::Code::UNDECIDED));
+                            std::replace(codes.begin(), codes.end(),
+                                         ::iroha::Code::UNDECIDED, ::iroha::Code::FAIL);
+                        }
+                    }
+                    return codes;
+                });
+
+        connection::iroha::SumeragiImpl::Publish::receive(
+                [](const std::string& from, const ::iroha::TransactionBatch& batch) {
+                    size_t stored = 0;
+                    if (batch.transactions() != nullptr) {
+                        for (const auto wrapper : *batch.transactions()) {
+                            if (wrapper->tx() == nullptr) continue;
+                            payload::store(wrapper->tx()->data(), wrapper->tx()->size());
+                            stored++;
+                        }
+                    }
+                    logger::debug("sumeragi") << "stored " << stored << " bodies from " << from;
+                    return stored;
+                });
+
+        connection::iroha::SumeragiImpl::FetchPayload::receive(
+                [](const std::string& from, const std::vector<hash::Hash32>& digests) {
+                    logger::debug("sumeragi") << from << " fetches " << digests.size() << " bodies";
+                    std::vector<std::vector<uint8_t>> res(digests.size());
+                    for (size_t i = 0; i < digests.size(); i++) {
+                        payload::find(digests[i], res[i]);
+                    }
+                    return res;
+                });
+
         connection::iroha::SumeragiImpl::Verify::receive(
                 [](const std::string& from, flatbuffers::unique_ptr_t&& eventUniqPtr) {
                     context->printProgress.print(15,
@@ -186,14 +766,32 @@ namespace sumeragi {
 
                     auto eventPtr =
                             flatbuffers::GetRoot<::iroha::ConsensusEvent>(eventUniqPtr.get());
+                    IROHA_PROBE2(verify_receive, from.c_str(), static_cast<int>(eventPtr->code()));
+                    tracing::Span span("verify.receive", detail::traceOf(*eventPtr));
+                    span.attr("from", from);
 
                     if (eventPtr->code() == iroha::Code::COMMIT) {
                         context->printProgress.print(19, "receive commited event");
-                        // Feature work #(tx) = 1
-                        const auto txptr = eventPtr->transactions()->Get(0)->tx_nested_root();
-                        if (txCache.find(detail::hash(*txptr, repository::getMerkleRoot())) == txCache.end()) {
-                            txCache[detail::hash(*txptr, repository::getMerkleRoot())] = "commited";
-                            runtime::processTransaction(*txptr);
+                        if (payload::isDigestEvent(*eventPtr)) {
+                            auto resolved = payload::resolve(*eventPtr);
+                            if (!resolved) return;
+                            detail::applyCommit(
+                                    *flatbuffers::GetRoot<::iroha::ConsensusEvent>(resolved.get()));
+                        } else {
+                            detail::applyCommit(*eventPtr);
+                        }
+                    } else if (payload::isDigestEvent(*eventPtr)) {
+                        // fetching missing bodies may take a round trip
+                        auto&& task = [e = std::move(eventUniqPtr), trace = span.context(),
+                                       queued = tracing::now()]() mutable {
+                            tracing::record("sumeragi.queue", trace, queued);
+                            tracing::Scope scope(trace);
+                            auto resolved = payload::resolve(
+                                    *flatbuffers::GetRoot<::iroha::ConsensusEvent>(e.get()));
+                            if (resolved) processTransaction(std::move(resolved));
+                        };
+                        if (!pool.process(scheduling::Lane::Consensus, std::move(task))) {
+                            logger::warning("sumeragi") << "consensus lane is full, drop event";
                         }
                     } else {
                         // send processTransaction(event) as a task to processing pool
@@ -206,10 +804,15 @@ namespace sumeragi {
                         // pool.process(std::move(task));
 
                         // Copy ConsensusEvent
-                        auto&& task = [e = std::move(eventUniqPtr)]() mutable {
+                        auto&& task = [e = std::move(eventUniqPtr), trace = span.context(),
+                                       queued = tracing::now()]() mutable {
+                            tracing::record("sumeragi.queue", trace, queued);
+                            tracing::Scope scope(trace);
                             processTransaction(std::move(e));
                         };
-                        pool.process(std::move(task));
+                        if (!pool.process(scheduling::Lane::Consensus, std::move(task))) {
+                            logger::warning("sumeragi") << "consensus lane is full, drop event";
+                        }
                     }
                 });
 
@@ -223,10 +826,12 @@ namespace sumeragi {
         logger::info("sumeragi") << "initialize myPublicKey :"
                                  << context->myPublicKey;
 
+        stats::collectPool();
+
         // TODO: move the peer service and ordering code to another place
-        // determineConsensusOrder(); // side effect is to modify validatingPeers
-        logger::info("sumeragi") << "initialize is sumeragi :"
-                                 << static_cast<int>(context->isSumeragi);
+        determineConsensusOrder();
+        logger::info("sumeragi") << "initialize leader rotation :"
+                                 << static_cast<int>(context->rotateLeader);
         logger::info("sumeragi") << "initialize.....  complete!";
     }
 
@@ -237,6 +842,177 @@ namespace sumeragi {
         // return merkle_transaction_repository::getLastLeafOrder() + 1;
     }
 
+    namespace collector {
+
+        // signatures gathered by a collector for one transaction
+        struct Entry {
+            flatbuffers::unique_ptr_t event;
+            std::unordered_set<std::string> signers;
+            bool committed = false;
+        };
+
+        // entries are dropped oldest first, a transaction that never
+        // gathers 2f+1 signatures must not stay forever
+        const size_t maxEntries = 4096;
+
+        std::mutex mutex;
+        std::unordered_map<hash::Hash32, Entry> entries;
+        std::deque<hash::Hash32> order;
+
+        std::vector<std::string> ips(std::uint64_t leader) {
+            std::vector<std::string> res;
+            const auto last = context->proxyTailNdx;
+            for (auto i = last + 1 - context->numCollectors; i <= last; i++) {
+                res.push_back(context->peerAt(leader, i).ip);
+            }
+            return res;
+        }
+
+        bool isCollector(std::uint64_t leader) {
+            const auto last = context->proxyTailNdx;
+            for (auto i = last + 1 - context->numCollectors; i <= last; i++) {
+                if (context->peerAt(leader, i).publicKey == context->myPublicKey) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // a signature counts if a validating peer made it over the hash
+        bool isValidSignature(const Signature& sig, const hash::Hash32& hash) {
+            if (sig.publicKey() == nullptr || sig.signature() == nullptr) return false;
+            const auto publicKey = sig.publicKey()->str();
+            const auto& peers = context->validatingPeers;
+            if (std::none_of(peers.begin(), peers.end(), [&](const auto& peer) {
+                    return peer->publicKey == publicKey;
+                })) {
+                return false;
+            }
+            return signature::verify(
+                    std::string(sig.signature()->begin(), sig.signature()->end()),
+                    std::string(hash.begin(), hash.end()), publicKey);
+        }
+
+        /**
+         * Merges the signatures of event into the entry of the transaction.
+         * @return the commit to broadcast once 2f+1 distinct validating peers
+         * signed the hash, nullptr otherwise
+         */
+        flatbuffers::unique_ptr_t merge(const ConsensusEvent& event,
+                                        const hash::Hash32& hash) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(hash);
+            if (it == entries.end()) {
+                if (order.size() >= maxEntries) {
+                    entries.erase(order.front());
+                    order.pop_front();
+                }
+                it = entries.emplace(hash, Entry()).first;
+                order.push_back(hash);
+            }
+            auto& entry = it->second;
+            if (entry.committed) return nullptr;
+
+            // the first event is kept as it is, later ones add their signatures
+            const bool first = !entry.event;
+            if (first) {
+                flatbuffers::FlatBufferBuilder fbb;
+                auto copy = flatbuffer_service::copyConsensusEvent(fbb, event);
+                if (!copy) return nullptr;
+                fbb.Finish(*copy);
+                entry.event = fbb.ReleaseBufferPointer();
+            }
+            for (const auto sig : *event.peerSignatures()) {
+                if (!isValidSignature(*sig, hash)) continue;
+                if (!entry.signers.insert(sig->publicKey()->str()).second) continue;
+                if (first) continue;
+
+                auto added = flatbuffer_service::addSignature(
+                        *flatbuffers::GetRoot<ConsensusEvent>(entry.event.get()),
+                        sig->publicKey()->str(),
+                        std::string(sig->signature()->begin(), sig->signature()->end()));
+                if (!added) {
+                    entry.signers.erase(sig->publicKey()->str());
+                    continue;
+                }
+                added.move_value(entry.event);
+            }
+
+            if (entry.signers.size() < context->maxFaulty * 2 + 1) return nullptr;
+
+            auto commit = flatbuffer_service::makeCommit(
+                    *flatbuffers::GetRoot<ConsensusEvent>(entry.event.get()));
+            if (!commit) {
+                logger::error("sumeragi") << commit.error();
+                return nullptr;
+            }
+            entry.committed = true;
+            entry.event.reset();
+            flatbuffers::unique_ptr_t res;
+            commit.move_value(res);
+            return res;
+        }
+
+    }  // namespace collector
+
+    /**
+     * Signature collection through collectors, so a round costs O(n)
+     * messages instead of every validator rebroadcasting to everyone:
+     *  - the leader signs a new transaction and broadcasts it once
+     *  - validators sign it and send it to the collectors only
+     *  - a collector merges the signatures, broadcasts a single commit
+     *    once 2f+1 peers signed and applies it itself
+     */
+    void processWithCollectors(const ConsensusEvent& event, const hash::Hash32& hash,
+                               std::uint64_t leader, bool isLeader) {
+        const bool proposal = detail::eventSignatureIsEmpty(event);
+        if (proposal && !isLeader) {
+            logger::warning("sumeragi") << "unsigned event from a non-leader, dropped";
+            return;
+        }
+
+        flatbuffers::unique_ptr_t signedEvent;
+        const bool signedNow = !detail::hasSignatureOf(event, context->myPublicKey);
+        if (signedNow) {
+            tracing::Span signing("sumeragi.sign");
+            signing.attr("peer", context->myPublicKey);
+            const auto signature =
+                    signature::sign(std::string(hash.begin(), hash.end()),
+                                    context->myPublicKey, context->myPrivateKey);
+            auto sigAddPtr = flatbuffer_service::addSignature(
+                    event, context->myPublicKey, signature);
+            if (!sigAddPtr) {
+                logger::error("sumeragi") << "Failed to process transaction.";
+                return;
+            }
+            sigAddPtr.move_value(signedEvent);
+        }
+        const auto& mine = signedNow
+                ? *flatbuffers::GetRoot<ConsensusEvent>(signedEvent.get())
+                : event;
+
+        if (proposal) {
+            context->printProgress.print(14, "send proposal to all");
+            payload::sendAll(mine);
+        }
+
+        if (collector::isCollector(leader)) {
+            auto commit = collector::merge(mine, hash);
+            if (commit) {
+                const auto& committed = *flatbuffers::GetRoot<ConsensusEvent>(commit.get());
+                context->commitedCount++;
+                context->printProgress.print(18, "SendAll");
+                payload::sendAll(committed);
+                detail::applyCommit(committed);
+            }
+        } else if (signedNow && !proposal) {
+            context->printProgress.print(14, "send signature to collectors");
+            for (const auto& ip : collector::ips(leader)) {
+                payload::send(ip, mine);
+            }
+        }
+    }
+
     void processTransaction(flatbuffers::unique_ptr_t&& eventUniqPtr) {
         // Do not touch directly
         flatbuffers::unique_ptr_t storageUniqPtr;
@@ -252,23 +1028,72 @@ namespace sumeragi {
         // Convenient accessor
         const auto getRoot = [&] { return storageRawPtrRef; };
 
+        metrics::ScopedTimer timing(stats::process);
         context->printProgress.print(4, "start processTransaction");
 
         context->printProgress.print(5, "set input's event unique ptr");
         resetUniqPtr(std::move(eventUniqPtr));
+        tracing::Span span("sumeragi.process", detail::traceOf(*getRoot()));
+        span.attr("peer", context->myPublicKey);
 
         context->printProgress.print(6, "generate hash");
 
-        const auto hash = detail::hash(
-                *getRoot()->transactions()->Get(0)->tx_nested_root(),
-                repository::getMerkleRoot()
-        );  // ToDo: #(tx) = 1
+        const auto root = repository::getMerkleRoot();
+        const auto& tx = *getRoot()->transactions()->Get(0)->tx_nested_root();
+        const auto hash = detail::hash(tx, root);  // ToDo: #(tx) = 1
+
+        // a new transaction is proposed at this ledger's height, a proposal
+        // signed already is handled at the height its leader put in it
+        const bool proposal = detail::eventSignatureIsEmpty(*getRoot());
+        const auto height =
+                proposal ? repository::getTransactionCount() : getRoot()->height();
+        const auto leader = context->leaderNdx(height);
+        // the height picks the leader, so only that leader may have signed
+        // first; otherwise any validator could claim a height it leads
+        if (!proposal && !detail::signedFirstBy(*getRoot(), hash, context->peerAt(leader, 0).publicKey)) {
+            logger::warning("sumeragi") << "event of height " << height
+                                        << " not signed first by its leader, dropped";
+            return;
+        }
+        bool isLeader = context->peerAt(leader, 0).publicKey == context->myPublicKey;
+        if (!isLeader && proposal) {
+            context->printProgress.print(6, "forward to ", context->peerAt(leader, 0).ip);
+            if (forwarding::forward(tx, context->peerAt(leader, 0).ip)) return;
+            isLeader = true;
+        }
+
+        if (isLeader && proposal) {
+            auto proposed = flatbuffer_service::withHeight(*getRoot(), height);
+            if (!proposed) {
+                logger::error("sumeragi") << proposed.error();
+                return;
+            }
+            flatbuffers::unique_ptr_t uptr;
+            proposed.move_value(uptr);
+            resetUniqPtr(std::move(uptr));
+        }
+
+        if (payload::enabled() && isLeader && proposal) {
+            context->printProgress.print(6, "publish transaction bodies");
+            payload::publish(*getRoot());
+        }
+
+        if (context->numCollectors > 0) {
+            processWithCollectors(*getRoot(), hash, leader, isLeader);
+            return;
+        }
+
         {
+            tracing::Span signing("sumeragi.sign");
+            signing.attr("peer", context->myPublicKey);
             context->printProgress.print(7, "sign hash using my key-pair");
 
             const auto signature =
-                    signature::sign(hash, context->myPublicKey, context->myPrivateKey);
-            explore::sumeragi::printInfo("hash:" + hash + " signature:" + signature);
+                    signature::sign(std::string(hash.begin(), hash.end()),
+                                    context->myPublicKey, context->myPrivateKey);
+            if (logger::enabled(logger::LogLevel::Explore)) {
+                explore::sumeragi::printInfo("hash:", hash::to_hex(hash), " signature:", signature);
+            }
 
             context->printProgress.print(8, "Add own signature");
 
@@ -284,7 +1109,7 @@ namespace sumeragi {
         }
 
         context->printProgress.print(9, "if statement");
-        if (detail::eventSignatureIsEmpty(*getRoot()) && context->isSumeragi) {
+        if (detail::eventSignatureIsEmpty(*getRoot()) && isLeader) {
             context->printProgress.print(
                     11, "event doesn't have signature and I'm Sumeragi");
 
@@ -294,8 +1119,7 @@ namespace sumeragi {
         } else if (!detail::eventSignatureIsEmpty(*getRoot())) {
             context->printProgress.print(10, "event has signature");
             explore::sumeragi::printInfo(
-                    "Signature number is " +
-                    std::to_string(getRoot()->peerSignatures()->size()));
+                    "Signature number is ", getRoot()->peerSignatures()->size());
 
             context->printProgress.print(11, "if statement");
             // Check if we have at least 2f+1 signatures needed for Byzantine fault
@@ -312,8 +1136,7 @@ namespace sumeragi {
 
                 context->commitedCount++;
 
-                explore::sumeragi::printInfo("commit count:" +
-                                             std::to_string(context->commitedCount));
+                explore::sumeragi::printInfo("commit count:", context->commitedCount);
 
                 context->printProgress.print(17, "update event commit");
 
@@ -329,16 +1152,21 @@ namespace sumeragi {
                 }
 
                 context->printProgress.print(18, "SendAll");
-                connection::iroha::SumeragiImpl::Verify::sendAll(*getRoot());
+                payload::sendAll(*getRoot());
 
             } else {
 
                 {
+                    tracing::Span signing("sumeragi.sign");
+                    signing.attr("peer", context->myPublicKey);
                     context->printProgress.print(7, "sign hash using my key-pair");
 
                     const auto signature =
-                            signature::sign(hash, context->myPublicKey, context->myPrivateKey);
-                    explore::sumeragi::printInfo("hash:" + hash + " signature:" + signature);
+                            signature::sign(std::string(hash.begin(), hash.end()),
+                                            context->myPublicKey, context->myPrivateKey);
+                    if (logger::enabled(logger::LogLevel::Explore)) {
+                        explore::sumeragi::printInfo("hash:", hash::to_hex(hash), " signature:", signature);
+                    }
 
                     context->printProgress.print(8, "Add own signature");
 
@@ -356,33 +1184,30 @@ namespace sumeragi {
                 explore::sumeragi::printInfo("Signature exists and sig not enough");
                 context->printProgress.print(12, "add peer signature to event");
 
-                explore::sumeragi::printInfo(
-                        "tail public key is " +
-                        context->validatingPeers.at(context->proxyTailNdx)->publicKey);
+                const auto& proxyTail = context->peerAt(leader, context->proxyTailNdx);
+                explore::sumeragi::printInfo("tail public key is ", proxyTail.publicKey);
 
                 context->printProgress.print(13, "If statements [ Am I tail or not?");
-                if (context->validatingPeers.at(context->proxyTailNdx)->publicKey ==
-                    context->myPublicKey) {
+                if (proxyTail.publicKey == context->myPublicKey) {
                     explore::sumeragi::printInfo(
-                            "currently signature number:" +
-                            std::to_string(getRoot()->peerSignatures()->size()));
-                    context->printProgress.print(
-                            14, "send to " +
-                                context->validatingPeers.at(context->proxyTailNdx)->ip);
-
-                    connection::iroha::SumeragiImpl::Verify::send(
-                            context->validatingPeers.at(context->proxyTailNdx)->ip,
-                            *getRoot());  // Think In Process
+                            "currently signature number:",
+                            getRoot()->peerSignatures()->size());
+                    context->printProgress.print(14, "send to ", proxyTail.ip);
+
+                    payload::send(proxyTail.ip, *getRoot());  // Think In Process
                 } else {
                     explore::sumeragi::printInfo(
-                            "currently signature number:" +
-                            std::to_string(getRoot()->peerSignatures()->size()));
+                            "currently signature number:",
+                            getRoot()->peerSignatures()->size());
 
                     context->printProgress.print(14, "send all");
-                    connection::iroha::SumeragiImpl::Verify::sendAll(*getRoot());
+                    payload::sendAll(*getRoot());
                     //
                 }
 
+                // the wait for other signatures is not part of this step
+                timing.stop();
+                span.end();
                 timer::setAwkTimerForCurrentThread(3000, [&]() { panic(*getRoot()); });
             }
         }
@@ -435,37 +1260,38 @@ namespace sumeragi {
  * servers are used.
  */
     void determineConsensusOrder() {
-        // WIP We create getTrustScore() function. till then circle list
-        /*
-        std::deque<
-                std::unique_ptr<peer::Node>
-        > tmp_deq;
-        for(int i=1;i<context->validatingPeers.size();i++){
-            tmp_deq.push_back(std::move(context->validatingPeers[i]));
-        }
-        tmp_deq.push_back(std::move(context->validatingPeers[0]));
-        context->validatingPeers.clear();
-        context->validatingPeers = std::move(tmp_deq);
-
-        std::sort(context->validatingPeers.begin(), context->validatingPeers.end(),
-              [](const std::unique_ptr<peer::Node> &lhs,
-                 const std::unique_ptr<peer::Node> &rhs) {
-                  return lhs->getTrustScore() > rhs->getTrustScore()
-                         || (lhs->getTrustScore() == rhs->getTrustScore()
-                             && lhs->getPublicKey() < rhs->getPublicKey());
-              }
-        );
-        logger::info("sumeragi")        <<  "determineConsensusOrder sorted!";
-        logger::info("sumeragi")        <<  "determineConsensusOrder myPubkey:"     <<
-        context->myPublicKey;
-
-        for(const auto& peer : context->validatingPeers) {
-            logger::info("sumeragi")    <<  "determineConsensusOrder PublicKey:"    <<
-        peer->getPublicKey(); logger::info("sumeragi")    <<  "determineConsensusOrder
-        ip:"           <<  peer->getIP();
-        }
-        */
-        // context->isSumeragi = context->validatingPeers.at(0)->getPublicKey() ==
-        // context->myPublicKey;
+        const auto n = context->validatingPeers.size();
+        auto order = std::make_shared<std::vector<std::uint64_t>>(n);
+        std::iota(order->begin(), order->end(), 0);
+
+        if (context->latencyOrder) {
+            // trust scores are the medians of the committed PeerSetTrust
+            // reports of every peer, plus PeerChangeTrust, so every peer
+            // sorts the same way at the same ledger height
+            std::vector<double> trust(n, config::PeerServiceConfig::getInstance().getMaxTrustScore());
+            for (size_t i = 0; i < n; i++) {
+                const auto node =
+                        peer::service::findPeerPublicKey(context->validatingPeers[i]->publicKey);
+                if (node) trust[i] = node->trust;
+            }
+            std::stable_sort(order->begin(), order->end(),
+                [&](std::uint64_t lhs, std::uint64_t rhs) {
+                    return trust[lhs] > trust[rhs]
+                           || (trust[lhs] == trust[rhs]
+                               && context->validatingPeers[lhs]->publicKey <
+                                  context->validatingPeers[rhs]->publicKey);
+                });
+        }
+
+        std::atomic_store(&context->order,
+                          std::shared_ptr<const std::vector<std::uint64_t>>(std::move(order)));
+        std::vector<std::string> ips;
+        for (std::uint64_t i = 0; i < n; i++) {
+            logger::debug("sumeragi") << "determineConsensusOrder " << i << ": "
+                                      << context->peerAt(0, i).ip;
+            ips.push_back(context->peerAt(0, i).ip);
+        }
+        // broadcasts relay along the same order
+        connection::iroha::SumeragiImpl::Verify::setRelayOrder(std::move(ips));
     }
-}  // namespace sumeragi
\ No newline at end of file
+}  // namespace sumeragi
@@ -17,15 +17,77 @@ limitations under the License.
 #ifndef CORE_CRYPTO_HASH_HPP__
 #define CORE_CRYPTO_HASH_HPP__
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <string>
 #include <vector>
 
+extern "C" {
+#include <KeccakHash.h>
+}
+
 namespace hash {
 
+/**
+ * 32-byte digest as a value. Trivially copyable, comparable and usable as
+ * an unordered_map key. Convert with to_hex() only when logging or
+ * writing JSON / text wire fields.
+ */
+struct Hash32 {
+  std::array<uint8_t, 32> bytes;
+
+  const uint8_t *data() const { return bytes.data(); }
+  static constexpr size_t size() { return 32; }
+  const uint8_t *begin() const { return bytes.data(); }
+  const uint8_t *end() const { return bytes.data() + size(); }
+
+  bool operator==(const Hash32 &rhs) const { return bytes == rhs.bytes; }
+  bool operator!=(const Hash32 &rhs) const { return bytes != rhs.bytes; }
+  bool operator<(const Hash32 &rhs) const { return bytes < rhs.bytes; }
+};
+
+std::string to_hex(const uint8_t *data, size_t size);
+std::string to_hex(const Hash32 &hash);
+
+Hash32 sha3_256(const uint8_t *data, size_t size);
+Hash32 sha3_256(const std::string &message);
+
 std::string sha3_256_hex(std::string message);
 std::string sha3_256_hex(std::vector<uint8_t> message);
 std::string sha3_512_hex(std::string message);
 
+/**
+ * Incremental SHA3-256. Absorb any number of chunks with update(),
+ * then call digest() or hexdigest() once.
+ */
+class Sha3_256 {
+ public:
+  Sha3_256();
+
+  void update(const uint8_t *data, size_t size);
+  void update(const std::string &message);
+
+  Hash32 digest();
+  std::string hexdigest();
+
+ private:
+  Keccak_HashInstance instance_;
+};
+
+};
+
+namespace std {
+template <>
+struct hash<::hash::Hash32> {
+  size_t operator()(const ::hash::Hash32 &h) const noexcept {
+    // the digest is already uniformly distributed
+    size_t res;
+    std::memcpy(&res, h.data(), sizeof(res));
+    return res;
+  }
 };
+}  // namespace std
 
 #endif  // CORE_CRYPTO_HASH_HPP_
@@ -47,10 +47,11 @@ std::string sign(const std::string &message, const std::string &publicKey_b64,
 byte_array_t sign(const std::string &message, const byte_array_t &publicKey,
                   const byte_array_t &privateKey);
 
+// false for a malformed base64 text or a signature or key of the wrong size
 bool verify(const std::string &signature_b64, const std::string &message,
             const std::string &publicKey_b64);
 
-bool verify(const std::string &signature, const byte_array_t &message,
+bool verify(const byte_array_t &signature, const std::string &message,
             const byte_array_t &publicKey);
 
 KeyPair generateKeyPair();
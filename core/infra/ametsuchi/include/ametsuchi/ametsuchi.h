@@ -27,6 +27,7 @@
 #include <lmdb.h>
 #include <transaction_generated.h>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -86,6 +87,20 @@ class Ametsuchi {
   const ::iroha::Transaction *getTransaction(size_t index,
                                              bool uncommitted = false);
 
+  /**
+   * Visit transactions with index in [from, to), in a single read-only
+   * transaction unless uncommitted. See TxStore::getTransactionRange.
+   */
+  void getTransactionRange(
+      size_t from, size_t to,
+      const std::function<bool(size_t, const AM_val &)> &visit,
+      bool uncommitted = false);
+
+  /**
+   * Index of the last transaction, 0 if there is none.
+   */
+  size_t getTransactionCount(bool uncommitted = false);
+
   // ********************
   // Ametsuchi queries:
   /**
@@ -114,6 +129,17 @@ class Ametsuchi {
                                         const flatbuffers::String *asset_name,
                                         bool uncommitted = false);
 
+  /**
+   * Visits the Asset flatbuffers of the account, without copying them.
+   * See WSV::accountVisitAssets.
+   */
+  void accountVisitAssets(const flatbuffers::String *pubKey,
+                          const flatbuffers::String *ledger_name,
+                          const flatbuffers::String *domain_name,
+                          const flatbuffers::String *asset_name,
+                          const std::function<void(const AM_val &)> &visit,
+                          bool uncommitted = false);
+
 
   const ::iroha::Asset *assetidGetAsset(const std::string &&ledger_name,
                                         const std::string &&domain_name,
@@ -129,6 +155,26 @@ class Ametsuchi {
   const std::vector<const ::iroha::AccountPermissionAsset *>
   assetGetPermissionAsset(const flatbuffers::String *pubKey);
 
+  /**
+   * Capability mask (see permission::Capability) of pubKey for the asset.
+   * O(1) and allocation free once the account is indexed.
+   * @param uncommitted - if true, include uncommitted changes, read from
+   * the append transaction: only on the writer thread
+   */
+  uint8_t assetGetCapabilities(const flatbuffers::String *pubKey,
+                               const flatbuffers::String *ledger_name,
+                               const flatbuffers::String *domain_name,
+                               const flatbuffers::String *asset_name,
+                               bool uncommitted = false);
+
+  /**
+   * Whether an account with pubKey exists.
+   * @param uncommitted - if true, include uncommitted changes to search.
+   * Otherwise create new read-only TX
+   */
+  bool accountExists(const flatbuffers::String *pubKey,
+                     bool uncommitted = false);
+
   const ::iroha::Peer *pubKeyGetPeer(const flatbuffers::String *pubKey,
                                      bool uncommitted = false);
 
@@ -144,6 +190,11 @@ class Ametsuchi {
 
   const ametsuchi::merkle::hash_t getMerkleRoot();
 
+  /**
+   * Fresh mdb_env_stat of the environment, safe to call from any thread.
+   */
+  MDB_stat stat();
+
  private:
   /* for internal use only */
 
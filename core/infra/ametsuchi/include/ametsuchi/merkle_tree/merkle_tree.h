@@ -88,6 +88,21 @@ class MerkleTree {
   static hash_t hash(const std::vector<uint8_t> &data);
   static hash_t hash(const uint8_t *data, size_t size);
 
+  /**
+   * Root of a standalone tree over \p leafs, used to compare ranges of
+   * transactions between peers. An odd node is carried to the next level
+   * unchanged. O(size) hashes, root of no leafs is all zeroes.
+   */
+  static hash_t root_of(std::vector<hash_t> leafs);
+
+  /**
+   * Nodes of the tree root_of() builds over \p leafs, \p level levels above
+   * them: node i covers leafs [i * 2^level, (i + 1) * 2^level). Leafs must
+   * start at a multiple of 2^level for the nodes to be the ones of a larger
+   * tree.
+   */
+  static std::vector<hash_t> level_of(std::vector<hash_t> leafs, size_t level);
+
   /**
    * for debug only
    */
@@ -0,0 +1,100 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMETSUCHI_PERMISSION_INDEX_H
+#define AMETSUCHI_PERMISSION_INDEX_H
+
+#include <flatbuffers/flatbuffers.h>
+#include <primitives_generated.h>
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ametsuchi {
+
+namespace permission {
+
+/**
+ * Bits of AccountPermissionAsset, precomputed per (account, asset).
+ */
+enum Capability : uint8_t {
+  READ = 1 << 0,
+  TRANSFER = 1 << 1,
+  ADD = 1 << 2,
+  SUBTRACT = 1 << 3,
+  GIVE_PERMISSION = 1 << 4,
+};
+
+uint8_t capabilitiesOf(const ::iroha::AccountPermissionAsset *permission);
+
+}  // namespace permission
+
+/**
+ * In-memory index (account, ledger, domain, asset) => capability mask.
+ *  - accounts are loaded lazily on the first lookup, through loader
+ *  - a hit takes a shared lock and does not allocate
+ *  - invalidate() drops an account, it is reloaded on the next lookup
+ */
+class PermissionIndex {
+ public:
+  using Visitor = std::function<void(const ::iroha::AccountPermissionAsset *)>;
+  // visits the permissions of the account, valid only during the visit
+  using Loader = std::function<void(const flatbuffers::String *, const Visitor &)>;
+
+  explicit PermissionIndex(Loader loader);
+
+  uint8_t get(const flatbuffers::String *pubKey,
+              const flatbuffers::String *ledger_name,
+              const flatbuffers::String *domain_name,
+              const flatbuffers::String *asset_name);
+
+  /**
+   * Drop cached permissions of the account.
+   * @param pubKey - account to drop, nullptr drops every account
+   */
+  void invalidate(const flatbuffers::String *pubKey);
+  void invalidate(const std::string &pubKey);
+
+  void clear();
+
+ private:
+  struct Entry {
+    // pubKey \0 ledger \0 domain \0 asset; empty asset id marks a loaded account
+    std::string key;
+    uint8_t mask;
+  };
+
+  Loader loader_;
+  std::unordered_multimap<uint64_t, Entry> entries_;
+  std::shared_timed_mutex mutex_;
+
+  bool lookup(const flatbuffers::String *pubKey,
+              const flatbuffers::String *ledger_name,
+              const flatbuffers::String *domain_name,
+              const flatbuffers::String *asset_name, uint8_t *mask) const;
+
+  void insert(const flatbuffers::String *pubKey, const std::string &ledger_name,
+              const std::string &domain_name, const std::string &asset_name,
+              uint8_t mask);
+};
+
+}  // namespace ametsuchi
+
+#endif  // AMETSUCHI_PERMISSION_INDEX_H
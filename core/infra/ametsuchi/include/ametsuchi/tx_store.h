@@ -23,6 +23,7 @@
 #include <commands_generated.h>
 #include <flatbuffers/flatbuffers.h>
 #include <lmdb.h>
+#include <functional>
 #include <unordered_map>
 
 namespace std {
@@ -70,6 +71,21 @@ class TxStore {
   // TxStore queries:
   AM_val getTransaction(size_t index, bool uncommitted = true, MDB_env *env = nullptr);
 
+  /**
+   * Visit transactions with index in [from, to) in order, until visit
+   * returns false. Indices start at 1. Values point into the mmap and are
+   * valid only inside visit.
+   */
+  void getTransactionRange(
+      size_t from, size_t to,
+      const std::function<bool(size_t, const AM_val &)> &visit,
+      bool uncommitted = true, MDB_env *env = nullptr);
+
+  /**
+   * Index of the last transaction, 0 if the store is empty.
+   */
+  size_t getTransactionCount(bool uncommitted = true, MDB_env *env = nullptr);
+
   std::vector<AM_val> getAssetTransferBySender(
       const flatbuffers::String *senderKey, bool uncommitted = true,
       MDB_env *env = nullptr);
@@ -20,10 +20,12 @@
 
 #include <account_generated.h>
 #include <ametsuchi/common.h>
+#include <ametsuchi/permission_index.h>
 #include <asset_generated.h>
 #include <commands_generated.h>
 #include <flatbuffers/flatbuffers.h>
 #include <lmdb.h>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -63,6 +65,19 @@ class WSV {
       const flatbuffers::String *pubKey, bool uncommitted = true,
       MDB_env *env = nullptr);
 
+  /**
+   * Visit the stored Asset flatbuffers of the account, all of them or only
+   * (ledger_name, domain_name, asset_name) when they are given. The read
+   * transaction stays open while visit runs, the bytes are valid until it
+   * returns.
+   */
+  void accountVisitAssets(const flatbuffers::String *pubKey,
+                          const flatbuffers::String *ledger_name,
+                          const flatbuffers::String *domain_name,
+                          const flatbuffers::String *asset_name,
+                          const std::function<void(const AM_val &)> &visit,
+                          bool uncommitted = false, MDB_env *env = nullptr);
+
   // asset_id is asset_name + domain_name + ledger_name
   const ::iroha::Asset *assetidGetAsset(const std::string &&assetid,
                                         bool uncommitted = false,
@@ -72,11 +87,33 @@ class WSV {
                                      bool uncommitted = false,
                                      MDB_env *env = nullptr);
 
+  bool accountExists(const flatbuffers::String *pubKey,
+                     bool uncommitted = false, MDB_env *env = nullptr);
+
   const ::iroha::AccountPermissionRoot accountGetPermissionRoot(const flatbuffers::String *pubKey);
   const std::vector<const ::iroha::AccountPermissionLedger*> accountGetPermissionLedger(const flatbuffers::String *pubKey);
   const std::vector<const ::iroha::AccountPermissionDomain*> accountGetPermissionDomain(const flatbuffers::String *pubKey);
   const std::vector<const ::iroha::AccountPermissionAsset*>  accountGetPermissionAsset(const flatbuffers::String *pubKey);
 
+  /**
+   * Capability mask (see permission::Capability) of account for the asset,
+   * served from the permission index; with uncommitted, read from the
+   * append transaction instead, which the index does not follow.
+   */
+  uint8_t accountGetAssetCapabilities(const flatbuffers::String *pubKey,
+                                      const flatbuffers::String *ledger_name,
+                                      const flatbuffers::String *domain_name,
+                                      const flatbuffers::String *asset_name,
+                                      bool uncommitted = false);
+
+  /**
+   * The index serves committed permissions: once the append transaction is
+   * committed, drop the accounts it changed; once it is aborted, forget
+   * them.
+   */
+  void permission_index_commit();
+  void permission_index_rollback();
+
   /*
    * Get total number of trees
    */
@@ -85,6 +122,7 @@ class WSV {
  private:
   std::unordered_map<std::string, std::pair<MDB_dbi, MDB_cursor *>> trees_;
   MDB_txn *append_tx_;
+  MDB_env *env_ = nullptr;
 
   uint32_t wsv_trees_total;
 
@@ -93,6 +131,20 @@ class WSV {
 
   void read_created_assets();
 
+  // (pubkey, ledger+domain+asset) => capability mask
+  PermissionIndex permission_index_;
+
+  // accounts whose permissions the append transaction changed; all of
+  // them for a change without a target account
+  std::vector<std::string> permissions_changed_;
+  bool all_permissions_changed_ = false;
+
+  void permission_changed(const flatbuffers::String *pubKey);
+
+  void accountVisitPermissionAsset(const flatbuffers::String *pubKey,
+                                   const PermissionIndex::Visitor &visit,
+                                   bool uncommitted, MDB_env *env);
+
   // WSV commands:
   // Use for operate Asset.
   void add(const iroha::Add *command);
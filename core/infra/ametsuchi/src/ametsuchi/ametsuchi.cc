@@ -17,6 +17,7 @@
 
 #include <ametsuchi/ametsuchi.h>
 #include <transaction_generated.h>
+#include <utils/probes.hpp>
 #include <iostream>
 
 // static auto console = spdlog::stdout_color_mt("ametsuchi");
@@ -44,10 +45,12 @@ Ametsuchi::~Ametsuchi() {
 
 
 merkle::hash_t Ametsuchi::append(const std::vector<uint8_t> *blob) {
+  IROHA_PROBE1(ametsuchi_append_start, blob->size());
   // 1. Append to TX_store
   auto mt_root = tx_store.append(blob);
   // 2. Update WSV
   wsv.update(blob);
+  IROHA_PROBE1(ametsuchi_append_end, blob->size());
   return mt_root;
 }
 
@@ -62,29 +65,44 @@ merkle::hash_t Ametsuchi::append(
 
 
 void Ametsuchi::commit() {
+  IROHA_PROBE(ametsuchi_commit_start);
   // commit merkle tree
   tx_store.commit();
   // commit old transaction
   tx_store.close_cursors();
   wsv.close_cursors();
+  IROHA_PROBE1(lmdb_txn_commit, append_tx_);
   mdb_txn_commit(append_tx_);
   mdb_env_stat(env, &mst);
+  wsv.permission_index_commit();
 
   // create new append transaction
   init_append_tx();
+  IROHA_PROBE(ametsuchi_commit_end);
 }
 
 
 void Ametsuchi::rollback() {
   abort_append_tx();
   init_append_tx();
+  wsv.permission_index_rollback();
 }
 
 
 void Ametsuchi::abort_append_tx() {
   tx_store.close_cursors();
   wsv.close_cursors();
-  if (append_tx_) mdb_txn_abort(append_tx_);
+  if (append_tx_) {
+    IROHA_PROBE1(lmdb_txn_abort, append_tx_);
+    mdb_txn_abort(append_tx_);
+  }
+}
+
+
+MDB_stat Ametsuchi::stat() {
+  MDB_stat st{};
+  mdb_env_stat(env, &st);
+  return st;
 }
 
 
@@ -158,6 +176,7 @@ void Ametsuchi::init_append_tx() {
     AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
     AMETSUCHI_CRITICAL(res, ENOMEM);
   }
+  IROHA_PROBE1(lmdb_txn_begin, append_tx_);
   // Create database instances for each tree, open cursors for each tree, save
   // them in map for tx_store and wsv
   tx_store.init(append_tx_);
@@ -172,6 +191,17 @@ const ::iroha::Transaction *Ametsuchi::getTransaction(size_t index,
       tx_store.getTransaction(index, uncommitted, env).data);
 }
 
+void Ametsuchi::getTransactionRange(
+    size_t from, size_t to,
+    const std::function<bool(size_t, const AM_val &)> &visit,
+    bool uncommitted) {
+  tx_store.getTransactionRange(from, to, visit, uncommitted, env);
+}
+
+size_t Ametsuchi::getTransactionCount(bool uncommitted) {
+  return tx_store.getTransactionCount(uncommitted, env);
+}
+
 std::vector<const ::iroha::Asset *> Ametsuchi::accountGetAllAssets(
     const flatbuffers::String *pubKey, bool uncommitted) {
   return wsv.accountGetAllAssets(pubKey, uncommitted, env);
@@ -186,6 +216,15 @@ const ::iroha::Asset *Ametsuchi::accountGetAsset(
                              uncommitted, env);
 }
 
+void Ametsuchi::accountVisitAssets(
+    const flatbuffers::String *pubKey, const flatbuffers::String *ledger_name,
+    const flatbuffers::String *domain_name,
+    const flatbuffers::String *asset_name,
+    const std::function<void(const AM_val &)> &visit, bool uncommitted) {
+  wsv.accountVisitAssets(pubKey, ledger_name, domain_name, asset_name, visit,
+                         uncommitted, env);
+}
+
 
 const ::iroha::Asset *Ametsuchi::assetidGetAsset(
     const std::string &&ledger_name, const std::string &&domain_name,
@@ -207,6 +246,20 @@ Ametsuchi::assetGetPermissionAsset(const flatbuffers::String *pubKey) {
   return wsv.accountGetPermissionAsset(pubKey);
 }
 
+uint8_t Ametsuchi::assetGetCapabilities(const flatbuffers::String *pubKey,
+                                        const flatbuffers::String *ledger_name,
+                                        const flatbuffers::String *domain_name,
+                                        const flatbuffers::String *asset_name,
+                                        bool uncommitted) {
+  return wsv.accountGetAssetCapabilities(pubKey, ledger_name, domain_name,
+                                         asset_name, uncommitted);
+}
+
+bool Ametsuchi::accountExists(const flatbuffers::String *pubKey,
+                              bool uncommitted) {
+  return wsv.accountExists(pubKey, uncommitted, env);
+}
+
 
 const ::iroha::Peer *Ametsuchi::pubKeyGetPeer(const flatbuffers::String *pubKey,
                                               bool uncommitted) {
@@ -196,6 +196,31 @@ hash_t MerkleTree::hash(const uint8_t *data, size_t size) {
   return output;
 }
 
+/**
+ * Replaces nodes with the level above them, an odd node goes up unchanged
+ */
+static void reduce(std::vector<hash_t> &nodes) {
+  size_t n = 0;
+  for (size_t i = 0; i + 1 < nodes.size(); i += 2) {
+    nodes[n++] = MerkleTree::hash(nodes[i], nodes[i + 1]);
+  }
+  if (nodes.size() % 2 == 1) nodes[n++] = nodes.back();
+  nodes.resize(n);
+}
+
+hash_t MerkleTree::root_of(std::vector<hash_t> leafs) {
+  if (leafs.empty()) return hash_t{};
+
+  while (leafs.size() > 1) reduce(leafs);
+  return leafs[0];
+}
+
+std::vector<hash_t> MerkleTree::level_of(std::vector<hash_t> leafs,
+                                         size_t level) {
+  for (size_t i = 0; i < level && leafs.size() > 1; i++) reduce(leafs);
+  return leafs;
+}
+
 std::string MerkleTree::printelement(const std::vector<hash_t> &tree, size_t i,
                                      size_t amount) {
   std::string out;
@@ -0,0 +1,179 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ametsuchi/permission_index.h>
+#include <cstring>
+#include <mutex>
+
+namespace ametsuchi {
+
+namespace permission {
+
+uint8_t capabilitiesOf(const ::iroha::AccountPermissionAsset *permission) {
+  uint8_t mask = 0;
+  if (permission->read()) mask |= READ;
+  if (permission->transfer()) mask |= TRANSFER;
+  if (permission->add()) mask |= ADD;
+  if (permission->subtract()) mask |= SUBTRACT;
+  if (permission->account_give_permission()) mask |= GIVE_PERMISSION;
+  return mask;
+}
+
+}  // namespace permission
+
+namespace {
+
+struct Piece {
+  const char *data;
+  size_t size;
+};
+
+inline Piece piece(const flatbuffers::String *s) {
+  if (s == nullptr) return {"", 0};
+  return {s->c_str(), s->size()};
+}
+
+inline Piece piece(const std::string &s) { return {s.data(), s.size()}; }
+
+// FNV-1a over the pieces, each one terminated by \0
+inline uint64_t hash(std::initializer_list<Piece> pieces) {
+  uint64_t h = 14695981039346656037ULL;
+  for (const auto &p : pieces) {
+    for (size_t i = 0; i < p.size; i++) {
+      h ^= static_cast<uint8_t>(p.data[i]);
+      h *= 1099511628211ULL;
+    }
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// compare "a\0b\0c\0d" with pieces without building the key
+inline bool matches(const std::string &key, std::initializer_list<Piece> pieces) {
+  size_t pos = 0;
+  for (const auto &p : pieces) {
+    if (pos + p.size > key.size()) return false;
+    if (std::memcmp(key.data() + pos, p.data, p.size) != 0) return false;
+    pos += p.size;
+    if (pos < key.size()) {
+      if (key[pos] != '\0') return false;
+      pos++;
+    }
+  }
+  return pos == key.size();
+}
+
+}  // namespace
+
+PermissionIndex::PermissionIndex(Loader loader) : loader_(std::move(loader)) {}
+
+uint8_t PermissionIndex::get(const flatbuffers::String *pubKey,
+                             const flatbuffers::String *ledger_name,
+                             const flatbuffers::String *domain_name,
+                             const flatbuffers::String *asset_name) {
+  uint8_t mask = 0;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if (lookup(pubKey, ledger_name, domain_name, asset_name, &mask))
+      return mask;
+  }
+
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  if (!lookup(pubKey, ledger_name, domain_name, asset_name, &mask)) {
+    loader_(pubKey, [&](const ::iroha::AccountPermissionAsset *p) {
+      insert(pubKey, p->ledger_name()->str(), p->domain_name()->str(),
+             p->asset_name()->str(), permission::capabilitiesOf(p));
+    });
+    insert(pubKey, "", "", "", 0);
+    lookup(pubKey, ledger_name, domain_name, asset_name, &mask);
+  }
+  return mask;
+}
+
+void PermissionIndex::invalidate(const flatbuffers::String *pubKey) {
+  if (pubKey == nullptr) {
+    clear();
+    return;
+  }
+  invalidate(pubKey->str());
+}
+
+void PermissionIndex::invalidate(const std::string &pubKey) {
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  // permission changes are rare, a full scan keeps lookups single-level
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const auto &key = it->second.key;
+    if (key.size() > pubKey.size() && key[pubKey.size()] == '\0' &&
+        std::memcmp(key.data(), pubKey.data(), pubKey.size()) == 0) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void PermissionIndex::clear() {
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  entries_.clear();
+}
+
+bool PermissionIndex::lookup(const flatbuffers::String *pubKey,
+                             const flatbuffers::String *ledger_name,
+                             const flatbuffers::String *domain_name,
+                             const flatbuffers::String *asset_name,
+                             uint8_t *mask) const {
+  const std::initializer_list<Piece> asset = {
+      piece(pubKey), piece(ledger_name), piece(domain_name), piece(asset_name)};
+  auto range = entries_.equal_range(hash(asset));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (matches(it->second.key, asset)) {
+      *mask = it->second.mask;
+      return true;
+    }
+  }
+
+  // account is loaded, but has no permission for this asset
+  const std::initializer_list<Piece> account = {piece(pubKey), {"", 0},
+                                                {"", 0}, {"", 0}};
+  range = entries_.equal_range(hash(account));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (matches(it->second.key, account)) {
+      *mask = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void PermissionIndex::insert(const flatbuffers::String *pubKey,
+                             const std::string &ledger_name,
+                             const std::string &domain_name,
+                             const std::string &asset_name, uint8_t mask) {
+  std::string key = pubKey->str();
+  key.push_back('\0');
+  key += ledger_name;
+  key.push_back('\0');
+  key += domain_name;
+  key.push_back('\0');
+  key += asset_name;
+
+  entries_.emplace(hash({piece(pubKey), piece(ledger_name), piece(domain_name),
+                         piece(asset_name)}),
+                   Entry{std::move(key), mask});
+}
+
+}  // namespace ametsuchi
@@ -19,6 +19,7 @@
 #include <ametsuchi/tx_store.h>
 #include <asset_generated.h>
 #include <transaction_generated.h>
+#include <utils/probes.hpp>
 #include <iostream>
 
 namespace ametsuchi {
@@ -89,6 +90,7 @@ merkle::hash_t TxStore::append(const std::vector<uint8_t> *blob) {
   //assert(tx->hash()->size() == merkle::HASH_LEN);
   std::copy(tx->hash()->begin(), tx->hash()->end(), &h[0]);
   merkleTree_.push(h);
+  IROHA_PROBE1(merkle_push, h.data());
   return merkleTree_.root();
 }
 
@@ -323,7 +325,7 @@ AM_val TxStore::getTransaction(size_t index, bool uncommitted, MDB_env *env) {
 
   tx_key.mv_data = &index;
   tx_key.mv_size = sizeof(index);
-  if ((res = mdb_cursor_get(tx_cursor, &tx_key, &tx_val, MDB_FIRST)) != 0) {
+  if ((res = mdb_cursor_get(tx_cursor, &tx_key, &tx_val, MDB_SET_KEY)) != 0) {
     AMETSUCHI_CRITICAL(res, MDB_NOTFOUND);
     AMETSUCHI_CRITICAL(res, EINVAL);
   }
@@ -334,6 +336,77 @@ AM_val TxStore::getTransaction(size_t index, bool uncommitted, MDB_env *env) {
   return AM_val(tx_val);
 }
 
+void TxStore::getTransactionRange(
+    size_t from, size_t to,
+    const std::function<bool(size_t, const AM_val &)> &visit,
+    bool uncommitted, MDB_env *env) {
+  MDB_val tx_key, tx_val;
+  MDB_cursor *tx_cursor;
+  MDB_txn *tx;
+  int res;
+
+  if (uncommitted) {
+    tx_cursor = trees_.at("tx_store").second;
+  } else {
+    // one read-only transaction for the whole range
+    if ((res = mdb_txn_begin(env, nullptr, MDB_RDONLY, &tx)) != 0) {
+      AMETSUCHI_CRITICAL(res, MDB_PANIC);
+      AMETSUCHI_CRITICAL(res, MDB_MAP_RESIZED);
+      AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
+      AMETSUCHI_CRITICAL(res, ENOMEM);
+    }
+    if ((res = mdb_cursor_open(tx, trees_.at("tx_store").first, &tx_cursor)) !=
+        0) {
+      AMETSUCHI_CRITICAL(res, EINVAL);
+    }
+  }
+
+  tx_key.mv_data = &from;
+  tx_key.mv_size = sizeof(from);
+  res = mdb_cursor_get(tx_cursor, &tx_key, &tx_val, MDB_SET_RANGE);
+  while (res == 0) {
+    auto index = *reinterpret_cast<size_t *>(tx_key.mv_data);
+    if (index >= to || !visit(index, AM_val(tx_val))) break;
+    res = mdb_cursor_get(tx_cursor, &tx_key, &tx_val, MDB_NEXT);
+  }
+  if (res != 0 && res != MDB_NOTFOUND) {
+    AMETSUCHI_CRITICAL(res, EINVAL);
+  }
+
+  if (!uncommitted) {
+    mdb_cursor_close(tx_cursor);
+    mdb_txn_abort(tx);
+  }
+}
+
+size_t TxStore::getTransactionCount(bool uncommitted, MDB_env *env) {
+  if (uncommitted) return tx_store_total;
+
+  size_t last = 0;
+  MDB_val tx_key, tx_val;
+  MDB_cursor *tx_cursor;
+  MDB_txn *tx;
+  int res;
+  if ((res = mdb_txn_begin(env, nullptr, MDB_RDONLY, &tx)) != 0) {
+    AMETSUCHI_CRITICAL(res, MDB_PANIC);
+    AMETSUCHI_CRITICAL(res, MDB_MAP_RESIZED);
+    AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
+    AMETSUCHI_CRITICAL(res, ENOMEM);
+  }
+  if ((res = mdb_cursor_open(tx, trees_.at("tx_store").first, &tx_cursor)) !=
+      0) {
+    AMETSUCHI_CRITICAL(res, EINVAL);
+  }
+  if ((res = mdb_cursor_get(tx_cursor, &tx_key, &tx_val, MDB_LAST)) == 0) {
+    last = *reinterpret_cast<size_t *>(tx_key.mv_data);
+  } else if (res != MDB_NOTFOUND) {
+    AMETSUCHI_CRITICAL(res, EINVAL);
+  }
+  mdb_cursor_close(tx_cursor);
+  mdb_txn_abort(tx);
+  return last;
+}
+
 std::vector<AM_val> TxStore::getAssetTransferBySender(
     const flatbuffers::String *senderKey, bool uncommitted, MDB_env *env) {
   return getTxByKey("index_transfer_sender", senderKey, uncommitted, env);
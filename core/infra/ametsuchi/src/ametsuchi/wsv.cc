@@ -54,6 +54,7 @@ const flatbuffers::String *to_String(__int128_t value) {
 
 void WSV::init(MDB_txn *append_tx) {
   append_tx_ = append_tx;
+  env_ = mdb_txn_env(append_tx);
 
   // [pubkey] => assets (DUP)
   trees_["wsv_pubkey_assets"] = init_btree(
@@ -128,10 +129,15 @@ void WSV::update(const std::vector<uint8_t> *blob) {
       // Use for account operate
       case iroha::Command::AccountAdd: {
         account_add(tx->command_as_AccountAdd());
+        permission_changed(
+            flatbuffers::GetRoot<iroha::Account>(
+                tx->command_as_AccountAdd()->account()->data())
+                ->pubKey());
         break;
       }
       case iroha::Command::AccountRemove: {
         account_remove(tx->command_as_AccountRemove());
+        permission_changed(tx->command_as_AccountRemove()->pubkey());
         break;
       }
       /*
@@ -166,10 +172,12 @@ void WSV::update(const std::vector<uint8_t> *blob) {
       }*/
       case iroha::Command::PermissionAdd: {
         permisson_add(tx->command_as_PermissionAdd());
+        permission_changed(tx->command_as_PermissionAdd()->targetAccount());
         break;
       }
       case iroha::Command::PermissionRemove: {
         permisson_remove(tx->command_as_PermissionRemove());
+        permission_changed(tx->command_as_PermissionRemove()->targetAccount());
         break;
       }
       default: {
@@ -179,7 +187,12 @@ void WSV::update(const std::vector<uint8_t> *blob) {
     }
   }
 }
-WSV::WSV() {}
+WSV::WSV()
+    // the index follows committed data, read in a transaction of its own
+    : permission_index_([this](const flatbuffers::String *pubKey,
+                               const PermissionIndex::Visitor &visit) {
+        accountVisitPermissionAsset(pubKey, visit, false, env_);
+      }) {}
 WSV::~WSV() {}
 
 void WSV::read_created_assets() {
@@ -844,6 +857,66 @@ const ::iroha::Asset *WSV::assetidGetAsset(const std::string &&assetid,
   return flatbuffers::GetRoot<::iroha::Asset>(c_val.mv_data);
 }
 
+void WSV::accountVisitAssets(const flatbuffers::String *pubKey,
+                             const flatbuffers::String *ln,
+                             const flatbuffers::String *dn,
+                             const flatbuffers::String *an,
+                             const std::function<void(const AM_val &)> &visit,
+                             bool uncommitted, MDB_env *env) {
+  MDB_val c_key, c_val;
+  MDB_cursor *cursor;
+  MDB_txn *tx;
+  int res;
+
+  // a single asset is found by its created blob, as in accountGetAsset
+  const bool single = ln != nullptr && dn != nullptr && an != nullptr;
+  if (single) {
+    auto blob = created_assets_.find(ln->str() + dn->str() + an->str());
+    if (blob == created_assets_.end()) return;
+    c_val.mv_data = (void *)blob->second.data();
+    c_val.mv_size = blob->second.size();
+  }
+
+  if (uncommitted) {
+    cursor = trees_.at("wsv_pubkey_assets").second;
+    tx = append_tx_;
+  } else {
+    // create read-only transaction, create new RO cursor
+    if ((res = mdb_txn_begin(env, NULL, MDB_RDONLY, &tx))) {
+      AMETSUCHI_CRITICAL(res, MDB_PANIC);
+      AMETSUCHI_CRITICAL(res, MDB_MAP_RESIZED);
+      AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
+      AMETSUCHI_CRITICAL(res, ENOMEM);
+    }
+    if ((res = mdb_cursor_open(tx, trees_.at("wsv_pubkey_assets").first,
+                               &cursor))) {
+      AMETSUCHI_CRITICAL(res, EINVAL);
+    }
+  }
+
+  c_key.mv_data = (void *)pubKey->data();
+  c_key.mv_size = pubKey->size();
+
+  res = mdb_cursor_get(cursor, &c_key, &c_val, single ? MDB_GET_BOTH : MDB_SET);
+  if (res == 0 && single) {
+    // MDB_GET_BOTH leaves c_val at the query, read the stored one
+    res = mdb_cursor_get(cursor, &c_key, &c_val, MDB_GET_CURRENT);
+  }
+  while (res == 0) {
+    visit(AM_val(c_val));
+    if (single) break;
+    res = mdb_cursor_get(cursor, &c_key, &c_val, MDB_NEXT_DUP);
+  }
+  if (res != 0 && res != MDB_NOTFOUND) {
+    AMETSUCHI_CRITICAL(res, EINVAL);
+  }
+
+  if (!uncommitted) {
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(tx);
+  }
+}
+
 std::vector<const ::iroha::Asset *> WSV::accountGetAllAssets(
     const flatbuffers::String *pubKey, bool uncommitted, MDB_env *env) {
   MDB_val c_key, c_val;
@@ -968,14 +1041,110 @@ const std::vector<const ::iroha::AccountPermissionAsset*>  WSV::accountGetPermis
     AMETSUCHI_CRITICAL(res, EINVAL);
   }
 
-  flatbuffers::FlatBufferBuilder fbb;
   auto account = flatbuffers::GetRoot<::iroha::Account>(c_val.mv_data);
+  if (account->assetPermissions() == nullptr) return permission_vec;
   for(const auto& pdw: *account->assetPermissions()){
     permission_vec.emplace_back(pdw->permission_nested_root());
   }
   return permission_vec;
 }
 
+uint8_t WSV::accountGetAssetCapabilities(
+    const flatbuffers::String *pubKey, const flatbuffers::String *ledger_name,
+    const flatbuffers::String *domain_name,
+    const flatbuffers::String *asset_name, bool uncommitted) {
+  if (!uncommitted) {
+    return permission_index_.get(pubKey, ledger_name, domain_name, asset_name);
+  }
+
+  auto equal = [](const flatbuffers::String *a, const flatbuffers::String *b) {
+    return a != nullptr && b != nullptr && a->str() == b->str();
+  };
+  uint8_t mask = 0;
+  accountVisitPermissionAsset(
+      pubKey,
+      [&](const ::iroha::AccountPermissionAsset *p) {
+        if (equal(p->ledger_name(), ledger_name) &&
+            equal(p->domain_name(), domain_name) &&
+            equal(p->asset_name(), asset_name)) {
+          mask = permission::capabilitiesOf(p);
+        }
+      },
+      true, nullptr);
+  return mask;
+}
+
+void WSV::accountVisitPermissionAsset(const flatbuffers::String *pubKey,
+                                      const PermissionIndex::Visitor &visit,
+                                      bool uncommitted, MDB_env *env) {
+  MDB_val c_key, c_val;
+  MDB_cursor *cursor;
+  MDB_txn *tx;
+  int res;
+
+  c_key.mv_data = (void *)pubKey->data();
+  c_key.mv_size = pubKey->size();
+
+  if (uncommitted) {
+    cursor = trees_.at("wsv_pubkey_account").second;
+  } else {
+    // create read-only transaction, create new RO cursor
+    if ((res = mdb_txn_begin(env, NULL, MDB_RDONLY, &tx))) {
+      AMETSUCHI_CRITICAL(res, MDB_PANIC);
+      AMETSUCHI_CRITICAL(res, MDB_MAP_RESIZED);
+      AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
+      AMETSUCHI_CRITICAL(res, ENOMEM);
+    }
+
+    if ((res = mdb_cursor_open(tx, trees_.at("wsv_pubkey_account").first,
+                               &cursor))) {
+      mdb_txn_abort(tx);
+      AMETSUCHI_CRITICAL(res, EINVAL);
+    }
+  }
+
+  // an account that does not exist has no permission
+  res = mdb_cursor_get(cursor, &c_key, &c_val, MDB_SET);
+  if (res == 0) {
+    auto account = flatbuffers::GetRoot<::iroha::Account>(c_val.mv_data);
+    if (account->assetPermissions() != nullptr) {
+      for (const auto &pw : *account->assetPermissions()) {
+        visit(pw->permission_nested_root());
+      }
+    }
+  }
+
+  if (!uncommitted) {
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(tx);
+  }
+  if (res != MDB_NOTFOUND) AMETSUCHI_CRITICAL(res, EINVAL);
+}
+
+void WSV::permission_changed(const flatbuffers::String *pubKey) {
+  if (pubKey == nullptr) {
+    all_permissions_changed_ = true;
+  } else {
+    permissions_changed_.push_back(pubKey->str());
+  }
+}
+
+void WSV::permission_index_commit() {
+  if (all_permissions_changed_) {
+    permission_index_.clear();
+  } else {
+    for (const auto &pubKey : permissions_changed_) {
+      permission_index_.invalidate(pubKey);
+    }
+  }
+  permission_index_rollback();
+}
+
+void WSV::permission_index_rollback() {
+  permissions_changed_.clear();
+  all_permissions_changed_ = false;
+}
+
 
 const ::iroha::Peer *WSV::pubKeyGetPeer(const flatbuffers::String *pubKey,
                                         bool uncommitted, MDB_env *env) {
@@ -1021,6 +1190,46 @@ const ::iroha::Peer *WSV::pubKeyGetPeer(const flatbuffers::String *pubKey,
   return flatbuffers::GetRoot<::iroha::Peer>(c_val.mv_data);
 }
 
+bool WSV::accountExists(const flatbuffers::String *pubKey, bool uncommitted,
+                        MDB_env *env) {
+  MDB_val c_key, c_val;
+  MDB_cursor *cursor;
+  MDB_txn *tx;
+  int res;
+
+  c_key.mv_data = (void *)pubKey->data();
+  c_key.mv_size = pubKey->size();
+
+  if (uncommitted) {
+    cursor = trees_.at("wsv_pubkey_account").second;
+  } else {
+    // create read-only transaction, create new RO cursor
+    if ((res = mdb_txn_begin(env, NULL, MDB_RDONLY, &tx))) {
+      AMETSUCHI_CRITICAL(res, MDB_PANIC);
+      AMETSUCHI_CRITICAL(res, MDB_MAP_RESIZED);
+      AMETSUCHI_CRITICAL(res, MDB_READERS_FULL);
+      AMETSUCHI_CRITICAL(res, ENOMEM);
+    }
+
+    if ((res = mdb_cursor_open(tx, trees_.at("wsv_pubkey_account").first,
+                               &cursor))) {
+      mdb_txn_abort(tx);
+      AMETSUCHI_CRITICAL(res, EINVAL);
+    }
+  }
+
+  res = mdb_cursor_get(cursor, &c_key, &c_val, MDB_SET);
+
+  if (!uncommitted) {
+    mdb_cursor_close(cursor);
+    mdb_txn_abort(tx);
+  }
+
+  if (res == MDB_NOTFOUND) return false;
+  AMETSUCHI_CRITICAL(res, EINVAL);
+  return true;
+}
+
 void WSV::close_dbi(MDB_env *env) {
   for (auto &&it : trees_) {
     auto dbi = it.second.first;
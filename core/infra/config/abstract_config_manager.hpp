@@ -17,8 +17,11 @@ limitations under the License.
 #ifndef IROHA_CONFIG_H
 #define IROHA_CONFIG_H
 
+#include <atomic>
 #include <fstream>  // ifstream, ofstream
 #include <json.hpp>
+#include <memory>
+#include <mutex>
 #include <utils/expected.hpp>
 #include <utils/logger.hpp>
 #include "config_utils.hpp"
@@ -27,6 +30,11 @@ namespace config {
 
 using json = nlohmann::json;
 
+/**
+ * The config file is parsed once into an immutable tree. Getters read the
+ * tree in place; reload() parses the file again and publishes a new tree,
+ * readers keep the one they loaded.
+ */
 class AbstractConfigManager {
  private:
   Expected<std::string> readConfigData(const std::string& pathToJSONFile) {
@@ -39,11 +47,14 @@ class AbstractConfigManager {
     return std::string(it, std::istreambuf_iterator<char>());
   }
 
-  json openConfigData() {
+  // nullptr if the file is missing or invalid
+  std::shared_ptr<const json> openConfigData() {
     auto res = readConfigData(getConfigPath());
     if (res) {
       logger::debug("config") << "load json is " << *res;
-      parseConfigDataFromString(*res);
+      auto parsed = parseConfigDataFromString(*res);
+      if (parsed) return *parsed;
+      logger::error("config") << parsed.error();
     } else {
       try {
         std::rethrow_exception(res.excptr());
@@ -53,78 +64,138 @@ class AbstractConfigManager {
                                   << "', we will use default values.";
       }
     }
+    return nullptr;
+  }
 
-    return _configData;
+  void publish(std::shared_ptr<const json> data) {
+    // typed values first, so a reader that sees the tree sees them too
+    loaded(*data);
+    std::atomic_store(&_configData, std::move(data));
+    _version.fetch_add(1, std::memory_order_release);
+  }
+
+  // the node at params, nullptr if a key is missing
+  static const json* find(const json& root,
+                          std::initializer_list<const std::string> params) {
+    const json* node = &root;
+    for (auto& param : params) {
+      if (!node->is_object()) return nullptr;
+      auto it = node->find(param);
+      if (it == node->end()) return nullptr;
+      node = &*it;
+    }
+    return node;
   }
 
  protected:
   template <typename T>
   T getParam(std::initializer_list<const std::string> params,
              const T& defaultValue) {
-    auto tempConfigData = getConfigData();
+    const auto data = getConfigData();
+    return getParam(*data, params, defaultValue);
+  }
+
+  // the value at params in root, defaultValue if it is missing or mistyped
+  template <typename T>
+  static T getParam(const json& root,
+                    std::initializer_list<const std::string> params,
+                    const T& defaultValue) {
+    const auto node = find(root, params);
+    if (node == nullptr || node->is_null()) return defaultValue;
     try {
-      size_t i = 0;
-      for (auto& param : params) {
-        ++i;
-        if (i == params.size()) {
-          return tempConfigData.value(param, defaultValue);
-        }
-        tempConfigData = tempConfigData[param];
-      }
-      return tempConfigData;
+      return node->get<T>();
     } catch (...) {
+      std::string list_name = "";
+      for (auto& s : params) list_name += "\"" + s + "\", ";
+      logger::warning("config") << "{ " << list_name << "} has a wrong type, "
+                                << "the default value is used";
       return defaultValue;
     }
   }
 
   template <typename T>
   T getParamWithAssert(std::initializer_list<std::string> params) {
-    auto tempConfigData = getConfigData();
-    auto defaultValue = T();
+    const auto data = getConfigData();
+    const json* node = data.get();
+    size_t i = 0;
     try {
-      size_t i = 0;
       for (auto& param : params) {
         ++i;
-        if (i == params.size()) {
-          return tempConfigData.value(param,defaultValue);
+        if (!node->is_object()) throw std::out_of_range(param);
+        auto it = node->find(param);
+        if (it == node->end()) {
+          if (i == params.size()) return T();
+          throw std::out_of_range(param);
         }
-        tempConfigData = tempConfigData[param];
+        node = &*it;
       }
-      return tempConfigData;
+      return node->get<T>();
     } catch (...) {
       std::string list_name = "";
       for( auto& s : params ) list_name += "\"" + s + "\", ";
       list_name.erase(list_name.end()-2,list_name.end());
       logger::error("config") << "not Found { " << list_name << " } in " << getConfigName();
       assert(false);
+      return T();
     }
   }
 
-  virtual VoidHandler parseConfigDataFromString(const std::string& jsonStr) {
+  virtual Expected<std::shared_ptr<const json>> parseConfigDataFromString(
+      const std::string& jsonStr) {
     try {
-      _configData = json::parse(std::move(jsonStr));
-      return {};
+      return std::shared_ptr<const json>(
+          std::make_shared<json>(json::parse(jsonStr)));
     } catch (...) {
       return makeUnexpected(exception::config::ParseException(getConfigPath()));
     }
   }
 
+  /**
+   * Called with every tree before it is published, to build the typed
+   * values of the derived config from it.
+   */
+  virtual void loaded(const json& data) {}
+
  public:
   virtual std::string getConfigName() = 0;
   std::string getConfigPath() { return get_iroha_home() + getConfigName(); }
 
-  json getConfigData() {
-    if (_loaded) {
-      return this->_configData;
-    } else {
-      _loaded = true;
-      return openConfigData();
+  // never null, an empty tree if the file could not be loaded
+  std::shared_ptr<const json> getConfigData() {
+    auto data = std::atomic_load(&_configData);
+    if (data) return data;
+
+    std::lock_guard<std::mutex> lock(_loadMutex);
+    data = std::atomic_load(&_configData);
+    if (!data) {
+      data = openConfigData();
+      if (!data) data = std::make_shared<const json>(json::object());
+      publish(data);
     }
+    return data;
   }
 
- protected:
-  bool _loaded = false;
-  json _configData;
+  /**
+   * Parses the file again and publishes it. The current tree stays if the
+   * file is missing or invalid.
+   * @return true if a new tree was published
+   */
+  bool reload() {
+    std::lock_guard<std::mutex> lock(_loadMutex);
+    auto data = openConfigData();
+    if (!data) return false;
+    publish(std::move(data));
+    logger::info("config") << getConfigName() << " reloaded";
+    return true;
+  }
+
+  // moves on every publish
+  uint64_t version() const { return _version.load(std::memory_order_acquire); }
+
+ private:
+  std::mutex _loadMutex;
+  std::shared_ptr<const json> _configData;
+  std::atomic<uint64_t> _version{0};
 };
 }  // namespace config
 
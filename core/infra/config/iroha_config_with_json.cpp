@@ -25,6 +25,24 @@ IrohaConfigManager& IrohaConfigManager::getInstance() {
   return instance;
 }
 
+void IrohaConfigManager::loaded(const json& data) {
+  auto values = std::make_shared<IrohaConfigValues>();
+  values->grpcPort = getParam(data, {"grpc_port"}, values->grpcPort);
+  values->verifyStreamWindow =
+      getParam(data, {"verify_stream_window"}, values->verifyStreamWindow);
+  values->verifyRelayFanout =
+      getParam(data, {"verify_relay_fanout"}, values->verifyRelayFanout);
+  std::atomic_store(&values_,
+                    std::shared_ptr<const IrohaConfigValues>(std::move(values)));
+}
+
+std::shared_ptr<const IrohaConfigValues> IrohaConfigManager::values() {
+  auto values = std::atomic_load(&values_);
+  if (values) return values;
+  getConfigData();
+  return std::atomic_load(&values_);
+}
+
 std::string IrohaConfigManager::getDatabasePath(
     const std::string& defaultValue) {
   return this->getParam<std::string>({"database_path"}, defaultValue);
@@ -63,18 +81,98 @@ size_t IrohaConfigManager::getMaxFaultyPeers(size_t defaultValue) {
   return this->getParam<size_t>({"max_faulty_peers"}, defaultValue);
 }
 
+size_t IrohaConfigManager::getSumeragiCollectors(size_t defaultValue) {
+  return this->getParam<size_t>({"sumeragi_collectors"}, defaultValue);
+}
+
+bool IrohaConfigManager::getSumeragiPayloadDissemination(bool defaultValue) {
+  return this->getParam<bool>({"sumeragi_payload_dissemination"}, defaultValue);
+}
+
+bool IrohaConfigManager::getSumeragiLeaderRotation(bool defaultValue) {
+  return this->getParam<bool>({"sumeragi_leader_rotation"}, defaultValue);
+}
+
+bool IrohaConfigManager::getSumeragiLatencyOrder(bool defaultValue) {
+  return this->getParam<bool>({"sumeragi_latency_order"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getHijiriPingInterval(size_t defaultValue) {
+  return this->getParam<size_t>({"hijiri_ping_interval_ms"}, defaultValue);
+}
+
 size_t IrohaConfigManager::getPoolWorkerQueueSize(size_t defaultValue) {
   return this->getParam<size_t>({"pool_worker_queue_size"}, defaultValue);
 }
 
+size_t IrohaConfigManager::getSumeragiLaneQueueSize(const std::string& lane,
+                                                    size_t defaultValue) {
+  return this->getParam<size_t>({"sumeragi_lane_queue_size", lane},
+                                defaultValue);
+}
+
+size_t IrohaConfigManager::getSumeragiReservedWorkers(size_t defaultValue) {
+  return this->getParam<size_t>({"sumeragi_reserved_workers"}, defaultValue);
+}
+
+std::vector<size_t> IrohaConfigManager::getSumeragiCpuAffinity(
+    const std::vector<size_t>& defaultValue) {
+  return this->getParam<std::vector<size_t>>({"sumeragi_cpu_affinity"},
+                                             defaultValue);
+}
+
 uint16_t IrohaConfigManager::getGrpcPortNumber(uint16_t defaultValue) {
   return this->getParam<uint16_t>({"grpc_port"}, defaultValue);
 }
 
+size_t IrohaConfigManager::getGrpcCompletionQueueThreads(size_t defaultValue) {
+  return this->getParam<size_t>({"grpc_cq_threads"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcHandlerThreads(size_t defaultValue) {
+  return this->getParam<size_t>({"grpc_handler_threads"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getGrpcMaxConcurrentCalls(const std::string& service,
+                                                     size_t defaultValue) {
+  return this->getParam<size_t>({"grpc_max_concurrent_calls", service},
+                                defaultValue);
+}
+
+size_t IrohaConfigManager::getVerifyStreamWindow(size_t defaultValue) {
+  return this->getParam<size_t>({"verify_stream_window"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getVerifyRelayFanout(size_t defaultValue) {
+  return this->getParam<size_t>({"verify_relay_fanout"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getSyncChunkSize(size_t defaultValue) {
+  return this->getParam<size_t>({"sync_chunk_size"}, defaultValue);
+}
+
+size_t IrohaConfigManager::getSyncDiffLevels(size_t defaultValue) {
+  return this->getParam<size_t>({"sync_diff_levels"}, defaultValue);
+}
+
 uint16_t IrohaConfigManager::getHttpPortNumber(uint16_t defaultValue) {
   return this->getParam<uint16_t>({"http_port"}, defaultValue);
 }
 
+std::string IrohaConfigManager::getHttpAddress(
+    const std::string& defaultValue) {
+  return this->getParam<std::string>({"http_address"}, defaultValue);
+}
+
+double IrohaConfigManager::getTracingSampleRate(double defaultValue) {
+  return this->getParam<double>({"tracing_sample_rate"}, defaultValue);
+}
+
+std::string IrohaConfigManager::getTracingFile(
+    const std::string& defaultValue) {
+  return this->getParam<std::string>({"tracing_file"}, defaultValue);
+}
+
 bool IrohaConfigManager::getActiveStart(bool defaultValue = false) {
   return this->getParam<bool>({"active_start"}, defaultValue);
 }
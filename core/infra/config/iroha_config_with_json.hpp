@@ -20,14 +20,32 @@ limitations under the License.
 #include "abstract_config_manager.hpp"
 
 namespace config {
+
+/**
+ * Typed values of config.json read on every message, with their defaults.
+ */
+struct IrohaConfigValues {
+  uint16_t grpcPort = 50051;
+  size_t verifyStreamWindow = 64;
+  size_t verifyRelayFanout = 0;
+};
+
 class IrohaConfigManager : public AbstractConfigManager {
  private:
   IrohaConfigManager();
   std::string getConfigName() { return "config/config.json"; }
 
+  std::shared_ptr<const IrohaConfigValues> values_;
+
+ protected:
+  void loaded(const json& data) override;
+
  public:
   static IrohaConfigManager& getInstance();
 
+  // never null; replaced as a whole by reload()
+  std::shared_ptr<const IrohaConfigValues> values();
+
   std::string getDatabasePath(const std::string& defaultValue);
   std::string getJavaClassPath(const std::string& defaultValue);
   std::string getJavaClassPathLocal(const std::string& defaultValue);
@@ -37,9 +55,29 @@ class IrohaConfigManager : public AbstractConfigManager {
   std::string getJavaPolicyPath(const std::string& defaultValue);
   size_t getConcurrency(size_t defaultValue);
   size_t getMaxFaultyPeers(size_t defaultValue);
+  size_t getSumeragiCollectors(size_t defaultValue);
+  bool getSumeragiPayloadDissemination(bool defaultValue);
+  bool getSumeragiLeaderRotation(bool defaultValue);
+  bool getSumeragiLatencyOrder(bool defaultValue);
+  size_t getHijiriPingInterval(size_t defaultValue);
   size_t getPoolWorkerQueueSize(size_t defaultValue);
+  size_t getSumeragiLaneQueueSize(const std::string& lane, size_t defaultValue);
+  size_t getSumeragiReservedWorkers(size_t defaultValue);
+  std::vector<size_t> getSumeragiCpuAffinity(
+      const std::vector<size_t>& defaultValue);
   uint16_t getGrpcPortNumber(uint16_t defaultValue);
+  size_t getGrpcCompletionQueueThreads(size_t defaultValue);
+  size_t getGrpcHandlerThreads(size_t defaultValue);
+  size_t getGrpcMaxConcurrentCalls(const std::string& service,
+                                   size_t defaultValue);
+  size_t getVerifyStreamWindow(size_t defaultValue);
+  size_t getVerifyRelayFanout(size_t defaultValue);
+  size_t getSyncChunkSize(size_t defaultValue);
+  size_t getSyncDiffLevels(size_t defaultValue);
   uint16_t getHttpPortNumber(uint16_t defaultValue);
+  std::string getHttpAddress(const std::string& defaultValue);
+  double getTracingSampleRate(double defaultValue);
+  std::string getTracingFile(const std::string& defaultValue);
   bool getActiveStart(bool defaultValue);
 
   std::string getConfigLeaderIp(const std::string& defaultValue);
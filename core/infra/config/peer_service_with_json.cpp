@@ -49,19 +49,40 @@ double PeerServiceConfig::getMaxTrustScore(double defaultValue) {
   return getParam<double>({"max_trust_score"}, defaultValue);
 }
 
-VoidHandler PeerServiceConfig::parseConfigDataFromString(
-    const std::string& jsonStr) {
+Expected<std::shared_ptr<const json>>
+PeerServiceConfig::parseConfigDataFromString(const std::string& jsonStr) {
   auto res = ConfigFormat::getInstance().ensureFormatSumeragi(jsonStr);
 
   if (res) {
-    _configData = json::parse(std::move(jsonStr));
-    return {};
+    return std::shared_ptr<const json>(
+        std::make_shared<json>(json::parse(jsonStr)));
   } else {
     return makeUnexpected(
         exception::config::ParseException(getConfigPath(), true));
   }
 }
 
+void PeerServiceConfig::loaded(const json& data) {
+  auto values = std::make_shared<PeerServiceValues>();
+  values->myPublicKey = getParam<std::string>(data, {"me", "publicKey"}, "");
+  values->myPrivateKey = getParam<std::string>(data, {"me", "privateKey"}, "");
+  values->myIp = getParam<std::string>(data, {"me", "ip"}, "");
+  values->maxTrustScore = getParam<double>(data, {"max_trust_score"}, 100.0);
+  for (const auto& peer :
+       getParam<std::vector<json>>(data, {"group"}, std::vector<json>())) {
+    values->groupIps.push_back(getParam<std::string>(peer, {"ip"}, ""));
+  }
+  std::atomic_store(&values_,
+                    std::shared_ptr<const PeerServiceValues>(std::move(values)));
+}
+
+std::shared_ptr<const PeerServiceValues> PeerServiceConfig::values() {
+  auto values = std::atomic_load(&values_);
+  if (values) return values;
+  getConfigData();
+  return std::atomic_load(&values_);
+}
+
 std::vector<json> PeerServiceConfig::getGroup() {
   return getParamWithAssert<std::vector<json>>({"group"}); // WIP ASSERT FALSE;
 }
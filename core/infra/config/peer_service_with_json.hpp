@@ -18,8 +18,10 @@ limitations under the License.
 #define PEER_SERVICE_WITH_JSON_HPP
 
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
+#include <string>
 #include <vector>
 
 #include <infra/config/abstract_config_manager.hpp>
@@ -28,15 +30,33 @@ class VoidHandler;
 
 namespace config {
 
+/**
+ * Typed values of sumeragi.json, read on every message.
+ */
+struct PeerServiceValues {
+  std::string myPublicKey;
+  std::string myPrivateKey;
+  std::string myIp;
+  double maxTrustScore = 100.0;
+  std::vector<std::string> groupIps;  // in the order of "group"
+};
+
 class PeerServiceConfig : public AbstractConfigManager {
  private:
   PeerServiceConfig() noexcept;
   std::string getConfigName() override { return "config/sumeragi.json"; }
 
+  std::shared_ptr<const PeerServiceValues> values_;
+
  protected:
-  VoidHandler parseConfigDataFromString(const std::string& jsonStr) override;
+  Expected<std::shared_ptr<const json>> parseConfigDataFromString(
+      const std::string& jsonStr) override;
+  void loaded(const json& data) override;
 
  public:
+  // never null; replaced as a whole by reload()
+  std::shared_ptr<const PeerServiceValues> values();
+
   std::string getMyPublicKey();
   std::string getMyPrivateKey();
   std::string getMyIp();
@@ -27,15 +27,27 @@ limitations under the License.
 #include <utils/datetime.hpp>
 #include <utils/expected.hpp>
 #include <utils/logger.hpp>
+#include <utils/metrics.hpp>
 
 #include <endpoint.grpc.fb.h>
 #include <main_generated.h>
 
 #include <asset_generated.h>
+#include <thread_pool.hpp>
+
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <thread>
 
@@ -56,7 +68,13 @@ namespace connection {
   using Signature = ::iroha::Signature;
   using Sync = ::iroha::Sync;
   using TxRequest = ::iroha::TxRequest;
-  using TxWithIndex = ::iroha::TxWithIndex;
+  using TxBatch = ::iroha::TxBatch;
+  using VerifyFrame = ::iroha::VerifyFrame;
+  using VerifyAck = ::iroha::VerifyAck;
+  using TransactionBatch = ::iroha::TransactionBatch;
+  using BatchResponse = ::iroha::BatchResponse;
+  using PayloadRequest = ::iroha::PayloadRequest;
+  using PayloadAck = ::iroha::PayloadAck;
 
   using grpc::Channel;
   using grpc::Server;
@@ -74,6 +92,67 @@ namespace connection {
     RESPONSE_ERRCONN,      // connection error
   };
 
+  namespace {
+    // latency of rpc calls to the peer at ip, up to the reply (or the ack
+    // for VerifyStream)
+    metrics::Histogram &sendLatency(const std::string &ip, const char *rpc) {
+      return metrics::histogram("iroha_grpc_send_seconds",
+                                "Latency of RPCs to other peers",
+                                {{"peer", ip}, {"rpc", rpc}});
+    }
+
+    // a payload call slower than this counts as failed, like a lost ping
+    const auto payloadDeadline = std::chrono::seconds(1);
+
+    /**
+     * One channel per peer, shared by the calls made to it: a channel
+     * reconnects by itself, so it is never replaced.
+     */
+    std::shared_ptr<Channel> channelTo(const std::string &ip) {
+      static std::mutex mutex;
+      static std::unordered_map<std::string, std::shared_ptr<Channel>> channels;
+      std::lock_guard<std::mutex> lock(mutex);
+      auto &channel = channels[ip];
+      if (!channel) {
+        channel = grpc::CreateChannel(
+            ip + ":" +
+                std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
+            grpc::InsecureChannelCredentials());
+      }
+      return channel;
+    }
+
+    // digest events (sent once the bodies were published) carry no
+    // transactions
+    bool hasTransactions(const ConsensusEvent &event) {
+      return event.transactions() != nullptr &&
+             event.transactions()->size() > 0;
+    }
+
+    size_t digestCount(const ConsensusEvent &event) {
+      return event.digests() != nullptr
+                 ? event.digests()->size() / hash::Hash32::size()
+                 : 0;
+    }
+
+    /**
+     * What a Verify response signs: the transaction of the event, or
+     * its digests when it has none.
+     */
+    std::string verifiedPayload(const ConsensusEvent &event) {
+      if (hasTransactions(event)) {
+        return flatbuffer_service::toString(
+            *event.transactions()->Get(0)->tx_nested_root());
+      }
+      if (event.digests() == nullptr) {
+        return "";
+      }
+      return std::string(
+          reinterpret_cast<const char *>(event.digests()->data()),
+          event.digests()->size());
+    }
+  }  // namespace
+
   /************************************************************************************
    * Interface: Verify :: receive()
    ************************************************************************************/
@@ -92,8 +171,9 @@ namespace connection {
     }
 
     // ToDo rewrite operator() overload.
-    void invoke(const std::string &from, flatbuffers::unique_ptr_t &&arg) {
-      (*receiver_)(from, std::move(arg));
+    template <class... Args>
+    auto invoke(const std::string &from, Args &&... args) {
+      return (*receiver_)(from, std::forward<Args>(args)...);
     }
 
    private:
@@ -136,6 +216,10 @@ namespace connection {
           receiver.set(std::move(callback));
         }
 
+        // forwards an event of the relay tree to our children
+        void relay(const ::iroha::ConsensusEvent &event,
+                   const std::string &origin, size_t fanout);
+
       }  // namespace Verify
     }    // namespace SumeragiImpl
   }      // namespace iroha
@@ -153,6 +237,33 @@ namespace connection {
         }
 
       }  // namespace Torii
+
+      namespace ToriiBatch {
+        Receiver<ToriiBatch::CallBackFunc> receiver;
+
+        void receive(ToriiBatch::CallBackFunc &&callback) {
+          receiver.set(std::move(callback));
+        }
+
+      }  // namespace ToriiBatch
+
+      namespace Publish {
+        Receiver<Publish::CallBackFunc> receiver;
+
+        void receive(Publish::CallBackFunc &&callback) {
+          receiver.set(std::move(callback));
+        }
+
+      }  // namespace Publish
+
+      namespace FetchPayload {
+        Receiver<FetchPayload::CallBackFunc> receiver;
+
+        void receive(FetchPayload::CallBackFunc &&callback) {
+          receiver.set(std::move(callback));
+        }
+
+      }  // namespace FetchPayload
     }    // namespace SumeragiImpl
   }      // namespace iroha
 
@@ -174,10 +285,15 @@ namespace connection {
       logger::info("connection") << "Operation";
       logger::info("connection")
           << "size: " << consensusEvent.peerSignatures()->size();
-      logger::info("connection")
-          << "Transaction: "
-          << flatbuffer_service::toString(
-                 *consensusEvent.transactions()->Get(0)->tx_nested_root());
+      if (hasTransactions(consensusEvent)) {
+        logger::info("connection")
+            << "Transaction: "
+            << flatbuffer_service::toString(
+                   *consensusEvent.transactions()->Get(0)->tx_nested_root());
+      } else {
+        logger::info("connection")
+            << "digests: " << digestCount(consensusEvent);
+      }
 
       flatbuffers::FlatBufferBuilder fbb;
 
@@ -238,34 +354,57 @@ namespace connection {
       }
     }
 
+    VoidHandler ToriiBatch(const std::vector<const ::iroha::Transaction *> &txs,
+                           flatbuffers::BufferRef<BatchResponse> *responseRef) const {
+      ::grpc::ClientContext clientContext;
+      flatbuffers::FlatBufferBuilder fbb;
+      flatbuffers::FlatBufferBuilder xbb;
+
+      std::vector<flatbuffers::Offset<TransactionWrapper>> wrappers;
+      for (const auto tx : txs) {
+        xbb.Clear();
+        auto txOffset = flatbuffer_service::copyTransaction(xbb, *tx);
+        if (!txOffset) {
+          return makeUnexpected(
+              exception::connection::InvalidTransactionException());
+        }
+        xbb.Finish(txOffset.value());
+        wrappers.push_back(::iroha::CreateTransactionWrapper(
+            fbb, fbb.CreateVector(xbb.GetBufferPointer(), xbb.GetSize())));
+      }
+      fbb.Finish(::iroha::CreateTransactionBatchDirect(fbb, &wrappers));
+
+      flatbuffers::BufferRef<TransactionBatch> requestRef(
+          fbb.GetBufferPointer(), fbb.GetSize());
+
+      Status status =
+          stub_->ToriiBatch(&clientContext, requestRef, responseRef);
+
+      if (status.ok()) {
+        return {};
+      } else {
+        return makeUnexpected(exception::connection::RPCConnectionException(
+            static_cast<int>(status.error_code()), status.error_message()));
+      }
+    }
+
    private:
     std::unique_ptr<Sumeragi::Stub> stub_;
   };
 
   /**
    * SumeragiConnectionServiceImpl
+   * - handlers run on the handler pool and write the response into the
+   *   builder owned by their call, so they don't share any state.
    */
-  class SumeragiConnectionServiceImpl final
-      : public ::iroha::Sumeragi::Service {
+  class SumeragiConnectionServiceImpl final {
    public:
-    Status Verify(ServerContext *context,
-                  const flatbuffers::BufferRef<ConsensusEvent> *request,
-                  flatbuffers::BufferRef<Response> *response) override {
-      fbbResponse.Clear();
-
+    Status Verify(const ConsensusEvent &request,
+                  flatbuffers::FlatBufferBuilder &fbbResponse) {
       {
         flatbuffers::FlatBufferBuilder fbb;
-        auto event =
-            flatbuffer_service::copyConsensusEvent(fbb, *request->GetRoot());
+        auto event = flatbuffer_service::copyConsensusEvent(fbb, request);
         if (!event) {
-          fbb.Clear();
-          auto responseOffset = ::iroha::CreateResponseDirect(
-              fbbResponse, "CANCELLED", ::iroha::Code::FAIL,
-              0);  // FIXME: Currently, if it fails, no signature.
-          fbbResponse.Finish(responseOffset);
-
-          *response = flatbuffers::BufferRef<::iroha::Response>(
-              fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
           return Status::CANCELLED;
         }
 
@@ -276,46 +415,27 @@ namespace connection {
             from, std::move(fbb.ReleaseBufferPointer()));
       }
 
-      auto tx_str =
-          flatbuffer_service::toString(*request->GetRoot()
-                                            ->transactions()
-                                            ->Get(0)  // Future work: #(tx) = 1
-                                            ->tx_nested_root());
+      if (!hasTransactions(request)) {
+        logger::debug("SumeragiConnectionServiceImpl::Verify")
+            << "digests: " << digestCount(request);
+      }
       auto responseOffset = ::iroha::CreateResponseDirect(
           fbbResponse, "OK!!", ::iroha::Code::UNDECIDED,
           flatbuffer_service::primitives::CreateSignature(
-              fbbResponse, tx_str, datetime::unixtime()));
+              fbbResponse, verifiedPayload(request), datetime::unixtime()));
 
       fbbResponse.Finish(responseOffset);
-
-      *response = flatbuffers::BufferRef<::iroha::Response>(
-          fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
-
       return Status::OK;
     }
 
-    Status Torii(ServerContext *context,
-                 const flatbuffers::BufferRef<Transaction> *txRef,
-                 flatbuffers::BufferRef<Response> *responseRef) override {
+    Status Torii(const Transaction &tx,
+                 flatbuffers::FlatBufferBuilder &fbbResponse) {
       logger::debug("SumeragiConnectionServiceImpl::Torii") << "RPC works";
 
-      // This reference remains until next calling
-      // SumeragiConnectionServiceImpl::Torii() method.
-      fbbResponse.Clear();
-
       {
-        const auto tx = txRef->GetRoot();
         flatbuffers::FlatBufferBuilder fbb;
-        auto txoffset = flatbuffer_service::copyTransaction(fbb, *tx);
+        auto txoffset = flatbuffer_service::copyTransaction(fbb, tx);
         if (!txoffset) {
-          fbb.Clear();
-          auto responseOffset = ::iroha::CreateResponseDirect(
-              fbbResponse, "CANCELLED", ::iroha::Code::FAIL,
-              0);  // FIXME: Currently, if it fails, no signature.
-          fbbResponse.Finish(responseOffset);
-
-          *responseRef = flatbuffers::BufferRef<Response>(
-              fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
           return Status::CANCELLED;
         }
 
@@ -325,7 +445,7 @@ namespace connection {
             fbb.ReleaseBufferPointer());
       }
 
-      auto tx_str = flatbuffer_service::toString(*txRef->GetRoot());
+      auto tx_str = flatbuffer_service::toString(tx);
 
       auto responseOffset = ::iroha::CreateResponseDirect(
           fbbResponse, "OK!!", ::iroha::Code::UNDECIDED,
@@ -333,15 +453,177 @@ namespace connection {
               fbbResponse, tx_str, datetime::unixtime()));
 
       fbbResponse.Finish(responseOffset);
+      return Status::OK;
+    }
+
+    Status ToriiBatch(const ServerContext &context,
+                      const TransactionBatch &batch,
+                      flatbuffers::FlatBufferBuilder &fbbResponse) {
+      std::vector<uint8_t> codes;
+      auto status = ToriiStream(context, batch, codes);
+      if (!status.ok()) return status;
+      return ToriiStreamDone(codes, fbbResponse);
+    }
 
-      *responseRef = flatbuffers::BufferRef<Response>(
-          fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
+    /**
+     * Hands one message of the ToriiStream to sumeragi as a whole and
+     * keeps the codes of its transactions for the final response.
+     */
+    Status ToriiStream(const ServerContext &context,
+                       const TransactionBatch &batch,
+                       std::vector<uint8_t> &codes) {
+      // the codes come back at the end, in one response
+      const size_t maxTransactions = 1 << 20;
+
+      const size_t size =
+          batch.transactions() ? batch.transactions()->size() : 0;
+      logger::debug("SumeragiConnectionServiceImpl::ToriiStream")
+          << "batch of " << size << " from " << context.peer();
+      if (codes.size() + size > maxTransactions) {
+        return Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                      "more than " + std::to_string(maxTransactions) +
+                          " transactions in one stream");
+      }
+      for (auto code : connection::iroha::SumeragiImpl::ToriiBatch::receiver
+                           .invoke(context.peer(), batch)) {
+        codes.push_back(static_cast<uint8_t>(code));
+      }
+      return Status::OK;
+    }
 
+    Status ToriiStreamDone(std::vector<uint8_t> &codes,
+                           flatbuffers::FlatBufferBuilder &fbbResponse) {
+      auto responseOffset = ::iroha::CreateBatchResponse(
+          fbbResponse, fbbResponse.CreateString("OK!!"),
+          fbbResponse.CreateVector(codes));
+      fbbResponse.Finish(responseOffset);
       return Status::OK;
     }
 
+    Status Publish(const ServerContext &context,
+                   const TransactionBatch &bodies,
+                   flatbuffers::FlatBufferBuilder &fbbResponse) {
+      const auto stored =
+          connection::iroha::SumeragiImpl::Publish::receiver.invoke(
+              context.peer(), bodies);
+      fbbResponse.Finish(
+          ::iroha::CreatePayloadAck(fbbResponse, static_cast<uint32_t>(stored)));
+      return Status::OK;
+    }
+
+    Status FetchPayload(const ServerContext &context,
+                        const PayloadRequest &request,
+                        flatbuffers::FlatBufferBuilder &fbbResponse) {
+      // a consensus event names a few transactions, not the whole pool
+      const size_t maxDigests = 1024;
+
+      std::vector<hash::Hash32> digests;
+      if (request.digests() != nullptr) {
+        const auto count = std::min(
+            maxDigests, request.digests()->size() / hash::Hash32::size());
+        for (size_t i = 0; i < count; i++) {
+          hash::Hash32 digest;
+          std::memcpy(digest.bytes.data(),
+                      request.digests()->data() + i * hash::Hash32::size(),
+                      hash::Hash32::size());
+          digests.push_back(digest);
+        }
+      }
+
+      const auto bodies =
+          connection::iroha::SumeragiImpl::FetchPayload::receiver.invoke(
+              context.peer(), digests);
+      std::vector<flatbuffers::Offset<TransactionWrapper>> wrappers;
+      for (const auto &body : bodies) {
+        wrappers.push_back(
+            body.empty() ? ::iroha::CreateTransactionWrapper(fbbResponse)
+                         : ::iroha::CreateTransactionWrapperDirect(fbbResponse,
+                                                                   &body));
+      }
+      fbbResponse.Finish(
+          ::iroha::CreateTransactionBatchDirect(fbbResponse, &wrappers));
+      return Status::OK;
+    }
+
+    /**
+     * Delivers a frame of the VerifyStream to sumeragi.
+     * Frames at or below the delivered round of the sender session are
+     * duplicates resent after a reconnect and are dropped.
+     * @return true if fbbAck holds an ack to send back
+     */
+    bool VerifyStream(const VerifyFrame &frame,
+                      flatbuffers::FlatBufferBuilder &fbbAck) {
+      auto &session = sessionOf(frame.sender()->str());
+      std::lock_guard<std::mutex> lock(session.mutex);
+
+      const auto window = static_cast<uint32_t>(
+          config::IrohaConfigManager::getInstance().values()->verifyStreamWindow);
+      auto ack = [&] {
+        session.acked = session.delivered;
+        fbbAck.Finish(
+            ::iroha::CreateVerifyAck(fbbAck, session.delivered, window));
+        return true;
+      };
+
+      if (frame.event() == nullptr) {
+        if (session.id != frame.session()) {
+          // the sender restarted, its rounds start over
+          session.id = frame.session();
+          session.delivered = 0;
+        }
+        return ack();
+      }
+
+      if (frame.session() != session.id ||
+          frame.round() <= session.delivered) {
+        return false;
+      }
+
+      flatbuffers::Verifier verifier(frame.event()->data(),
+                                     frame.event()->size());
+      if (verifier.VerifyBuffer<ConsensusEvent>(nullptr)) {
+        const auto size = frame.event()->size();
+        flatbuffers::unique_ptr_t event(new uint8_t[size],
+                                        [](uint8_t *p) { delete[] p; });
+        std::memcpy(event.get(), frame.event()->data(), size);
+        if (frame.origin() != nullptr && frame.origin()->size() != 0) {
+          // forward first, our subtree should not wait for our own work
+          connection::iroha::SumeragiImpl::Verify::relay(
+              *flatbuffers::GetRoot<ConsensusEvent>(event.get()),
+              frame.origin()->str(), frame.fanout());
+        }
+        connection::iroha::SumeragiImpl::Verify::receiver.invoke(
+            frame.sender()->str(), std::move(event));
+      } else {
+        logger::error("connection")
+            << "invalid event in round " << frame.round() << " from "
+            << frame.sender()->str();
+      }
+      session.delivered = frame.round();
+
+      // cumulative acks, one per half window
+      if (session.delivered - session.acked >= std::max(1u, window / 2)) {
+        return ack();
+      }
+      return false;
+    }
+
    private:
-    flatbuffers::FlatBufferBuilder fbbResponse;
+    struct Session {
+      std::mutex mutex;
+      uint64_t id = 0;
+      uint64_t delivered = 0;
+      uint64_t acked = 0;
+    };
+
+    Session &sessionOf(const std::string &sender) {
+      std::lock_guard<std::mutex> lock(sessions_mutex_);
+      // nodes of unordered_map are stable
+      return sessions_[sender];
+    }
+
+    std::mutex sessions_mutex_;
+    std::unordered_map<std::string, Session> sessions_;
   };
 
 
@@ -351,46 +633,455 @@ namespace connection {
   namespace iroha {
     namespace SumeragiImpl {
       namespace Verify {
-        bool send(const std::string &ip, const ::iroha::ConsensusEvent &event) {
-          logger::info("connection") << "Send!";
-          if (::peer::service::isExistIP(ip)) {
-            logger::info("connection") << "IP exists: " << ip;
-            SumeragiConnectionClient client(grpc::CreateChannel(
-                ip + ":" +
-                    std::to_string(config::IrohaConfigManager::getInstance()
-                                       .getGrpcPortNumber(50051)),
-                grpc::InsecureChannelCredentials()));
-            // TODO return tx validity
-            flatbuffers::BufferRef<::iroha::Response> response;
-            auto handler = client.Verify(event, &response);
-            if (!handler) {
-              logger::error("connection") << handler.error();
-              return false;
+
+        /**
+         * VerifyStream to one peer.
+         * - events are numbered by round and kept until the peer acks them
+         * - at most `credit` frames are in flight past the acked round
+         * - at most maxOutbox frames wait, the oldest are dropped first:
+         *   their rounds are over, and the peer catches up by sync
+         * - when the stream breaks it reconnects, says hello with the
+         *   session id and resends every frame after the acked round
+         * - a peer without VerifyStream gets the events by unary Verify
+         */
+        class Stream {
+         public:
+          explicit Stream(const std::string &ip)
+              : ip_(ip),
+                ackLatency_(sendLatency(ip, "VerifyStream")),
+                outboxSize_(metrics::gauge("iroha_verify_stream_outbox",
+                                           "Events not acked yet by a peer",
+                                           {{"peer", ip}})),
+                dropped_(metrics::counter(
+                    "iroha_verify_stream_dropped",
+                    "Events dropped unsent because the outbox was full",
+                    {{"peer", ip}})),
+                thread_(&Stream::loop, this) {}
+
+          ~Stream() {
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              stop_ = true;
+              if (context_) context_->TryCancel();
             }
+            cv_.notify_all();
+            thread_.join();
+          }
 
-            auto reply = response.GetRoot();
-            if (reply->code() == ::iroha::Code::FAIL) {
-              logger::error("connection")
-                  << ::iroha::EnumNameCode(reply->code()) << ", "
-                  << reply->message();
-              return false;
+          /**
+           * @param origin - ip of the broadcaster if the peer should forward
+           * the event down the relay tree of fanout, empty otherwise
+           */
+          void push(const ::iroha::ConsensusEvent &event,
+                    const std::string &origin, size_t fanout = 0) {
+            flatbuffers::FlatBufferBuilder fbbEvent;
+            auto eventOffset =
+                flatbuffer_service::copyConsensusEvent(fbbEvent, event);
+            if (!eventOffset) {
+              logger::error("connection") << "invalid consensus event";
+              return;
             }
-            return true;
-          } else {
+            fbbEvent.Finish(*eventOffset);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto frame = std::make_shared<flatbuffers::FlatBufferBuilder>();
+            frame->Finish(::iroha::CreateVerifyFrame(
+                *frame, frame->CreateString(sender()), session(),
+                next_round_++,
+                frame->CreateVector(fbbEvent.GetBufferPointer(),
+                                    fbbEvent.GetSize()),
+                origin.empty() ? 0 : frame->CreateString(origin),
+                origin.empty() ? 0 : static_cast<uint32_t>(fanout)));
+            outbox_.push_back(frame);
+            pushedAt_.push_back(std::chrono::steady_clock::now());
+            if (outbox_.size() > maxOutbox) {
+              // the peer skips the round, rounds need not be contiguous
+              if (dropped_.value() == 0) {
+                logger::warning("connection")
+                    << "outbox to " << ip_ << " is full, oldest events dropped";
+              }
+              dropped_.inc();
+              release(acked_ + 1);
+            }
+            outboxSize_.set(outbox_.size());
+            cv_.notify_all();
+          }
+
+          // the peer answered the hello and the stream has not broken since
+          bool connected() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return connected_;
+          }
+
+         private:
+          static const size_t maxOutbox = 4096;
+          using Frame = std::shared_ptr<flatbuffers::FlatBufferBuilder>;
+          using ReaderWriter =
+              grpc::ClientReaderWriter<flatbuffers::BufferRef<VerifyFrame>,
+                                       flatbuffers::BufferRef<VerifyAck>>;
+
+          static const std::string &sender() {
+            static const auto key =
+                config::PeerServiceConfig::getInstance().getMyPublicKey();
+            return key;
+          }
+
+          // tells the peer that rounds restarted from 1 in this process
+          static uint64_t session() {
+            static const uint64_t id = [] {
+              std::random_device rd;
+              return (static_cast<uint64_t>(rd()) << 32) | rd();
+            }();
+            return id;
+          }
+
+          void loop() {
+            auto backoff = std::chrono::milliseconds(100);
+            while (true) {
+              {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_) return;
+              }
+              if (unary() ? serveUnary() : serve()) {
+                backoff = std::chrono::milliseconds(100);
+              } else {
+                logger::warning("connection")
+                    << "VerifyStream to " << ip_ << " broken, retry in "
+                    << backoff.count() << "ms";
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait_for(lock, backoff, [this] { return stop_; });
+                backoff =
+                    std::min(backoff * 2, std::chrono::milliseconds(5000));
+              }
+            }
+          }
+
+          bool unary() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return unary_;
+          }
+
+          /**
+           * Runs one stream until it breaks.
+           * @return true if the peer answered the hello
+           */
+          bool serve() {
+            auto stub = Sumeragi::NewStub(channelTo(ip_));
+            ClientContext context;
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              if (stop_) return true;
+              context_ = &context;
+            }
+            std::unique_ptr<ReaderWriter> stream(stub->VerifyStream(&context));
+
+            // a peer that does not answer the hello in a second is cancelled
+            bool answered = false;
+            std::thread watchdog([this, &context, &answered] {
+              std::unique_lock<std::mutex> lock(mutex_);
+              if (!cv_.wait_for(lock, std::chrono::seconds(1),
+                                [&] { return answered || stop_; })) {
+                context.TryCancel();
+              }
+            });
+
+            flatbuffers::FlatBufferBuilder hello;
+            hello.Finish(::iroha::CreateVerifyFrame(
+                hello, hello.CreateString(sender()), session()));
+            flatbuffers::BufferRef<VerifyAck> ack;
+            const bool accepted =
+                stream->Write(flatbuffers::BufferRef<VerifyFrame>(
+                    hello.GetBufferPointer(), hello.GetSize())) &&
+                stream->Read(&ack);
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              answered = true;
+            }
+            cv_.notify_all();
+            watchdog.join();
+
+            if (!accepted &&
+                stream->Finish().error_code() == grpc::StatusCode::UNIMPLEMENTED) {
+              logger::info("connection")
+                  << ip_ << " has no VerifyStream, falls back to Verify";
+              std::lock_guard<std::mutex> lock(mutex_);
+              context_ = nullptr;
+              unary_ = true;
+              return true;
+            }
+
+            if (accepted) {
+              {
+                std::lock_guard<std::mutex> lock(mutex_);
+                onAck(*ack.GetRoot());
+                // everything after the acked round goes again
+                sent_ = acked_;
+                broken_ = false;
+                connected_ = true;
+              }
+              std::thread reader([this, &stream] { readAcks(*stream); });
+              writeFrames(*stream);
+              context.TryCancel();
+              reader.join();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            context_ = nullptr;
+            connected_ = false;
+            return accepted;
+          }
+
+          /**
+           * Sends the waiting events one unary Verify at a time, for a peer
+           * without VerifyStream; it acks each event by answering.
+           * @return false once a call fails
+           */
+          bool serveUnary() {
+            auto stub = Sumeragi::NewStub(channelTo(ip_));
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+              cv_.wait(lock, [this] { return stop_ || !outbox_.empty(); });
+              if (stop_) return true;
+
+              const Frame frame = outbox_.front();
+              const auto round = acked_ + 1;
+              ClientContext context;
+              context.set_deadline(std::chrono::system_clock::now() +
+                                   payloadDeadline);
+              context_ = &context;
+              lock.unlock();
+
+              const auto event =
+                  flatbuffers::GetRoot<VerifyFrame>(frame->GetBufferPointer())
+                      ->event();
+              flatbuffers::BufferRef<Response> response;
+              const auto status = stub->Verify(
+                  &context,
+                  flatbuffers::BufferRef<ConsensusEvent>(
+                      const_cast<uint8_t *>(event->data()), event->size()),
+                  &response);
+              lock.lock();
+              context_ = nullptr;
+              if (!status.ok()) return false;
+              release(round);
+            }
+          }
+
+          void readAcks(ReaderWriter &stream) {
+            while (true) {
+              flatbuffers::BufferRef<VerifyAck> ack;
+              if (!stream.Read(&ack)) break;
+              std::lock_guard<std::mutex> lock(mutex_);
+              onAck(*ack.GetRoot());
+              cv_.notify_all();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            broken_ = true;
+            cv_.notify_all();
+          }
+
+          void writeFrames(ReaderWriter &stream) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+              cv_.wait(lock, [this] {
+                return stop_ || broken_ ||
+                       (sent_ - acked_ < outbox_.size() &&
+                        sent_ - acked_ < credit_);
+              });
+              if (stop_ || broken_) return;
+
+              const Frame frame = outbox_[sent_ - acked_];
+              sent_++;
+              // more frames are ready: let gRPC coalesce the writes
+              grpc::WriteOptions options;
+              if (sent_ - acked_ < std::min<uint64_t>(outbox_.size(), credit_)) {
+                options.set_buffer_hint();
+              }
+
+              lock.unlock();
+              const bool ok = stream.Write(
+                  flatbuffers::BufferRef<VerifyFrame>(frame->GetBufferPointer(),
+                                                      frame->GetSize()),
+                  options);
+              lock.lock();
+              if (!ok) return;
+            }
+          }
+
+          // drops the frames up to round, called with mutex_ held
+          void release(uint64_t round) {
+            const auto now = std::chrono::steady_clock::now();
+            while (acked_ < round && !outbox_.empty()) {
+              ackLatency_.observe(
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                      now - pushedAt_.front())
+                      .count());
+              outbox_.pop_front();
+              pushedAt_.pop_front();
+              acked_++;
+            }
+            outboxSize_.set(outbox_.size());
+            if (sent_ < acked_) sent_ = acked_;
+          }
+
+          // called with mutex_ held
+          void onAck(const VerifyAck &ack) {
+            release(ack.round());
+            credit_ = std::max(1u, ack.credit());
+          }
+
+          const std::string ip_;
+          metrics::Histogram &ackLatency_;
+          metrics::Gauge &outboxSize_;
+          metrics::Counter &dropped_;
+
+          std::mutex mutex_;
+          std::condition_variable cv_;
+          // outbox_[i] is the frame of round acked_ + i + 1
+          std::deque<Frame> outbox_;
+          std::deque<std::chrono::steady_clock::time_point> pushedAt_;
+          uint64_t next_round_ = 1;
+          uint64_t acked_ = 0;
+          uint64_t sent_ = 0;
+          uint32_t credit_ = 1;
+          bool broken_ = false;
+          bool connected_ = false;
+          bool stop_ = false;
+          // the peer has no VerifyStream, see serveUnary()
+          bool unary_ = false;
+          ClientContext *context_ = nullptr;
+
+          std::thread thread_;
+        };
+
+        std::mutex streams_mutex;
+        std::unordered_map<std::string, std::unique_ptr<Stream>> streams;
+
+        void closeStreams() {
+          std::lock_guard<std::mutex> lock(streams_mutex);
+          streams.clear();
+        }
+
+        /**
+         * The stream to ip, opened on first use.
+         * @return nullptr if ip is not a peer
+         */
+        Stream *streamTo(const std::string &ip) {
+          if (!::peer::service::isExistIP(ip)) {
             logger::info("connection") << "IP doesn't exist: " << ip;
-            return false;
+            return nullptr;
           }
+
+          std::lock_guard<std::mutex> lock(streams_mutex);
+          auto &stream = streams[ip];
+          if (!stream) {
+            logger::info("connection") << "open VerifyStream to " << ip;
+            stream.reset(new Stream(ip));
+          }
+          return stream.get();
         }
 
-        bool sendAll(const ::iroha::ConsensusEvent &event) {
-          auto receiver_ips =
-              config::PeerServiceConfig::getInstance().getGroup();
-          for (const auto &p : receiver_ips) {
-            if (p["ip"].get<std::string>() !=
-                config::PeerServiceConfig::getInstance().getMyIp()) {
+        bool send(const std::string &ip, const ::iroha::ConsensusEvent &event) {
+          auto stream = streamTo(ip);
+          if (stream == nullptr) return false;
+          stream->push(event, "");
+          return true;
+        }
+
+        std::vector<std::string> relayChildren(
+            const std::vector<std::string> &peers, const std::string &origin,
+            const std::string &peer, size_t fanout) {
+          const auto n = peers.size();
+          const auto root = std::find(peers.begin(), peers.end(), origin);
+          const auto self = std::find(peers.begin(), peers.end(), peer);
+          if (fanout == 0 || root == peers.end() || self == peers.end()) {
+            return {};
+          }
+
+          const size_t offset = root - peers.begin();
+          const size_t position = (self - peers.begin() + n - offset) % n;
+          std::vector<std::string> children;
+          for (size_t i = 1; i <= fanout; i++) {
+            const auto child = position * fanout + i;
+            if (child >= n) break;
+            children.push_back(peers[(child + offset) % n]);
+          }
+          return children;
+        }
+
+        namespace {
+          // replaced as a whole by setRelayOrder()
+          std::shared_ptr<const std::vector<std::string>> relayOrder;
+
+          std::shared_ptr<const std::vector<std::string>> relayPeers(
+              const std::shared_ptr<const config::PeerServiceValues> &values) {
+            auto order = std::atomic_load(&relayOrder);
+            if (order) return order;
+            return {values, &values->groupIps};
+          }
+
+          /**
+           * Sends the event to the children of peer. A child whose stream
+           * is not connected gets it directly, without forwarding, and its
+           * children are served from here instead.
+           */
+          void relayFrom(const std::vector<std::string> &peers,
+                         const ::iroha::ConsensusEvent &event,
+                         const std::string &origin, const std::string &peer,
+                         size_t fanout) {
+            auto pending = relayChildren(peers, origin, peer, fanout);
+            while (!pending.empty()) {
+              const auto child = pending.back();
+              pending.pop_back();
+
+              auto stream = streamTo(child);
+              if (stream != nullptr && stream->connected()) {
+                stream->push(event, origin, fanout);
+                continue;
+              }
+              if (stream != nullptr) stream->push(event, "");
               logger::info("connection")
-                  << "Send to " << p["ip"].get<std::string>();
-              send(p["ip"].get<std::string>(), event);
+                  << "relay to " << child << " falls back to direct send";
+              for (const auto &grandchild :
+                   relayChildren(peers, origin, child, fanout)) {
+                pending.push_back(grandchild);
+              }
+            }
+          }
+        }  // namespace
+
+        void setRelayOrder(std::vector<std::string> ips) {
+          std::atomic_store(&relayOrder,
+                            std::shared_ptr<const std::vector<std::string>>(
+                                std::make_shared<std::vector<std::string>>(
+                                    std::move(ips))));
+        }
+
+        void relay(const ::iroha::ConsensusEvent &event,
+                   const std::string &origin, size_t fanout) {
+          const auto values = config::PeerServiceConfig::getInstance().values();
+          relayFrom(*relayPeers(values), event, origin, values->myIp, fanout);
+        }
+
+        bool sendAll(const ::iroha::ConsensusEvent &event) {
+          // one snapshot per message, no lookups in the config tree
+          const auto values = config::PeerServiceConfig::getInstance().values();
+          const auto &myIp = values->myIp;
+          const auto order = relayPeers(values);
+          const auto &peers = *order;
+          const auto fanout =
+              config::IrohaConfigManager::getInstance().values()->verifyRelayFanout;
+
+          if (fanout > 0 &&
+              std::find(peers.begin(), peers.end(), myIp) != peers.end()) {
+            relayFrom(peers, event, myIp, myIp, fanout);
+            return true;
+          }
+
+          for (const auto &ip : peers) {
+            if (ip != myIp) {
+              logger::info("connection") << "Send to " << ip;
+              send(ip, event);
             }
           }
           return true;
@@ -408,9 +1099,12 @@ namespace connection {
     explicit HijiriConnectionClient(std::shared_ptr<Channel> channel)
         : stub_(Hijiri::NewStub(channel)) {}
 
-    void Kagami(const ::iroha::Ping &ping,
+    bool Kagami(const ::iroha::Ping &ping,
                 flatbuffers::BufferRef<Response> *responseRef) const {
       ::grpc::ClientContext clientContext;
+      // a ping slower than this counts as lost
+      clientContext.set_deadline(std::chrono::system_clock::now() +
+                                 std::chrono::seconds(1));
       flatbuffers::FlatBufferBuilder fbbPing;
 
       auto pingOffset = ::iroha::CreatePingDirect(
@@ -431,31 +1125,23 @@ namespace connection {
             << "gRPC CANCELLED" << static_cast<int>(res.error_code()) << ": "
             << res.error_message();
       }
+      return res.ok();
     }
 
    private:
     std::unique_ptr<Hijiri::Stub> stub_;
   };
 
-  class HijiriConnectionServiceImpl final : public ::iroha::Hijiri::Service {
+  class HijiriConnectionServiceImpl final {
    public:
-    Status Kagami(ServerContext *context,
-                  const flatbuffers::BufferRef<Ping> *request,
-                  flatbuffers::BufferRef<Response> *responseRef) override {
-      fbbResponse.Clear();
-      {
-        auto responseOffset = ::iroha::CreateResponseDirect(
-            fbbResponse, "OK!!", ::iroha::Code::UNDECIDED,
-            sign(fbbResponse,
-                 hash::sha3_256_hex(request->GetRoot()->message()->str() +
-                                    request->GetRoot()->message()->str())));
-        fbbResponse.Finish(responseOffset);
-
-        *responseRef = flatbuffers::BufferRef<Response>(
-            fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
-
-        return Status::OK;
-      }
+    Status Kagami(const Ping &request,
+                  flatbuffers::FlatBufferBuilder &fbbResponse) {
+      auto responseOffset = ::iroha::CreateResponseDirect(
+          fbbResponse, "OK!!", ::iroha::Code::UNDECIDED,
+          sign(fbbResponse, hash::sha3_256_hex(request.message()->str() +
+                                               request.message()->str())));
+      fbbResponse.Finish(responseOffset);
+      return Status::OK;
     }
 
     // ToDo: Unite the way to hash (below double(?) hash)
@@ -474,9 +1160,6 @@ namespace connection {
           config::PeerServiceConfig::getInstance().getMyPublicKey().c_str(),
           &sigblob, stamp);
     };
-
-   private:
-    flatbuffers::FlatBufferBuilder fbbResponse;
   };
 
   namespace memberShipService {
@@ -487,14 +1170,11 @@ namespace connection {
           logger::info("connection") << "IP is: " << ip;
           HijiriConnectionClient client(grpc::CreateChannel(
               ip + ":" +
-                  std::to_string(config::IrohaConfigManager::getInstance()
-                                     .getGrpcPortNumber(50051)),
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
               grpc::InsecureChannelCredentials()));
 
           flatbuffers::BufferRef<Response> response;
-          client.Kagami(ping, &response);
-          auto reply = response.GetRoot();
-          return true;
+          return client.Kagami(ping, &response);
         }
       }  // namespace Kagami
     }    // namespace HijiriImpl
@@ -504,10 +1184,10 @@ namespace connection {
           logger::info("connection") << "Send!";
           if (::peer::service::isExistIP(ip)) {
             logger::info("connection") << "IP Exist: " << ip;
+            metrics::ScopedTimer timing(sendLatency(ip, "Torii"));
             SumeragiConnectionClient client(grpc::CreateChannel(
                 ip + ":" +
-                    std::to_string(config::IrohaConfigManager::getInstance()
-                                       .getGrpcPortNumber(50051)),
+                    std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
                 grpc::InsecureChannelCredentials()));
 
             flatbuffers::BufferRef<Response> response;
@@ -515,8 +1195,111 @@ namespace connection {
             auto reply = response.GetRoot();
             return true;
           }
+          return false;
         }
       }  // namespace Torii
+
+      namespace Publish {
+        bool send(const std::string &ip,
+                  const std::vector<std::vector<uint8_t>> &bodies) {
+          metrics::ScopedTimer timing(sendLatency(ip, "Publish"));
+          auto stub = Sumeragi::NewStub(channelTo(ip));
+
+          flatbuffers::FlatBufferBuilder fbb;
+          std::vector<flatbuffers::Offset<TransactionWrapper>> wrappers;
+          for (const auto &body : bodies) {
+            wrappers.push_back(
+                ::iroha::CreateTransactionWrapperDirect(fbb, &body));
+          }
+          fbb.Finish(::iroha::CreateTransactionBatchDirect(fbb, &wrappers));
+
+          ClientContext context;
+          context.set_deadline(std::chrono::system_clock::now() +
+                               payloadDeadline);
+          flatbuffers::BufferRef<PayloadAck> response;
+          auto status = stub->Publish(
+              &context,
+              flatbuffers::BufferRef<TransactionBatch>(fbb.GetBufferPointer(),
+                                                       fbb.GetSize()),
+              &response);
+          if (!status.ok()) {
+            logger::warning("connection")
+                << "Publish to " << ip << " failed: " << status.error_message();
+            return false;
+          }
+          return response.GetRoot()->stored() == bodies.size();
+        }
+      }  // namespace Publish
+
+      namespace FetchPayload {
+        bool send(const std::string &ip,
+                  const std::vector<hash::Hash32> &digests,
+                  std::vector<std::vector<uint8_t>> &bodies) {
+          metrics::ScopedTimer timing(sendLatency(ip, "FetchPayload"));
+          auto stub = Sumeragi::NewStub(channelTo(ip));
+
+          flatbuffers::FlatBufferBuilder fbb;
+          std::vector<uint8_t> blob;
+          for (const auto &digest : digests) {
+            blob.insert(blob.end(), digest.begin(), digest.end());
+          }
+          fbb.Finish(::iroha::CreatePayloadRequestDirect(fbb, &blob));
+
+          ClientContext context;
+          context.set_deadline(std::chrono::system_clock::now() +
+                               payloadDeadline);
+          flatbuffers::BufferRef<TransactionBatch> response;
+          auto status = stub->FetchPayload(
+              &context,
+              flatbuffers::BufferRef<PayloadRequest>(fbb.GetBufferPointer(),
+                                                     fbb.GetSize()),
+              &response);
+          if (!status.ok()) {
+            logger::warning("connection") << "FetchPayload from " << ip
+                                          << " failed: "
+                                          << status.error_message();
+            return false;
+          }
+
+          bodies.clear();
+          auto wrappers = response.GetRoot()->transactions();
+          if (wrappers == nullptr) return digests.empty();
+          for (const auto wrapper : *wrappers) {
+            if (wrapper->tx() == nullptr) {
+              bodies.emplace_back();
+            } else {
+              bodies.emplace_back(wrapper->tx()->begin(), wrapper->tx()->end());
+            }
+          }
+          return bodies.size() == digests.size();
+        }
+      }  // namespace FetchPayload
+
+      namespace ToriiBatch {
+        bool send(const std::string &ip,
+                  const std::vector<const ::iroha::Transaction *> &txs,
+                  std::vector<::iroha::Code> &codes) {
+          metrics::ScopedTimer timing(sendLatency(ip, "ToriiBatch"));
+          SumeragiConnectionClient client(grpc::CreateChannel(
+              ip + ":" +
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
+              grpc::InsecureChannelCredentials()));
+
+          flatbuffers::BufferRef<BatchResponse> response;
+          auto sent = client.ToriiBatch(txs, &response);
+          if (!sent) {
+            logger::warning("connection") << sent.error();
+            return false;
+          }
+          codes.clear();
+          auto reply = response.GetRoot()->codes();
+          if (reply == nullptr) return txs.empty();
+          for (auto code : *reply) {
+            codes.push_back(static_cast<::iroha::Code>(code));
+          }
+          return codes.size() == txs.size();
+        }
+      }  // namespace ToriiBatch
     }    // namespace SumeragiImpl
   }      // namespace memberShipService
 
@@ -526,10 +1309,7 @@ namespace connection {
   namespace iroha {
     namespace AssetRepositoryImpl {
       namespace AccountGetAsset {
-        // ToDo more clear
-        ReceiverWithReturen<AccountGetAsset::CallBackFunc,
-                            std::vector<const ::iroha::Asset *>>
-            receiver;
+        Receiver<AccountGetAsset::CallBackFunc> receiver;
 
         void receive(AccountGetAsset::CallBackFunc &&callback) {
           receiver.set(std::move(callback));
@@ -540,55 +1320,23 @@ namespace connection {
   /**
    * AssetRepositoryConnectionServiceImpl
    */
-  class AssetRepositoryConnectionServiceImpl final
-      : public ::iroha::AssetRepository::Service {
+  class AssetRepositoryConnectionServiceImpl final {
    public:
-    Status AccountGetAsset(
-        ServerContext *context,
-        const flatbuffers::BufferRef<::iroha::AssetQuery> *requestRef,
-        flatbuffers::BufferRef<::iroha::AssetResponse> *responseRef) override {
-      fbbResponse.Clear();
-      std::vector<const ::iroha::Asset *> assets;
-      {
-        const auto q = requestRef->GetRoot();
-        flatbuffers::FlatBufferBuilder fbb;
-        auto req_offset = ::iroha::CreateAssetQueryDirect(
-            fbb, q->pubKey()->c_str(), q->ledger_name()->c_str(),
-            q->domain_name()->c_str(), q->asset_name()->c_str(),
-            q->uncommitted());
-
-        fbb.Finish(req_offset);
-        assets =
-            connection::iroha::AssetRepositoryImpl::AccountGetAsset::receiver
-                .invoke("from",  // TODO: Specify 'from'
-                        fbb.ReleaseBufferPointer());
-
-        std::vector<uint8_t> types;
-        std::vector<flatbuffers::Offset<::iroha::Asset>> res_assets;
-        {
-          for (const ::iroha::Asset *asset : assets) {
-            if (asset->asset_type() == ::iroha::AnyAsset::Currency) {
-              res_assets.push_back(::iroha::CreateAsset(
-                  fbbResponse, asset->asset_type(),
-                  ::iroha::CreateCurrencyDirect(
-                      fbbResponse,
-                      asset->asset_as_Currency()->currency_name()->c_str(),
-                      asset->asset_as_Currency()->domain_name()->c_str(),
-                      asset->asset_as_Currency()->ledger_name()->c_str(),
-                      asset->asset_as_Currency()->description()->c_str(),
-                      asset->asset_as_Currency()->amount()->c_str(),
-                      asset->asset_as_Currency()->precision())
-                      .Union()));
-            }
-          }
-        }
-        auto responseOffset = ::iroha::CreateAssetResponseDirect(
-            fbbResponse, "Success", ::iroha::Code::COMMIT, &res_assets);
-        fbbResponse.Finish(responseOffset);
-
-        *responseRef = flatbuffers::BufferRef<AssetResponse>(
-            fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
-      }
+    Status AccountGetAsset(const AssetQuery &query,
+                           flatbuffers::FlatBufferBuilder &fbbResponse) {
+      // assets are copied from the LMDB pages straight into the response,
+      // the repository keeps its read snapshot open until invoke() returns
+      std::vector<flatbuffers::Offset<::iroha::AssetWrapper>> wrappers;
+      connection::iroha::AssetRepositoryImpl::AccountGetAsset::receiver.invoke(
+          "from",  // TODO: Specify 'from'
+          query, [&](const uint8_t *data, size_t size) {
+            wrappers.push_back(::iroha::CreateAssetWrapper(
+                fbbResponse, fbbResponse.CreateVector(data, size)));
+          });
+
+      auto responseOffset = ::iroha::CreateAssetResponseDirect(
+          fbbResponse, "Success", ::iroha::Code::COMMIT, &wrappers);
+      fbbResponse.Finish(responseOffset);
       return Status::OK;
     }
 
@@ -608,8 +1356,6 @@ namespace connection {
           config::PeerServiceConfig::getInstance().getMyPublicKey().c_str(),
           &sigblob, stamp);
     };
-
-    flatbuffers::FlatBufferBuilder fbbResponse;
   };
 
   /************************************************************************************
@@ -636,7 +1382,7 @@ namespace connection {
     explicit SyncConnectionClient(std::shared_ptr<Channel> channel)
         : stub_(Sync::NewStub(channel)) {}
 
-    bool checkHash(const ::iroha::Ping &ping) const {
+    bool checkHash(const ::iroha::Ping &ping, uint64_t *height = nullptr) const {
       ::grpc::ClientContext clientContext;
       flatbuffers::FlatBufferBuilder fbbPing;
 
@@ -655,6 +1401,7 @@ namespace connection {
       if (res.ok()) {
         logger::info("connection")
             << "response: " << responseRef.GetRoot()->isCorrect();
+        if (height != nullptr) *height = responseRef.GetRoot()->height();
         return responseRef.GetRoot()->isCorrect();
       } else {
         logger::error("connection") << static_cast<int>(res.error_code())
@@ -725,68 +1472,127 @@ namespace connection {
       }
     }
 
-    std::vector<uint8_t> fetchStreamTransaction(
-        const ::iroha::TxRequest &txRequest) const {
+    bool fetchStreamTransaction(
+        uint64_t from, uint64_t to,
+        const memberShipService::SyncImpl::fetchStreamTransaction::CallBackFunc
+            &callback) const {
       ::grpc::ClientContext clientContext;
 
       flatbuffers::FlatBufferBuilder fbbTxRequest;
-
       auto txRequestOffset = ::iroha::CreateTxRequestDirect(
-          fbbTxRequest, txRequest.index(), txRequest.sender()->c_str());
-
+          fbbTxRequest, from, ::peer::myself::getIp().c_str(), to);
       fbbTxRequest.Finish(txRequestOffset);
 
       flatbuffers::BufferRef<::iroha::TxRequest> reqTxRequestRef(
           fbbTxRequest.GetBufferPointer(), fbbTxRequest.GetSize());
 
-      flatbuffers::BufferRef<::iroha::TxWithIndex> responseRef;
-
       auto stream =
           stub_->fetchStreamTransaction(&clientContext, reqTxRequestRef);
-      while (stream->Read(&responseRef)) {
-        ::peer::sync::detail::append_temporary(responseRef.GetRoot()->index(),
-                                               responseRef.GetRoot()->tx());
+      while (true) {
+        flatbuffers::BufferRef<TxBatch> responseRef;
+        if (!stream->Read(&responseRef)) break;
+        if (!callback(*responseRef.GetRoot())) {
+          clientContext.TryCancel();
+          break;
+        }
+      }
+
+      auto res = stream->Finish();
+      if (!res.ok() && res.error_code() != grpc::StatusCode::CANCELLED) {
+        logger::error("connection") << static_cast<int>(res.error_code())
+                                    << ": " << res.error_message();
+        return false;
+      }
+      return true;
+    }
+
+    bool getRangeRoot(uint64_t from, uint64_t to, hash::Hash32 &root) const {
+      ::grpc::ClientContext clientContext;
+
+      flatbuffers::FlatBufferBuilder fbbTxRequest;
+      fbbTxRequest.Finish(::iroha::CreateTxRequestDirect(
+          fbbTxRequest, from, ::peer::myself::getIp().c_str(), to));
+
+      flatbuffers::BufferRef<::iroha::TxRequest> reqTxRequestRef(
+          fbbTxRequest.GetBufferPointer(), fbbTxRequest.GetSize());
+      flatbuffers::BufferRef<::iroha::RangeRoot> responseRef;
+
+      auto res =
+          stub_->getRangeRoot(&clientContext, reqTxRequestRef, &responseRef);
+      if (!res.ok()) {
+        logger::error("connection") << static_cast<int>(res.error_code())
+                                    << ": " << res.error_message();
+        return false;
       }
+
+      auto bytes = responseRef.GetRoot()->root();
+      if (bytes == nullptr || bytes->size() != root.bytes.size()) return false;
+      std::copy(bytes->begin(), bytes->end(), root.bytes.begin());
+      return true;
+    }
+
+    bool getMerkleNodes(uint64_t to, uint32_t level, uint64_t first,
+                        uint32_t count,
+                        std::vector<hash::Hash32> &nodes) const {
+      ::grpc::ClientContext clientContext;
+
+      flatbuffers::FlatBufferBuilder fbbRequest;
+      fbbRequest.Finish(::iroha::CreateMerkleNodesRequest(fbbRequest, to,
+                                                          level, first, count));
+
+      flatbuffers::BufferRef<::iroha::MerkleNodesRequest> requestRef(
+          fbbRequest.GetBufferPointer(), fbbRequest.GetSize());
+      flatbuffers::BufferRef<::iroha::MerkleNodes> responseRef;
+
+      auto res = stub_->getMerkleNodes(&clientContext, requestRef, &responseRef);
+      if (!res.ok()) {
+        logger::error("connection") << static_cast<int>(res.error_code())
+                                    << ": " << res.error_message();
+        return false;
+      }
+
+      auto bytes = responseRef.GetRoot()->nodes();
+      nodes.clear();
+      if (bytes == nullptr) return true;
+      hash::Hash32 node;
+      for (size_t i = 0; i + node.bytes.size() <= bytes->size();
+           i += node.bytes.size()) {
+        std::copy(bytes->begin() + i, bytes->begin() + i + node.bytes.size(),
+                  node.bytes.begin());
+        nodes.push_back(node);
+      }
+      return true;
     }
 
    private:
     std::unique_ptr<Sync::Stub> stub_;
   };
 
-  class SyncConnectionServiceImpl final : public ::iroha::Sync::Service {
+  class SyncConnectionServiceImpl final {
    public:
-    Status checkHash(ServerContext *context,
-                     const flatbuffers::BufferRef<Ping> *request,
-                     flatbuffers::BufferRef<::iroha::CheckHashResponse>
-                         *responseRef) override {
-      fbbResponse.Clear();
-      {
-        logger::debug("SyncConnectionServiceImpl::checkHash") << "RPC works";
-        std::string hash = request->GetRoot()->message()->str();
-        // Now, only supported root hash copare. (ver1.0)
-        if (repository::getMerkleRoot() == hash) {
-          auto responseOffset =
-              ::iroha::CreateCheckHashResponse(fbbResponse, true, true, true);
-          fbbResponse.Finish(responseOffset);
-        } else {
-          auto responseOffset = ::iroha::CreateCheckHashResponse(
-              fbbResponse, false, false, false);
-          fbbResponse.Finish(responseOffset);
-        }
-        *responseRef = flatbuffers::BufferRef<::iroha::CheckHashResponse>(
-            fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
-        return Status::OK;
+    Status checkHash(const Ping &request,
+                     flatbuffers::FlatBufferBuilder &fbbResponse) {
+      logger::debug("SyncConnectionServiceImpl::checkHash") << "RPC works";
+      std::string hash = request.message()->str();
+      // Now, only supported root hash copare. (ver1.0)
+      const uint64_t height = repository::getTransactionCount();
+      if (hash::to_hex(repository::getMerkleRoot()) == hash) {
+        auto responseOffset = ::iroha::CreateCheckHashResponse(
+            fbbResponse, true, true, true, height);
+        fbbResponse.Finish(responseOffset);
+      } else {
+        auto responseOffset = ::iroha::CreateCheckHashResponse(
+            fbbResponse, false, false, false, height);
+        fbbResponse.Finish(responseOffset);
       }
+      return Status::OK;
     }
 
-    Status getTransactions(ServerContext *context,
-                           const flatbuffers::BufferRef<Ping> *requestRef,
-                           flatbuffers::BufferRef<::iroha::TransactionResponse>
-                               *responseRef) override {
-      fbbResponse.Clear();
+    Status getTransactions(const Ping &request,
+                           flatbuffers::FlatBufferBuilder &fbbResponse) {
       std::vector<const ::iroha::Transaction *> transactions;
       {
-        const auto q = requestRef->GetRoot();
+        const auto q = &request;
         flatbuffers::FlatBufferBuilder fbb;
         auto ping_offset = ::iroha::CreatePingDirect(fbb, q->message()->c_str(),
                                                      q->sender()->c_str());
@@ -812,63 +1618,96 @@ namespace connection {
         auto responseOffset = ::iroha::CreateTransactionResponseDirect(
             fbbResponse, "Success", index, ::iroha::Code::COMMIT, &res_txs);
         fbbResponse.Finish(responseOffset);
+      }
+      return Status::OK;
+    }
 
-        *responseRef = flatbuffers::BufferRef<TransactionResponse>(
-            fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
+    Status getPeers(const Ping &request,
+                    flatbuffers::FlatBufferBuilder &fbbResponse) {
+      logger::debug("SyncConnectionServiceImpl::getPeers") << "RPC works";
+      std::string leader_ip = request.message()->str();
+      std::vector<flatbuffers::Offset<::iroha::Peer>> p_vec;
+      for (auto &&p : ::peer::service::getAllPeerList()) {
+        p_vec.emplace_back(::iroha::CreatePeer(
+            fbbResponse, fbbResponse.CreateString(p->ledger_name),
+            fbbResponse.CreateString(p->publicKey),
+            fbbResponse.CreateString(p->ip), p->trust, p->active,
+            p->join_ledger));
       }
+      auto res = ::iroha::CreatePeersResponse(
+          fbbResponse, fbbResponse.CreateString("message"),
+          fbbResponse.CreateVector(p_vec),
+          fbbResponse.CreateString(::peer::myself::getPublicKey()));
+      fbbResponse.Finish(res);
+      return Status::OK;
     }
 
-    Status getPeers(
-        ServerContext *context, const flatbuffers::BufferRef<Ping> *request,
-        flatbuffers::BufferRef<::iroha::PeersResponse> *responseRef) override {
-      fbbResponse.Clear();
-      {
-        logger::debug("SyncConnectionServiceImpl::getPeers") << "RPC works";
-        std::string leader_ip = request->GetRoot()->message()->str();
-        std::vector<flatbuffers::Offset<::iroha::Peer>> p_vec;
-        for (auto &&p : ::peer::service::getAllPeerList()) {
-          p_vec.emplace_back(::iroha::CreatePeer(
-              fbbResponse, fbbResponse.CreateString(p->ledger_name),
-              fbbResponse.CreateString(p->publicKey),
-              fbbResponse.CreateString(p->ip), p->trust, p->active,
-              p->join_ledger));
-        }
-        auto res = ::iroha::CreatePeersResponse(
-            fbbResponse, fbbResponse.CreateString("message"),
-            fbbResponse.CreateVector(p_vec),
-            fbbResponse.CreateString(::peer::myself::getPublicKey()));
-        fbbResponse.Finish(res);
-        *responseRef = flatbuffers::BufferRef<::iroha::PeersResponse>(
-            fbbResponse.GetBufferPointer(), fbbResponse.GetSize());
-        return Status::OK;
-      }
-    }
-
-    virtual ::grpc::Status fetchStreamTransaction(
-        ::grpc::ServerContext *context,
-        const flatbuffers::BufferRef<TxRequest> *request,
-        ::grpc::ServerWriter<flatbuffers::BufferRef<TxWithIndex>> *writer)
-        override {
-      auto req = request->GetRoot();
-      // req->sender()->str()->c_str();
-
-      for (size_t i = req->index(); /* ToDo: Set size to stop loop */; i++) {
-        flatbuffers::FlatBufferBuilder fbb;
-        auto tx = ::iroha::CreateTransactionDirect(
-            fbb);  // ToDo: Get transaction from repository
-        auto txWithIndexOffset = ::iroha::CreateTxWithIndex(fbb, tx, i);
-        fbb.Finish(txWithIndexOffset);
+    Status getRangeRoot(const TxRequest &request,
+                        flatbuffers::FlatBufferBuilder &fbbResponse) {
+      auto root = repository::getRangeRoot(request.index(), request.to());
+      auto responseOffset = ::iroha::CreateRangeRootDirect(
+          fbbResponse, request.index(), request.to(),
+          std::vector<uint8_t>(root.bytes.begin(), root.bytes.end()));
+      fbbResponse.Finish(responseOffset);
+      return Status::OK;
+    }
+
+    Status getMerkleNodes(const ::iroha::MerkleNodesRequest &request,
+                          flatbuffers::FlatBufferBuilder &fbbResponse) {
+      // a level above 63 covers no transaction, more nodes is one more call
+      constexpr uint32_t max_level = 63;
+      constexpr uint32_t max_count = 256;
+      if (request.level() > max_level) {
+        return Status(grpc::StatusCode::INVALID_ARGUMENT, "level too high");
+      }
 
-        flatbuffers::BufferRef<::iroha::TxWithIndex> txRef(
-            fbb.GetBufferPointer(), fbb.GetSize());
-        // Send monster to client using streaming.
-        writer->Write(txRef);
+      std::vector<uint8_t> bytes;
+      for (auto &node : repository::getMerkleNodes(
+               request.to(), request.level(), request.first(),
+               std::min(request.count(), max_count))) {
+        bytes.insert(bytes.end(), node.bytes.begin(), node.bytes.end());
       }
-      return grpc::Status::OK;
+      fbbResponse.Finish(::iroha::CreateMerkleNodesDirect(
+          fbbResponse, request.level(), request.first(), &bytes));
+      return Status::OK;
     }
 
-   private:
-    flatbuffers::FlatBufferBuilder fbbResponse;
+    /**
+     * Builds the next batch of the range [request.index, request.to) into
+     * fbb, straight from the committed tx_store.
+     * @param cursor - next index to send, 0 before the first batch
+     * @return false when the range is over
+     */
+    bool fetchStreamTransaction(const TxRequest &request, uint64_t &cursor,
+                                flatbuffers::FlatBufferBuilder &fbb) {
+      // a batch is one gRPC message, keep it well below the 4MB limit
+      constexpr size_t max_batch_txs = 1024;
+      constexpr size_t max_batch_bytes = 1024 * 1024;
+
+      if (cursor == 0) cursor = std::max<uint64_t>(request.index(), 1);
+      const uint64_t to = request.to() != 0
+                              ? request.to()
+                              : repository::getTransactionCount() + 1;
+      if (cursor >= to) return false;
+
+      const uint64_t first = cursor;
+      size_t bytes = 0;
+      std::vector<flatbuffers::Offset<::iroha::TransactionWrapper>> txs;
+      repository::forEachTransaction(
+          first, to, [&](size_t index, const uint8_t *data, size_t size) {
+            if (index != cursor) return false;  // keep batches contiguous
+            txs.push_back(::iroha::CreateTransactionWrapper(
+                fbb, fbb.CreateVector(data, size)));
+            cursor++;
+            bytes += size;
+            return txs.size() < max_batch_txs && bytes < max_batch_bytes;
+          });
+      if (txs.empty()) return false;
+
+      fbb.Finish(
+          ::iroha::CreateTxBatch(fbb, first, fbb.CreateVector(txs)));
+      return true;
+    }
   };
 
   namespace memberShipService {
@@ -879,12 +1718,21 @@ namespace connection {
           logger::info("connection") << "IP: " << ip;
           SyncConnectionClient client(grpc::CreateChannel(
               ip + ":" +
-                  std::to_string(config::IrohaConfigManager::getInstance()
-                                     .getGrpcPortNumber(50051)),
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
               grpc::InsecureChannelCredentials()));
 
           return client.checkHash(ping);
         }
+
+        bool send(const std::string &ip, const ::iroha::Ping &ping,
+                  uint64_t &height) {
+          SyncConnectionClient client(grpc::CreateChannel(
+              ip + ":" +
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
+              grpc::InsecureChannelCredentials()));
+
+          return client.checkHash(ping, &height);
+        }
       }  // namespace checkHash
 
       namespace getTransactions {
@@ -893,16 +1741,11 @@ namespace connection {
           logger::info("connection") << "IP: " << ip;
           SyncConnectionClient client(grpc::CreateChannel(
               ip + ":" +
-                  std::to_string(config::IrohaConfigManager::getInstance()
-                                     .getGrpcPortNumber(50051)),
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
               grpc::InsecureChannelCredentials()));
 
           auto reply = client.getTransactions(ping);
-          auto txRes =
-              flatbuffers::GetRoot<::iroha::TransactionResponse>(reply.data());
-          auto tx = txRes->transactions()->GetAs<::iroha::Transaction>(0);
-          ::peer::sync::detail::append_temporary(txRes->index(), tx);
-          return true;
+          return !reply.empty();
         }
       }  // namespace getTransactions
 
@@ -912,8 +1755,7 @@ namespace connection {
           logger::info("connection") << "IP: " << ip;
           SyncConnectionClient client(grpc::CreateChannel(
               ip + ":" +
-                  std::to_string(config::IrohaConfigManager::getInstance()
-                                     .getGrpcPortNumber(50051)),
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
               grpc::InsecureChannelCredentials()));
 
           auto replyvec = client.getPeers(ping);
@@ -937,27 +1779,687 @@ namespace connection {
         }
       }  // namespace getPeers
 
-      namespace fetch {
-        std::vector<uint8_t> fetchStreamTransaction(const std::string &ip,
-                                                    const TxRequest &request) {
-          logger::info("connection") << "Fetch stream transaction";
+      namespace fetchStreamTransaction {
+        bool send(const std::string &ip, uint64_t from, uint64_t to,
+                  CallBackFunc &&callback) {
+          logger::info("connection") << "Fetch stream transaction [" << from
+                                     << ", " << to << ") from " << ip;
           SyncConnectionClient client(grpc::CreateChannel(
               ip + ":" +
-                  std::to_string(config::IrohaConfigManager::getInstance()
-                                     .getGrpcPortNumber(50051)),
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
               grpc::InsecureChannelCredentials()));
 
-          return client.fetchStreamTransaction(request);
+          return client.fetchStreamTransaction(from, to, callback);
         }
-      }  // namespace fetch
+      }  // namespace fetchStreamTransaction
+
+      namespace getRangeRoot {
+        bool send(const std::string &ip, uint64_t from, uint64_t to,
+                  hash::Hash32 &root) {
+          SyncConnectionClient client(grpc::CreateChannel(
+              ip + ":" +
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
+              grpc::InsecureChannelCredentials()));
+
+          return client.getRangeRoot(from, to, root);
+        }
+      }  // namespace getRangeRoot
+
+      namespace getMerkleNodes {
+        bool send(const std::string &ip, uint64_t to, uint32_t level,
+                  uint64_t first, uint32_t count,
+                  std::vector<hash::Hash32> &nodes) {
+          SyncConnectionClient client(grpc::CreateChannel(
+              ip + ":" +
+                  std::to_string(config::IrohaConfigManager::getInstance().values()->grpcPort),
+              grpc::InsecureChannelCredentials()));
+
+          return client.getMerkleNodes(to, level, first, count, nodes);
+        }
+      }  // namespace getMerkleNodes
     }    // namespace SyncImpl
   }      // namespace memberShipService
 
+  /************************************************************************************
+   * Async server
+   ************************************************************************************/
+  namespace server {
+
+    /**
+     * An RPC waiting on a completion queue. gRPC gets the call itself as
+     * the tag, the polling thread invokes proceed() with the event status.
+     */
+    class Call {
+     public:
+      virtual ~Call() = default;
+      virtual void proceed(bool ok) = 0;
+    };
+
+    /**
+     * Bounds the number of running calls of one service, so a burst of
+     * queries cannot take every handler thread away from consensus.
+     */
+    class Limiter {
+     public:
+      explicit Limiter(size_t limit) : limit_(limit) {}
+
+      bool tryAcquire() {
+        if (inflight_.fetch_add(1) >= limit_) {
+          inflight_.fetch_sub(1);
+          return false;
+        }
+        return true;
+      }
+
+      void release() { inflight_.fetch_sub(1); }
+
+     private:
+      const size_t limit_;
+      std::atomic<size_t> inflight_{0};
+    };
+
+    std::unique_ptr<ThreadPool> handlers;
+
+    // tasks given to the handler pool and not yet run to the end
+    std::atomic<size_t> pending{0};
+    std::atomic<bool> stopping{false};
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+
+    void taskDone() {
+      if (pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        pending_cv.notify_all();
+      }
+    }
+
+    /**
+     * Runs the handler of a call on the handler pool.
+     * @return false if the pool queue is full or the server is stopping
+     */
+    template <class Task>
+    bool dispatch(Task &&task) {
+      // counted before the check, so drain() either sees it or refuses it
+      pending.fetch_add(1);
+      if (stopping) {
+        taskDone();
+        return false;
+      }
+      try {
+        handlers->process([task = std::forward<Task>(task)]() mutable {
+          task();
+          taskDone();
+        });
+        return true;
+      } catch (const std::runtime_error &e) {
+        logger::warning("connection") << e.what();
+        taskDone();
+        return false;
+      }
+    }
+
+    /**
+     * Refuses new tasks and waits for the queued and running ones, which
+     * may still post their responses to the completion queues.
+     */
+    void drain() {
+      stopping = true;
+      std::unique_lock<std::mutex> lock(pending_mutex);
+      pending_cv.wait(lock, [] { return pending == 0; });
+    }
+
+    const Status busy(grpc::StatusCode::RESOURCE_EXHAUSTED, "server is busy");
+
+    /**
+     * Response builders recycled between calls. Clear() keeps the buffer of
+     * a builder, so once warm a call neither allocates nor frees to build
+     * its response. A builder whose buffer grew past max_retained is dropped
+     * rather than kept around for every later small response.
+     */
+    class BuilderPool {
+      // remembers the size of the last buffer it gave, the one its builder
+      // holds: a builder reallocates to grow and keeps it across Clear()
+      class SizedAllocator : public flatbuffers::simple_allocator {
+       public:
+        uint8_t *allocate(size_t size) const override {
+          capacity_ = size;
+          return simple_allocator::allocate(size);
+        }
+        size_t capacity() const { return capacity_; }
+
+       private:
+        mutable size_t capacity_ = 0;
+      };
+
+      // constructed before the builder that allocates through it
+      struct Allocated {
+        SizedAllocator allocator;
+      };
+
+     public:
+      class PooledBuilder : private Allocated,
+                            public flatbuffers::FlatBufferBuilder {
+       public:
+        PooledBuilder() : flatbuffers::FlatBufferBuilder(1024, &allocator) {}
+        size_t capacity() const { return allocator.capacity(); }
+      };
+
+     private:
+      struct Release {
+        BuilderPool *pool = nullptr;
+        void operator()(PooledBuilder *fbb) const { pool->release(fbb); }
+      };
+
+     public:
+      using Builder = std::unique_ptr<PooledBuilder, Release>;
+
+      BuilderPool(size_t max_free, size_t max_retained)
+          : max_free_(max_free), max_retained_(max_retained) {}
+
+      Builder acquire() {
+        std::unique_ptr<PooledBuilder> fbb;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!free_.empty()) {
+            fbb = std::move(free_.back());
+            free_.pop_back();
+          }
+        }
+        if (!fbb) fbb.reset(new PooledBuilder());
+        return Builder(fbb.release(), Release{this});
+      }
+
+     private:
+      void release(PooledBuilder *raw) {
+        std::unique_ptr<PooledBuilder> fbb(raw);
+        if (fbb->capacity() > max_retained_) return;
+        fbb->Clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < max_free_) free_.push_back(std::move(fbb));
+      }
+
+      const size_t max_free_;
+      const size_t max_retained_;
+      std::mutex mutex_;
+      std::vector<std::unique_ptr<PooledBuilder>> free_;
+    };
+
+    // a TxBatch is up to 1MB, anything larger is rare enough to allocate
+    BuilderPool builders(64, 2 * 1024 * 1024);
+
+    /**
+     * Unary RPC: REQUEST -> (handler on the pool) -> FINISH
+     * Handlers get the context of the call to tell who sent it.
+     */
+    template <class Request, class Response>
+    class UnaryCall final : public Call {
+     public:
+      using Responder =
+          grpc::ServerAsyncResponseWriter<flatbuffers::BufferRef<Response>>;
+      using Requester = std::function<void(
+          ServerContext *, flatbuffers::BufferRef<Request> *, Responder *,
+          grpc::ServerCompletionQueue *, void *)>;
+      using Handler =
+          std::function<Status(const ServerContext &, const Request &,
+                               flatbuffers::FlatBufferBuilder &)>;
+
+      static void listen(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                         Requester requester, Handler handler) {
+        new UnaryCall(cq, limiter, std::move(requester), std::move(handler));
+      }
+
+      void proceed(bool ok) override {
+        if (finished_ || !ok) {
+          delete this;
+          return;
+        }
+
+        // accept the next call of this method while serving this one
+        listen(cq_, limiter_, requester_, handler_);
+
+        if (!limiter_->tryAcquire()) {
+          finish(busy);
+          return;
+        }
+        if (!dispatch([this] {
+              response_ = builders.acquire();
+              auto status =
+                  handler_(context_, *request_.GetRoot(), *response_);
+              limiter_->release();
+              finish(status);
+            })) {
+          limiter_->release();
+          finish(busy);
+        }
+      }
+
+     private:
+      UnaryCall(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                Requester requester, Handler handler)
+          : cq_(cq),
+            limiter_(limiter),
+            requester_(std::move(requester)),
+            handler_(std::move(handler)),
+            responder_(&context_) {
+        requester_(&context_, &request_, &responder_, cq_, this);
+      }
+
+      void finish(const Status &status) {
+        finished_ = true;
+        if (status.ok()) {
+          responder_.Finish(
+              flatbuffers::BufferRef<Response>(response_->GetBufferPointer(),
+                                               response_->GetSize()),
+              status, this);
+        } else {
+          responder_.FinishWithError(status, this);
+        }
+      }
+
+      grpc::ServerCompletionQueue *cq_;
+      Limiter *limiter_;
+      Requester requester_;
+      Handler handler_;
+
+      ServerContext context_;
+      flatbuffers::BufferRef<Request> request_;
+      BuilderPool::Builder response_;
+      Responder responder_;
+      bool finished_ = false;
+    };
+
+    /**
+     * Server streaming RPC: REQUEST -> (WRITE)* -> FINISH
+     * The next message is built only after the previous write completed,
+     * so a slow reader holds at most one message in memory. Handlers keep
+     * their position in the stream in cursor, which starts at 0.
+     */
+    template <class Request, class Response>
+    class ServerStreamCall final : public Call {
+     public:
+      using Writer = grpc::ServerAsyncWriter<flatbuffers::BufferRef<Response>>;
+      using Requester = std::function<void(
+          ServerContext *, flatbuffers::BufferRef<Request> *, Writer *,
+          grpc::ServerCompletionQueue *, void *)>;
+      using Handler = std::function<bool(const Request &, uint64_t &,
+                                         flatbuffers::FlatBufferBuilder &)>;
+
+      static void listen(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                         Requester requester, Handler handler) {
+        new ServerStreamCall(cq, limiter, std::move(requester),
+                             std::move(handler));
+      }
+
+      void proceed(bool ok) override {
+        switch (state_) {
+          case State::REQUEST:
+            if (!ok) break;
+            listen(cq_, limiter_, requester_, handler_);
+            if (!limiter_->tryAcquire()) {
+              finish(busy);
+              return;
+            }
+            state_ = State::WRITE;
+            next();
+            return;
+          case State::WRITE:
+            if (ok) {
+              next();
+              return;
+            }
+            // the client went away
+            limiter_->release();
+            break;
+          case State::FINISH:
+            break;
+        }
+        delete this;
+      }
+
+     private:
+      enum class State { REQUEST, WRITE, FINISH };
+
+      ServerStreamCall(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                       Requester requester, Handler handler)
+          : cq_(cq),
+            limiter_(limiter),
+            requester_(std::move(requester)),
+            handler_(std::move(handler)),
+            writer_(&context_) {
+        requester_(&context_, &request_, &writer_, cq_, this);
+      }
+
+      void next() {
+        if (!dispatch([this] {
+              // one builder for the whole stream, cleared per message
+              if (!fbb_) fbb_ = builders.acquire();
+              fbb_->Clear();
+              if (handler_(*request_.GetRoot(), cursor_, *fbb_)) {
+                writer_.Write(flatbuffers::BufferRef<Response>(
+                                  fbb_->GetBufferPointer(), fbb_->GetSize()),
+                              this);
+              } else {
+                limiter_->release();
+                finish(Status::OK);
+              }
+            })) {
+          limiter_->release();
+          finish(busy);
+        }
+      }
+
+      void finish(const Status &status) {
+        state_ = State::FINISH;
+        writer_.Finish(status, this);
+      }
+
+      grpc::ServerCompletionQueue *cq_;
+      Limiter *limiter_;
+      Requester requester_;
+      Handler handler_;
+
+      ServerContext context_;
+      flatbuffers::BufferRef<Request> request_;
+      BuilderPool::Builder fbb_;
+      Writer writer_;
+      State state_ = State::REQUEST;
+      uint64_t cursor_ = 0;
+    };
+
+    /**
+     * Client streaming RPC: REQUEST -> (READ)* -> FINISH
+     * Requests are handled in order on the handler pool and the next one
+     * is read only once the previous was handled, so a fast writer is held
+     * back by flow control. Handlers fold the requests into acc, done
+     * builds the response when the client stops writing; a handler that
+     * returns an error ends the call with it.
+     */
+    template <class Request, class Response, class Acc>
+    class ClientStreamCall final : public Call {
+     public:
+      using Reader = grpc::ServerAsyncReader<flatbuffers::BufferRef<Response>,
+                                             flatbuffers::BufferRef<Request>>;
+      using Requester = std::function<void(
+          ServerContext *, Reader *, grpc::ServerCompletionQueue *, void *)>;
+      using Handler = std::function<Status(const ServerContext &,
+                                           const Request &, Acc &)>;
+      using Done =
+          std::function<Status(Acc &, flatbuffers::FlatBufferBuilder &)>;
+
+      static void listen(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                         Requester requester, Handler handler, Done done) {
+        new ClientStreamCall(cq, limiter, std::move(requester),
+                             std::move(handler), std::move(done));
+      }
+
+      void proceed(bool ok) override {
+        switch (state_) {
+          case State::REQUEST:
+            if (!ok) break;
+            listen(cq_, limiter_, requester_, handler_, done_);
+            if (!limiter_->tryAcquire()) {
+              finish(busy);
+              return;
+            }
+            acquired_ = true;
+            state_ = State::READ;
+            read();
+            return;
+          case State::READ:
+            if (ok) {
+              if (!dispatch([this] {
+                    auto status =
+                        handler_(context_, *request_->GetRoot(), acc_);
+                    if (status.ok()) {
+                      read();
+                    } else {
+                      finish(status);
+                    }
+                  })) {
+                finish(busy);
+              }
+              return;
+            }
+            // the client is done writing
+            if (!dispatch([this] {
+                  response_ = builders.acquire();
+                  finish(done_(acc_, *response_));
+                })) {
+              finish(busy);
+            }
+            return;
+          case State::FINISH:
+            break;
+        }
+        delete this;
+      }
+
+     private:
+      enum class State { REQUEST, READ, FINISH };
+
+      ClientStreamCall(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                       Requester requester, Handler handler, Done done)
+          : cq_(cq),
+            limiter_(limiter),
+            requester_(std::move(requester)),
+            handler_(std::move(handler)),
+            done_(std::move(done)),
+            reader_(&context_) {
+        requester_(&context_, &reader_, cq_, this);
+      }
+
+      void read() {
+        request_.reset(new flatbuffers::BufferRef<Request>());
+        reader_.Read(request_.get(), this);
+      }
+
+      void finish(const Status &status) {
+        if (acquired_) limiter_->release();
+        acquired_ = false;
+        state_ = State::FINISH;
+        if (status.ok()) {
+          reader_.Finish(
+              flatbuffers::BufferRef<Response>(response_->GetBufferPointer(),
+                                               response_->GetSize()),
+              status, this);
+        } else {
+          reader_.FinishWithError(status, this);
+        }
+      }
+
+      grpc::ServerCompletionQueue *cq_;
+      Limiter *limiter_;
+      Requester requester_;
+      Handler handler_;
+      Done done_;
+
+      ServerContext context_;
+      std::unique_ptr<flatbuffers::BufferRef<Request>> request_;
+      BuilderPool::Builder response_;
+      Reader reader_;
+      State state_ = State::REQUEST;
+      bool acquired_ = false;
+      Acc acc_;
+    };
+
+    /**
+     * Bidirectional streaming RPC. One read and one write are in flight
+     * at most; requests are handled in order on the handler pool and a
+     * response produced while a write is in flight replaces the pending
+     * one, so handlers should send cumulative responses (acks).
+     */
+    template <class Request, class Response>
+    class BidiStreamCall final {
+     public:
+      using Stream =
+          grpc::ServerAsyncReaderWriter<flatbuffers::BufferRef<Response>,
+                                        flatbuffers::BufferRef<Request>>;
+      using Requester = std::function<void(
+          ServerContext *, Stream *, grpc::ServerCompletionQueue *, void *)>;
+      using Handler = std::function<bool(const Request &,
+                                         flatbuffers::FlatBufferBuilder &)>;
+
+      static void listen(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                         Requester requester, Handler handler) {
+        new BidiStreamCall(cq, limiter, std::move(requester),
+                           std::move(handler));
+      }
+
+     private:
+      // reads and writes overlap, so every kind of operation has its tag
+      class Op final : public Call {
+       public:
+        Op(BidiStreamCall *call, void (BidiStreamCall::*fn)(bool))
+            : call_(call), fn_(fn) {}
+        void proceed(bool ok) override { (call_->*fn_)(ok); }
+
+       private:
+        BidiStreamCall *call_;
+        void (BidiStreamCall::*fn_)(bool);
+      };
+
+      BidiStreamCall(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                     Requester requester, Handler handler)
+          : cq_(cq),
+            limiter_(limiter),
+            requester_(std::move(requester)),
+            handler_(std::move(handler)),
+            stream_(&context_),
+            accepted_(this, &BidiStreamCall::onAccepted),
+            read_(this, &BidiStreamCall::onRead),
+            written_(this, &BidiStreamCall::onWritten),
+            finished_(this, &BidiStreamCall::onFinished) {
+        requester_(&context_, &stream_, cq_, &accepted_);
+      }
+
+      void onAccepted(bool ok) {
+        if (!ok) {
+          delete this;
+          return;
+        }
+        listen(cq_, limiter_, requester_, handler_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!limiter_->tryAcquire()) {
+          close(busy);
+          return;
+        }
+        acquired_ = true;
+        read();
+      }
+
+      void onRead(bool ok) {
+        if (!ok) {
+          // the client is done writing or went away
+          std::lock_guard<std::mutex> lock(mutex_);
+          reading_ = false;
+          close(Status::OK);
+          return;
+        }
+        if (!dispatch([this] {
+              auto response = builders.acquire();
+              const bool respond = handler_(*request_->GetRoot(), *response);
+
+              std::lock_guard<std::mutex> lock(mutex_);
+              if (respond) write(std::move(response));
+              if (closing_) {
+                reading_ = false;
+                close(status_);
+              } else {
+                read();
+              }
+            })) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          reading_ = false;
+          close(busy);
+        }
+      }
+
+      void onWritten(bool ok) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) {
+          close(Status::OK);
+          return;
+        }
+        if (pending_) write(std::move(pending_));
+        if (closing_) close(status_);
+      }
+
+      void onFinished(bool) {
+        if (acquired_) limiter_->release();
+        delete this;
+      }
+
+      // the methods below are called with mutex_ held
+
+      void read() {
+        reading_ = true;
+        request_.reset(new flatbuffers::BufferRef<Request>());
+        stream_.Read(request_.get(), &read_);
+      }
+
+      void write(BuilderPool::Builder &&response) {
+        if (closing_) return;
+        if (writing_) {
+          pending_ = std::move(response);
+          return;
+        }
+        writing_ = true;
+        out_ = std::move(response);
+        stream_.Write(flatbuffers::BufferRef<Response>(out_->GetBufferPointer(),
+                                                       out_->GetSize()),
+                      &written_);
+      }
+
+      // Finish may only start when no read or write is in flight
+      void close(const Status &status) {
+        if (!closing_) {
+          closing_ = true;
+          status_ = status;
+        }
+        if (reading_ || writing_ || finishing_) return;
+        finishing_ = true;
+        stream_.Finish(status_, &finished_);
+      }
+
+      grpc::ServerCompletionQueue *cq_;
+      Limiter *limiter_;
+      Requester requester_;
+      Handler handler_;
+
+      ServerContext context_;
+      Stream stream_;
+      Op accepted_, read_, written_, finished_;
+
+      std::mutex mutex_;
+      std::unique_ptr<flatbuffers::BufferRef<Request>> request_;
+      BuilderPool::Builder out_, pending_;
+      bool acquired_ = false;
+      bool reading_ = false;
+      bool writing_ = false;
+      bool closing_ = false;
+      bool finishing_ = false;
+      Status status_;
+    };
+
+    template <class Request, class Response, class Service, class Requester,
+              class Handler>
+    void listenUnary(grpc::ServerCompletionQueue *cq, Limiter *limiter,
+                     Service *service, Requester requester, Handler handler) {
+      using namespace std::placeholders;
+      UnaryCall<Request, Response>::listen(
+          cq, limiter, std::bind(requester, service, _1, _2, _3, cq, _4, _5),
+          handler);
+    }
+
+  }  // namespace server
+
   /************************************************************************************
    * server interface
    ************************************************************************************/
   std::mutex wait_for_server;
-  ServerBuilder builder;
   grpc::Server *server = nullptr;
   std::condition_variable server_cv;
 
@@ -973,35 +2475,179 @@ namespace connection {
   void run() {
     logger::info("connection") << "run gRPC server";
 
+    auto &config = config::IrohaConfigManager::getInstance();
     const auto address =
-      "0.0.0.0:" +
-      std::to_string(
-          config::IrohaConfigManager::getInstance()
-            .getGrpcPortNumber(50051));
+        "0.0.0.0:" + std::to_string(config.getGrpcPortNumber(50051));
+    const auto cq_threads =
+        std::max<size_t>(1, config.getGrpcCompletionQueueThreads(1));
+    auto handler_threads = config.getGrpcHandlerThreads(0);
+    if (handler_threads == 0) {
+      handler_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
 
     SumeragiConnectionServiceImpl service;
     AssetRepositoryConnectionServiceImpl service_asset;
     SyncConnectionServiceImpl service_sync;
+    HijiriConnectionServiceImpl service_hijiri;
+
+    ::iroha::Sumeragi::AsyncService async_service;
+    ::iroha::AssetRepository::AsyncService async_service_asset;
+    ::iroha::Sync::AsyncService async_service_sync;
+    ::iroha::Hijiri::AsyncService async_service_hijiri;
+
+    server::Limiter limit_sumeragi(
+        config.getGrpcMaxConcurrentCalls("Sumeragi", 256));
+    server::Limiter limit_asset(
+        config.getGrpcMaxConcurrentCalls("AssetRepository", 64));
+    server::Limiter limit_sync(config.getGrpcMaxConcurrentCalls("Sync", 16));
+    server::Limiter limit_hijiri(
+        config.getGrpcMaxConcurrentCalls("Hijiri", 64));
 
     grpc::ServerBuilder builder;
     builder.AddListeningPort(address, grpc::InsecureServerCredentials());
 
-    builder.RegisterService(&service);
-    builder.RegisterService(&service_asset);
-    builder.RegisterService(&service_sync);
+    builder.RegisterService(&async_service);
+    builder.RegisterService(&async_service_asset);
+    builder.RegisterService(&async_service_sync);
+    builder.RegisterService(&async_service_hijiri);
+
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> cqs;
+    for (size_t i = 0; i < cq_threads; i++) {
+      cqs.push_back(builder.AddCompletionQueue());
+    }
+
+    server::stopping = false;
+    server::handlers.reset(new ThreadPool(ThreadPoolOptions{
+        .threads_count = handler_threads,
+        .worker_queue_size = config.getPoolWorkerQueueSize(1024),
+    }));
 
     wait_for_server.lock();
     server = builder.BuildAndStart().release();
     wait_for_server.unlock();
-    server_cv.notify_one();
+
+    using namespace std::placeholders;
+    std::vector<std::thread> pollers;
+    for (auto &cq : cqs) {
+      // every method has one pending call per completion queue
+      server::listenUnary<ConsensusEvent, Response>(
+          cq.get(), &limit_sumeragi, &async_service,
+          &::iroha::Sumeragi::AsyncService::RequestVerify,
+          std::bind(&SumeragiConnectionServiceImpl::Verify, &service, _2, _3));
+      server::listenUnary<Transaction, Response>(
+          cq.get(), &limit_sumeragi, &async_service,
+          &::iroha::Sumeragi::AsyncService::RequestTorii,
+          std::bind(&SumeragiConnectionServiceImpl::Torii, &service, _2, _3));
+      server::BidiStreamCall<VerifyFrame, VerifyAck>::listen(
+          cq.get(), &limit_sumeragi,
+          std::bind(&::iroha::Sumeragi::AsyncService::RequestVerifyStream,
+                    &async_service, _1, _2, cq.get(), _3, _4),
+          std::bind(&SumeragiConnectionServiceImpl::VerifyStream, &service,
+                    _1, _2));
+      server::listenUnary<TransactionBatch, BatchResponse>(
+          cq.get(), &limit_sumeragi, &async_service,
+          &::iroha::Sumeragi::AsyncService::RequestToriiBatch,
+          std::bind(&SumeragiConnectionServiceImpl::ToriiBatch, &service, _1,
+                    _2, _3));
+      server::listenUnary<TransactionBatch, PayloadAck>(
+          cq.get(), &limit_sumeragi, &async_service,
+          &::iroha::Sumeragi::AsyncService::RequestPublish,
+          std::bind(&SumeragiConnectionServiceImpl::Publish, &service, _1,
+                    _2, _3));
+      server::listenUnary<PayloadRequest, TransactionBatch>(
+          cq.get(), &limit_sumeragi, &async_service,
+          &::iroha::Sumeragi::AsyncService::RequestFetchPayload,
+          std::bind(&SumeragiConnectionServiceImpl::FetchPayload, &service,
+                    _1, _2, _3));
+      server::ClientStreamCall<TransactionBatch, BatchResponse,
+                               std::vector<uint8_t>>::
+          listen(cq.get(), &limit_sumeragi,
+                 std::bind(&::iroha::Sumeragi::AsyncService::RequestToriiStream,
+                           &async_service, _1, _2, cq.get(), _3, _4),
+                 std::bind(&SumeragiConnectionServiceImpl::ToriiStream,
+                           &service, _1, _2, _3),
+                 std::bind(&SumeragiConnectionServiceImpl::ToriiStreamDone,
+                           &service, _1, _2));
+      server::listenUnary<AssetQuery, AssetResponse>(
+          cq.get(), &limit_asset, &async_service_asset,
+          &::iroha::AssetRepository::AsyncService::RequestAccountGetAsset,
+          std::bind(&AssetRepositoryConnectionServiceImpl::AccountGetAsset,
+                    &service_asset, _2, _3));
+      server::listenUnary<Ping, ::iroha::CheckHashResponse>(
+          cq.get(), &limit_sync, &async_service_sync,
+          &::iroha::Sync::AsyncService::RequestcheckHash,
+          std::bind(&SyncConnectionServiceImpl::checkHash, &service_sync, _2,
+                    _3));
+      server::listenUnary<Ping, ::iroha::PeersResponse>(
+          cq.get(), &limit_sync, &async_service_sync,
+          &::iroha::Sync::AsyncService::RequestgetPeers,
+          std::bind(&SyncConnectionServiceImpl::getPeers, &service_sync, _2,
+                    _3));
+      server::listenUnary<Ping, TransactionResponse>(
+          cq.get(), &limit_sync, &async_service_sync,
+          &::iroha::Sync::AsyncService::RequestgetTransactions,
+          std::bind(&SyncConnectionServiceImpl::getTransactions, &service_sync,
+                    _2, _3));
+      server::listenUnary<TxRequest, ::iroha::RangeRoot>(
+          cq.get(), &limit_sync, &async_service_sync,
+          &::iroha::Sync::AsyncService::RequestgetRangeRoot,
+          std::bind(&SyncConnectionServiceImpl::getRangeRoot, &service_sync,
+                    _2, _3));
+      server::listenUnary<Ping, Response>(
+          cq.get(), &limit_hijiri, &async_service_hijiri,
+          &::iroha::Hijiri::AsyncService::RequestKagami,
+          std::bind(&HijiriConnectionServiceImpl::Kagami, &service_hijiri, _2,
+                    _3));
+      server::listenUnary<::iroha::MerkleNodesRequest, ::iroha::MerkleNodes>(
+          cq.get(), &limit_sync, &async_service_sync,
+          &::iroha::Sync::AsyncService::RequestgetMerkleNodes,
+          std::bind(&SyncConnectionServiceImpl::getMerkleNodes, &service_sync,
+                    _2, _3));
+      server::ServerStreamCall<TxRequest, TxBatch>::listen(
+          cq.get(), &limit_sync,
+          std::bind(
+              &::iroha::Sync::AsyncService::RequestfetchStreamTransaction,
+              &async_service_sync, _1, _2, _3, cq.get(), _4, _5),
+          std::bind(&SyncConnectionServiceImpl::fetchStreamTransaction,
+                    &service_sync, _1, _2, _3));
+
+      pollers.emplace_back([cq = cq.get()] {
+        void *tag;
+        bool ok;
+        while (cq->Next(&tag, &ok)) {
+          static_cast<server::Call *>(tag)->proceed(ok);
+        }
+      });
+    }
+    server_cv.notify_all();
 
     server->Wait();
-  }
 
-  void finish() {
-    server->Shutdown();
+    // completion queues may only be shut down once the server is, and the
+    // handlers only be destroyed once no poller can dispatch to them; the
+    // pending tasks finish first while the pollers still take their
+    // completions
+    server::drain();
+    for (auto &cq : cqs) cq->Shutdown();
+    for (auto &poller : pollers) poller.join();
+    server::handlers.reset();
+
+    wait_for_server.lock();
     delete server;
     server = nullptr;
+    wait_for_server.unlock();
+    server_cv.notify_all();
+  }
+
+  void finish() {
+    iroha::SumeragiImpl::Verify::closeStreams();
+
+    std::unique_lock<std::mutex> lock(wait_for_server);
+    if (!server) return;
+    // streams still open after the deadline are cancelled
+    server->Shutdown(std::chrono::system_clock::now() +
+                     std::chrono::seconds(1));
+    while (server) server_cv.wait(lock);
   }
 
 }  // namespace connection
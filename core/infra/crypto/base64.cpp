@@ -15,6 +15,12 @@ limitations under the License.
 */
 
 #include <crypto/base64.hpp>
+#include <utils/exception.hpp>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
 
 namespace base64 {
 
@@ -178,12 +184,348 @@ std::vector<unsigned char> base64_decode(std::string const &encoded_string) {
 }
 }  // namespace vendor
 
+namespace detail {
+
+static const int8_t decode_table[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/*
+ * Every block routine converts as many whole blocks as it can and returns
+ * the number of input bytes (encode) or characters (decode) it consumed.
+ * Decode routines return consumed = 0 for the block holding an invalid
+ * character, the scalar tail then rejects it.
+ */
+using encode_fn = size_t (*)(const uint8_t *src, size_t len, char *dst);
+using decode_fn = size_t (*)(const char *src, size_t len, uint8_t *dst);
+
+size_t encode_scalar(const uint8_t *src, size_t len, char *dst) {
+  size_t i = 0;
+  for (; i + 3 <= len; i += 3, dst += 4) {
+    const uint32_t v = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+    dst[0] = vendor::base64_chars[(v >> 18) & 0x3F];
+    dst[1] = vendor::base64_chars[(v >> 12) & 0x3F];
+    dst[2] = vendor::base64_chars[(v >> 6) & 0x3F];
+    dst[3] = vendor::base64_chars[v & 0x3F];
+  }
+  return i;
+}
+
+size_t decode_scalar(const char *src, size_t len, uint8_t *dst) {
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4, dst += 3) {
+    const int32_t a = decode_table[static_cast<uint8_t>(src[i])];
+    const int32_t b = decode_table[static_cast<uint8_t>(src[i + 1])];
+    const int32_t c = decode_table[static_cast<uint8_t>(src[i + 2])];
+    const int32_t d = decode_table[static_cast<uint8_t>(src[i + 3])];
+    if ((a | b | c | d) < 0) break;
+    const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+    dst[0] = v >> 16;
+    dst[1] = v >> 8;
+    dst[2] = v;
+  }
+  return i;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+/*
+ * Vector codecs after W. Mula and D. Lemire, "Faster Base64 Encoding and
+ * Decoding using AVX2 Instructions". Compiled per function with target
+ * attributes, so the rest of the library keeps the baseline ISA.
+ */
+#define BASE64_TARGET_SSE4 __attribute__((target("ssse3,sse4.1")))
+#define BASE64_TARGET_AVX2 __attribute__((target("avx2")))
+
+// reshuffled 3-byte groups => 6-bit indices => ASCII
+BASE64_TARGET_SSE4
+static inline __m128i enc_translate_sse4(__m128i in) {
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // indices 0..63 => ASCII by adding a per-range offset
+  const __m128i shift_lut = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+  return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, range), indices);
+}
+
+BASE64_TARGET_SSE4
+size_t encode_sse4(const uint8_t *src, size_t len, char *dst) {
+  const __m128i reshuffle =
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  size_t i = 0;
+  // loads 16 bytes, consumes 12
+  for (; i + 16 <= len; i += 12, dst += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    in = _mm_shuffle_epi8(in, reshuffle);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), enc_translate_sse4(in));
+  }
+  return i;
+}
+
+// ASCII => 6-bit values, false if any character is outside the alphabet
+BASE64_TARGET_SSE4
+static inline bool dec_translate_sse4(__m128i in, __m128i *out) {
+  const __m128i higher_nibble =
+      _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+  const __m128i lower_nibble = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+  const __m128i shift_lut =
+      _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  // bit (1 << higher_nibble) is set when (higher, lower) is a valid char
+  const __m128i mask_lut = _mm_setr_epi8(
+      (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+      (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, (char)0x54,
+      (char)0x50, (char)0x50, (char)0x50, (char)0x54);
+  const __m128i bitpos_lut =
+      _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0,
+                    0, 0, 0, 0, 0, 0, 0);
+
+  const __m128i sh = _mm_shuffle_epi8(shift_lut, higher_nibble);
+  const __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+  const __m128i shift = _mm_blendv_epi8(sh, _mm_set1_epi8(16), eq_2f);
+
+  const __m128i m = _mm_shuffle_epi8(mask_lut, lower_nibble);
+  const __m128i bit = _mm_shuffle_epi8(bitpos_lut, higher_nibble);
+  const __m128i non_match =
+      _mm_cmpeq_epi8(_mm_and_si128(m, bit), _mm_setzero_si128());
+  if (_mm_movemask_epi8(non_match)) return false;
+
+  *out = _mm_add_epi8(in, shift);
+  return true;
+}
+
+// four 6-bit values per 32-bit lane => 3 bytes, packed into the low 12 bytes
+BASE64_TARGET_SSE4
+static inline __m128i dec_pack_sse4(__m128i values) {
+  const __m128i ab_bc = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i abc = _mm_madd_epi16(ab_bc, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(abc, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                             13, 12, -1, -1, -1, -1));
+}
+
+BASE64_TARGET_SSE4
+size_t decode_sse4(const char *src, size_t len, uint8_t *dst) {
+  size_t i = 0;
+  // stores 16 bytes, 12 of them valid: dst has slack for that
+  for (; i + 16 <= len; i += 16, dst += 12) {
+    __m128i values;
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    if (!dec_translate_sse4(in, &values)) break;
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), dec_pack_sse4(values));
+  }
+  return i;
+}
+
+BASE64_TARGET_AVX2
+size_t encode_avx2(const uint8_t *src, size_t len, char *dst) {
+  const __m256i reshuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i shift_lut = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  size_t i = 0;
+  // two 12-byte groups, one per 128-bit lane; the second load reads 28 bytes
+  for (; i + 28 <= len; i += 24, dst += 32) {
+    const __m128i lo =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12));
+    __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    in = _mm256_shuffle_epi8(in, reshuffle);
+
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const __m256i out =
+        _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, range), indices);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+  }
+  return i;
+}
+
+BASE64_TARGET_AVX2
+size_t decode_avx2(const char *src, size_t len, uint8_t *dst) {
+  const __m256i shift_lut = _mm256_setr_epi8(
+      0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i mask_lut = _mm256_setr_epi8(
+      (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+      (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, (char)0x54,
+      (char)0x50, (char)0x50, (char)0x50, (char)0x54,
+      (char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+      (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, (char)0x54,
+      (char)0x50, (char)0x50, (char)0x50, (char)0x54);
+  const __m256i bitpos_lut = _mm256_setr_epi8(
+      0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0,
+      0, 0, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0,
+      0, 0, 0, 0);
+  const __m256i pack_shuffle = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+  size_t i = 0;
+  // stores 32 bytes, 24 of them valid: dst has slack for that
+  for (; i + 32 <= len; i += 32, dst += 24) {
+    const __m256i in =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+    const __m256i higher_nibble =
+        _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+    const __m256i lower_nibble = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+
+    const __m256i sh = _mm256_shuffle_epi8(shift_lut, higher_nibble);
+    const __m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+    const __m256i shift = _mm256_blendv_epi8(sh, _mm256_set1_epi8(16), eq_2f);
+
+    const __m256i m = _mm256_shuffle_epi8(mask_lut, lower_nibble);
+    const __m256i bit = _mm256_shuffle_epi8(bitpos_lut, higher_nibble);
+    const __m256i non_match =
+        _mm256_cmpeq_epi8(_mm256_and_si256(m, bit), _mm256_setzero_si256());
+    if (_mm256_movemask_epi8(non_match)) break;
+
+    const __m256i values = _mm256_add_epi8(in, shift);
+    const __m256i ab_bc =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i abc = _mm256_madd_epi16(ab_bc, _mm256_set1_epi32(0x00011000));
+    const __m256i packed = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(abc, pack_shuffle),
+        _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), packed);
+  }
+  return i;
+}
+
+static encode_fn select_encode() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return encode_avx2;
+  if (__builtin_cpu_supports("sse4.1")) return encode_sse4;
+  return encode_scalar;
+}
+
+static decode_fn select_decode() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return decode_avx2;
+  if (__builtin_cpu_supports("sse4.1")) return decode_sse4;
+  return decode_scalar;
+}
+
+static const encode_fn encode_blocks = select_encode();
+static const decode_fn decode_blocks = select_decode();
+#else
+static const encode_fn encode_blocks = encode_scalar;
+static const decode_fn decode_blocks = decode_scalar;
+#endif
+
+std::string encode(const uint8_t *src, size_t len, encode_fn blocks) {
+  std::string res(((len + 2) / 3) * 4, '\0');
+  char *dst = &res[0];
+
+  size_t i = blocks(src, len, dst);
+  i += encode_scalar(src + i, len - i, dst + i / 3 * 4);
+
+  const size_t rest = len - i;
+  if (rest) {
+    char *out = dst + i / 3 * 4;
+    const uint32_t v = (src[i] << 16) | (rest == 2 ? src[i + 1] << 8 : 0);
+    out[0] = vendor::base64_chars[(v >> 18) & 0x3F];
+    out[1] = vendor::base64_chars[(v >> 12) & 0x3F];
+    out[2] = rest == 2 ? vendor::base64_chars[(v >> 6) & 0x3F] : '=';
+    out[3] = '=';
+  }
+  return res;
+}
+
+/*
+ * Strict RFC 4648 decoding: length is a multiple of 4, only the alphabet
+ * plus at most two trailing '=', and unused bits of the last quantum are 0.
+ * Input without any padding, as Go's RawStdEncoding writes keys, is padded
+ * first.
+ */
+std::vector<unsigned char> decode(const char *src, size_t len,
+                                  decode_fn blocks) {
+  if (len % 4 != 0) {
+    if (len % 4 == 1 || src[len - 1] == '=') {
+      throw exception::crypto::InvalidBase64Exception("length is not 4n");
+    }
+    std::string padded(src, len);
+    padded.append(4 - len % 4, '=');
+    return decode(padded.data(), padded.size(), blocks);
+  }
+  if (len == 0) return {};
+
+  const size_t pad =
+      src[len - 1] != '=' ? 0 : src[len - 2] != '=' ? 1 : 2;
+  const size_t body = len - 4;  // last quantum may hold padding
+  // 32 bytes of slack for the vector stores
+  std::vector<unsigned char> res(len / 4 * 3 + 32);
+  uint8_t *dst = res.data();
+
+  size_t i = blocks(src, body, dst);
+  i += decode_scalar(src + i, body - i, dst + i / 4 * 3);
+  if (i != body) {
+    throw exception::crypto::InvalidBase64Exception("invalid character");
+  }
+
+  const int32_t a = decode_table[static_cast<uint8_t>(src[i])];
+  const int32_t b = decode_table[static_cast<uint8_t>(src[i + 1])];
+  const int32_t c =
+      pad >= 2 ? 0 : decode_table[static_cast<uint8_t>(src[i + 2])];
+  const int32_t d = pad >= 1 ? 0 : decode_table[static_cast<uint8_t>(src[i + 3])];
+  if ((a | b | c | d) < 0) {
+    throw exception::crypto::InvalidBase64Exception("invalid character");
+  }
+  const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+  if ((pad == 1 && (v & 0xFF)) || (pad == 2 && (v & 0xFFFF))) {
+    throw exception::crypto::InvalidBase64Exception("non-zero padding bits");
+  }
+
+  uint8_t *out = dst + i / 4 * 3;
+  out[0] = v >> 16;
+  out[1] = v >> 8;
+  out[2] = v;
+  res.resize(len / 4 * 3 - pad);
+  return res;
+}
+
+}  // namespace detail
+
 const std::string encode(const std::vector<unsigned char> &message) {
-  return vendor::base64_encode(message.data(), message.size());
+  return detail::encode(message.data(), message.size(), detail::encode_blocks);
 }
 
 std::vector<unsigned char> decode(const std::string &enc) {
-  return vendor::base64_decode(enc);
+  return detail::decode(enc.data(), enc.size(), detail::decode_blocks);
 }
 
 }  // namespace base64
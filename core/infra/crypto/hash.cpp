@@ -19,23 +19,69 @@ extern "C" {
 #include <crypto/hash.hpp>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace hash {
 
+static const char hex_code[] = "0123456789abcdef";
+
 static inline std::string digest_to_hexdigest(const unsigned char *digest,
                                               size_t size) {
-  char code[] = {'0', '1', '2', '3', '4', '5', '6', '7',
-                 '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
-  std::string res = "";
-  unsigned char front, back;
-  for (unsigned int i = 0; i < size; i++) {
-    front = (digest[i] & 0xF0) >> 4;
-    back = digest[i] & 0xF;
-    res += code[front];
-    res += code[back];
+  std::string res(size * 2, '\0');
+  char *out = &res[0];
+  size_t i = 0;
+#ifdef __SSE2__
+  // 16 bytes => 32 chars per step: split nibbles, interleave them and map
+  // 0..9 to '0'..'9', 10..15 to 'a'..'f'
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i zero_char = _mm_set1_epi8('0');
+  const __m128i alpha_offset = _mm_set1_epi8('a' - '0' - 10);
+  for (; i + 16 <= size; i += 16) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(digest + i));
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+    const __m128i lo = _mm_and_si128(in, mask);
+    __m128i first = _mm_unpacklo_epi8(hi, lo);
+    __m128i second = _mm_unpackhi_epi8(hi, lo);
+    first = _mm_add_epi8(
+        _mm_add_epi8(first, zero_char),
+        _mm_and_si128(_mm_cmpgt_epi8(first, nine), alpha_offset));
+    second = _mm_add_epi8(
+        _mm_add_epi8(second, zero_char),
+        _mm_and_si128(_mm_cmpgt_epi8(second, nine), alpha_offset));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i), first);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16), second);
+  }
+#endif
+  for (; i < size; i++) {
+    out[2 * i] = hex_code[digest[i] >> 4];
+    out[2 * i + 1] = hex_code[digest[i] & 0xF];
   }
   return res;
 }
 
+std::string to_hex(const uint8_t *data, size_t size) {
+  return digest_to_hexdigest(data, size);
+}
+
+std::string to_hex(const Hash32 &hash) {
+  return digest_to_hexdigest(hash.data(), hash.size());
+}
+
+Hash32 sha3_256(const uint8_t *data, size_t size) {
+  Hash32 res;
+  SHA3_256(res.bytes.data(), data, size);
+  return res;
+}
+
+Hash32 sha3_256(const std::string &message) {
+  return sha3_256(reinterpret_cast<const uint8_t *>(message.data()),
+                  message.size());
+}
+
 std::string sha3_256_hex(std::string message) {
   const int sha256_size = 32;  // bytes
   unsigned char digest[sha256_size];
@@ -65,4 +111,26 @@ std::string sha3_512_hex(std::string message) {
   return digest_to_hexdigest(digest, sha512_size);
 }
 
+Sha3_256::Sha3_256() { Keccak_HashInitialize_SHA3_256(&instance_); }
+
+void Sha3_256::update(const uint8_t *data, size_t size) {
+  // Keccak_HashUpdate takes the length in bits
+  Keccak_HashUpdate(&instance_, data, size * 8);
+}
+
+void Sha3_256::update(const std::string &message) {
+  update(reinterpret_cast<const uint8_t *>(message.data()), message.size());
+}
+
+Hash32 Sha3_256::digest() {
+  Hash32 res;
+  Keccak_HashFinal(&instance_, res.bytes.data());
+  return res;
+}
+
+std::string Sha3_256::hexdigest() {
+  const auto res = digest();
+  return digest_to_hexdigest(res.data(), res.size());
+}
+
 }  // namespace hash
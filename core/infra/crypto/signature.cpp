@@ -24,9 +24,22 @@ limitations under the License.
 
 #include <crypto/base64.hpp>
 #include <crypto/signature.hpp>
+#include <utils/exception.hpp>
+#include <utils/metrics.hpp>
+#include <utils/probes.hpp>
 
 namespace signature {
 
+namespace {
+metrics::Histogram &latency(const char *op) {
+  return metrics::histogram("iroha_signature_seconds",
+                            "Time of an ed25519 signature operation",
+                            {{"op", op}});
+}
+metrics::Histogram &signLatency = latency("sign");
+metrics::Histogram &verifyLatency = latency("verify");
+}  // namespace
+
 std::string sign(const std::string &message, const KeyPair &keyPair) {
   byte_array_t pub(keyPair.publicKey.begin(), keyPair.publicKey.end());
   byte_array_t pri(keyPair.privateKey.begin(), keyPair.privateKey.end());
@@ -46,25 +59,42 @@ std::string sign(const std::string &message, const std::string &publicKey_b64,
 
 byte_array_t sign(const std::string &message, const byte_array_t &publicKey,
                   const byte_array_t &privateKey) {
+  metrics::ScopedTimer timing(signLatency);
+  IROHA_PROBE1(sign_start, message.size());
   byte_array_t signature(SIG_SIZE);
   ed25519_sign(signature.data(),
                reinterpret_cast<const byte_t *>(message.c_str()),
                message.size(), publicKey.data(), privateKey.data());
+  IROHA_PROBE1(sign_end, message.size());
   return signature;
 }
 
 bool verify(const std::string &signature_b64, const std::string &message,
             const std::string &publicKey_b64) {
-  return ed25519_verify(base64::decode(signature_b64).data(),
-                        reinterpret_cast<const byte_t *>(message.c_str()),
-                        message.size(), base64::decode(publicKey_b64).data());
+  // both come from other peers: base64::decode throws on malformed text
+  byte_array_t signature, publicKey;
+  try {
+    signature = base64::decode(signature_b64);
+    publicKey = base64::decode(publicKey_b64);
+  } catch (const exception::crypto::InvalidBase64Exception &) {
+    return false;
+  }
+  return verify(signature, message, publicKey);
 }
 
 bool verify(const byte_array_t &signature, const std::string &message,
             const byte_array_t &publicKey) {
-  return ed25519_verify(signature.data(),
-                        reinterpret_cast<const byte_t *>(message.c_str()),
-                        message.size(), publicKey.data());
+  if (signature.size() != SIG_SIZE || publicKey.size() != PUB_KEY_SIZE) {
+    return false;
+  }
+  metrics::ScopedTimer timing(verifyLatency);
+  IROHA_PROBE1(verify_start, message.size());
+  const bool valid =
+      ed25519_verify(signature.data(),
+                     reinterpret_cast<const byte_t *>(message.c_str()),
+                     message.size(), publicKey.data()) != 0;
+  IROHA_PROBE1(verify_end, valid);
+  return valid;
 }
 
 KeyPair generateKeyPair() {
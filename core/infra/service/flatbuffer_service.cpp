@@ -31,6 +31,7 @@
 #include <map>
 #include <infra/config/peer_service_with_json.hpp>
 #include <membership_service/peer_service.hpp>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <commands_generated.h>
@@ -600,6 +601,29 @@ namespace flatbuffer_service {
 
       return txwrappers;
     }
+
+    // copies event with trace and height in place of its own
+    Expected<flatbuffers::Offset<::iroha::ConsensusEvent>>
+    copyConsensusEventWith(flatbuffers::FlatBufferBuilder& fbb,
+                           const ::iroha::ConsensusEvent& event,
+                           const ::iroha::TraceContext* trace,
+                           uint64_t height) {
+      auto peerSignatures = copyPeerSignaturesOf(fbb, event);
+      if (!peerSignatures) {
+        return makeUnexpected(peerSignatures.excptr());
+      }
+      auto txwrappers = copyTxWrappersOfEvent(fbb, event);
+      if (!txwrappers) {
+        return makeUnexpected(txwrappers.excptr());
+      }
+      std::vector<uint8_t> digests;
+      if (event.digests() != nullptr) {
+        digests.assign(event.digests()->begin(), event.digests()->end());
+      }
+      return ::iroha::CreateConsensusEventDirect(
+        fbb, &peerSignatures.value(), &txwrappers.value(), event.code(),
+        event.digests() != nullptr ? &digests : nullptr, trace, height);
+    }
   }  // namespace detail
 
   /**
@@ -638,16 +662,8 @@ namespace flatbuffer_service {
    */
   Expected<flatbuffers::Offset<::iroha::ConsensusEvent>> copyConsensusEvent(
     flatbuffers::FlatBufferBuilder& fbb, const iroha::ConsensusEvent& event) {
-    auto peerSignatures = detail::copyPeerSignaturesOf(fbb, event);
-    if (!peerSignatures) {
-      return makeUnexpected(peerSignatures.excptr());
-    }
-    auto txwrappers = detail::copyTxWrappersOfEvent(fbb, event);
-    if (!txwrappers) {
-      return makeUnexpected(txwrappers.excptr());
-    }
-    return ::iroha::CreateConsensusEventDirect(fbb, &peerSignatures.value(),
-                                               &txwrappers.value(), event.code());
+    return detail::copyConsensusEventWith(fbb, event, event.trace(),
+                                          event.height());
   }
 
   /**
@@ -731,7 +747,8 @@ namespace flatbuffer_service {
       ::iroha::CreateTransactionWrapperDirect(fbb, &tx));
 
     auto consensusEventOffset = ::iroha::CreateConsensusEventDirect(
-      fbb, &peerSignatures, &txwrappers, event.code());
+      fbb, &peerSignatures, &txwrappers, event.code(), nullptr, event.trace(),
+      event.height());
 
     fbb.Finish(consensusEventOffset);
     return fbb.ReleaseBufferPointer();
@@ -758,12 +775,100 @@ namespace flatbuffer_service {
 
     auto consensusEventOffset = ::iroha::CreateConsensusEventDirect(
       fbb, &peerSignatures, &txwrappers.value(),
-      iroha::Code::COMMIT);
+      iroha::Code::COMMIT, nullptr, event.trace(), event.height());
 
     fbb.Finish(consensusEventOffset);
     return fbb.ReleaseBufferPointer();
   }
 
+  Expected<flatbuffers::unique_ptr_t> toDigestEvent(
+    const iroha::ConsensusEvent& event) {
+    flatbuffers::FlatBufferBuilder fbb(16);
+
+    auto peerSignatures = detail::copyPeerSignaturesOf(fbb, event);
+    if (!peerSignatures) {
+      return makeUnexpected(peerSignatures.excptr());
+    }
+
+    std::vector<uint8_t> digests;
+    for (auto&& tx : *event.transactions()) {
+      auto handler = ensureNotNull(tx->tx());
+      if (!handler) {
+        return makeUnexpected(handler.excptr());
+      }
+      const auto digest = hash::sha3_256(tx->tx()->data(), tx->tx()->size());
+      digests.insert(digests.end(), digest.begin(), digest.end());
+    }
+
+    std::vector<flatbuffers::Offset<iroha::TransactionWrapper>> none;
+    fbb.Finish(::iroha::CreateConsensusEventDirect(
+      fbb, &peerSignatures.value(), &none, event.code(), &digests,
+      event.trace(), event.height()));
+    return fbb.ReleaseBufferPointer();
+  }
+
+  Expected<flatbuffers::unique_ptr_t> fromDigestEvent(
+    const iroha::ConsensusEvent& event,
+    const std::vector<std::vector<uint8_t>>& bodies) {
+    auto handler = ensureNotNull(event.digests());
+    if (!handler) {
+      return makeUnexpected(handler.excptr());
+    }
+    if (event.digests()->size() != bodies.size() * hash::Hash32::size()) {
+      return makeUnexpected(exception::InvalidCastException(
+        "digest count differs from transaction count", __FILE__));
+    }
+
+    flatbuffers::FlatBufferBuilder fbb(16);
+
+    auto peerSignatures = detail::copyPeerSignaturesOf(fbb, event);
+    if (!peerSignatures) {
+      return makeUnexpected(peerSignatures.excptr());
+    }
+
+    std::vector<flatbuffers::Offset<iroha::TransactionWrapper>> txwrappers;
+    for (size_t i = 0; i < bodies.size(); i++) {
+      const auto digest = hash::sha3_256(bodies[i].data(), bodies[i].size());
+      if (std::memcmp(digest.data(),
+                      event.digests()->data() + i * hash::Hash32::size(),
+                      hash::Hash32::size()) != 0) {
+        return makeUnexpected(exception::InvalidCastException(
+          "transaction does not match its digest", __FILE__));
+      }
+      txwrappers.push_back(
+        ::iroha::CreateTransactionWrapperDirect(fbb, &bodies[i]));
+    }
+
+    fbb.Finish(::iroha::CreateConsensusEventDirect(
+      fbb, &peerSignatures.value(), &txwrappers, event.code(), nullptr,
+      event.trace(), event.height()));
+    return fbb.ReleaseBufferPointer();
+  }
+
+  Expected<flatbuffers::unique_ptr_t> withTrace(
+    const iroha::ConsensusEvent& event, const iroha::TraceContext& trace) {
+    flatbuffers::FlatBufferBuilder fbb(16);
+    auto copy = detail::copyConsensusEventWith(fbb, event, &trace,
+                                               event.height());
+    if (!copy) {
+      return makeUnexpected(copy.excptr());
+    }
+    fbb.Finish(copy.value());
+    return fbb.ReleaseBufferPointer();
+  }
+
+  Expected<flatbuffers::unique_ptr_t> withHeight(
+    const iroha::ConsensusEvent& event, uint64_t height) {
+    flatbuffers::FlatBufferBuilder fbb(16);
+    auto copy =
+      detail::copyConsensusEventWith(fbb, event, event.trace(), height);
+    if (!copy) {
+      return makeUnexpected(copy.excptr());
+    }
+    fbb.Finish(copy.value());
+    return fbb.ReleaseBufferPointer();
+  }
+
   namespace peer {  // namespace peer
 
     flatbuffers::Offset<PeerAdd> CreateAdd(flatbuffers::FlatBufferBuilder &fbb, const ::peer::Node &peer) {
@@ -955,6 +1060,242 @@ namespace flatbuffer_service {
       return {bufptr, bufptr + fbb.GetSize()};
     }
 
+    namespace detail {
+
+      /*
+       * Canonical binary form of the signed fields, fed straight into
+       * the sponge:
+       *  - integers are little endian with fixed width, doubles by their
+       *    IEEE-754 bits, bools as one byte
+       *  - strings and byte vectors are a presence byte, u32 length and bytes
+       *  - nested flatbuffers ([ubyte] fields) are absorbed as raw bytes
+       */
+      class CanonicalWriter {
+       public:
+        explicit CanonicalWriter(hash::Sha3_256 &sha) : sha_(sha) {}
+
+        void u8(uint8_t v) { sha_.update(&v, 1); }
+
+        void u16(uint16_t v) { le(v, 2); }
+
+        void u32(uint32_t v) { le(v, 4); }
+
+        void u64(uint64_t v) { le(v, 8); }
+
+        void f64(double v) {
+          uint64_t bits;
+          std::memcpy(&bits, &v, sizeof(bits));
+          u64(bits);
+        }
+
+        void str(const flatbuffers::String *s) {
+          u8(s != nullptr);
+          if (s == nullptr) return;
+          u32(s->size());
+          sha_.update(reinterpret_cast<const uint8_t *>(s->data()), s->size());
+        }
+
+        void bytes(const flatbuffers::Vector<uint8_t> *v) {
+          u8(v != nullptr);
+          if (v == nullptr) return;
+          u32(v->size());
+          sha_.update(v->data(), v->size());
+        }
+
+        void strs(
+          const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>
+            *v) {
+          u8(v != nullptr);
+          if (v == nullptr) return;
+          u32(v->size());
+          for (const auto &s : *v) str(s);
+        }
+
+       private:
+        hash::Sha3_256 &sha_;
+
+        void le(uint64_t v, size_t width) {
+          uint8_t buf[8];
+          for (size_t i = 0; i < width; i++) {
+            buf[i] = static_cast<uint8_t>(v >> (8 * i));
+          }
+          sha_.update(buf, width);
+        }
+      };
+
+      void writePermission(CanonicalWriter &w, iroha::AccountPermission type,
+                           const void *permission) {
+        using iroha::AccountPermission;
+        w.u8(static_cast<uint8_t>(type));
+        switch (type) {
+          case AccountPermission::AccountPermissionRoot: {
+            auto p = static_cast<const iroha::AccountPermissionRoot *>(permission);
+            w.u8(p->ledger_add());
+            w.u8(p->ledger_remove());
+          } break;
+          case AccountPermission::AccountPermissionLedger: {
+            auto p = static_cast<const iroha::AccountPermissionLedger *>(permission);
+            w.str(p->ledger_name());
+            w.u8(p->domain_add());
+            w.u8(p->domain_remove());
+            w.u8(p->peer_read());
+            w.u8(p->peer_write());
+            w.u8(p->account_add());
+            w.u8(p->account_remove());
+            w.u8(p->account_give_permission());
+          } break;
+          case AccountPermission::AccountPermissionDomain: {
+            auto p = static_cast<const iroha::AccountPermissionDomain *>(permission);
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+            w.u8(p->account_give_permission());
+            w.u8(p->account_add());
+            w.u8(p->account_remove());
+            w.u8(p->asset_create());
+            w.u8(p->asset_remove());
+            w.u8(p->asset_update());
+          } break;
+          case AccountPermission::AccountPermissionAsset: {
+            auto p = static_cast<const iroha::AccountPermissionAsset *>(permission);
+            w.str(p->asset_name());
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+            w.u8(p->account_give_permission());
+            w.u8(p->transfer());
+            w.u8(p->add());
+            w.u8(p->subtract());
+            w.u8(p->read());
+          } break;
+          case AccountPermission::NONE:
+            break;
+        }
+      }
+
+      void writeCommand(CanonicalWriter &w, const iroha::Transaction &tx) {
+        using iroha::Command;
+        w.u8(static_cast<uint8_t>(tx.command_type()));
+        switch (tx.command_type()) {
+          case Command::Add: {
+            auto p = tx.command_as_Add();
+            w.str(p->accPubKey());
+            w.bytes(p->asset());
+          } break;
+          case Command::Subtract: {
+            auto p = tx.command_as_Subtract();
+            w.str(p->accPubKey());
+            w.bytes(p->asset());
+          } break;
+          case Command::Transfer: {
+            auto p = tx.command_as_Transfer();
+            w.bytes(p->asset());
+            w.str(p->sender());
+            w.str(p->receiver());
+          } break;
+          case Command::AssetCreate: {
+            auto p = tx.command_as_AssetCreate();
+            w.str(p->asset_name());
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+            w.str(p->amount());
+            w.str(p->description());
+          } break;
+          case Command::AssetRemove: {
+            auto p = tx.command_as_AssetRemove();
+            w.str(p->asset_name());
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+          } break;
+          case Command::PeerAdd: {
+            w.bytes(tx.command_as_PeerAdd()->peer());
+          } break;
+          case Command::PeerRemove: {
+            w.str(tx.command_as_PeerRemove()->peerPubKey());
+          } break;
+          case Command::PeerSetActive: {
+            auto p = tx.command_as_PeerSetActive();
+            w.str(p->peerPubKey());
+            w.u8(p->active());
+          } break;
+          case Command::PeerSetTrust: {
+            auto p = tx.command_as_PeerSetTrust();
+            w.str(p->peerPubKey());
+            w.f64(p->trust());
+          } break;
+          case Command::PeerChangeTrust: {
+            auto p = tx.command_as_PeerChangeTrust();
+            w.str(p->peerPubKey());
+            w.f64(p->delta());
+          } break;
+          case Command::AccountAdd: {
+            w.bytes(tx.command_as_AccountAdd()->account());
+          } break;
+          case Command::AccountRemove: {
+            w.str(tx.command_as_AccountRemove()->pubkey());
+          } break;
+          case Command::AccountAddSignatory: {
+            auto p = tx.command_as_AccountAddSignatory();
+            w.str(p->account());
+            w.strs(p->signatory());
+          } break;
+          case Command::AccountRemoveSignatory: {
+            auto p = tx.command_as_AccountRemoveSignatory();
+            w.str(p->account());
+            w.strs(p->signatory());
+          } break;
+          case Command::AccountSetUseKeys: {
+            auto p = tx.command_as_AccountSetUseKeys();
+            w.strs(p->accounts());
+            w.u16(p->useKeys());
+          } break;
+          case Command::AccountMigrate: {
+            auto p = tx.command_as_AccountMigrate();
+            w.bytes(p->account());
+            w.str(p->prevPubKey());
+          } break;
+          case Command::ChaincodeAdd: {
+            w.bytes(tx.command_as_ChaincodeAdd()->code());
+          } break;
+          case Command::ChaincodeRemove: {
+            auto p = tx.command_as_ChaincodeRemove();
+            w.str(p->code_name());
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+          } break;
+          case Command::ChaincodeExecute: {
+            auto p = tx.command_as_ChaincodeExecute();
+            w.str(p->code_name());
+            w.str(p->domain_name());
+            w.str(p->ledger_name());
+          } break;
+          case Command::PermissionAdd: {
+            auto p = tx.command_as_PermissionAdd();
+            w.str(p->targetAccount());
+            writePermission(w, p->permission_type(), p->permission());
+          } break;
+          case Command::PermissionRemove: {
+            auto p = tx.command_as_PermissionRemove();
+            w.str(p->targetAccount());
+            writePermission(w, p->permission_type(), p->permission());
+          } break;
+          case Command::NONE:
+            break;
+        }
+      }
+
+    }  // namespace detail
+
+    void absorbSignedFields(hash::Sha3_256 &sha, const iroha::Transaction &tx) {
+      detail::CanonicalWriter w(sha);
+      w.str(tx.creatorPubKey());
+      w.u64(tx.timestamp());
+      detail::writeCommand(w, tx);
+      w.u8(tx.attachment() != nullptr);
+      if (tx.attachment() != nullptr) {
+        w.str(tx.attachment()->mime());
+        w.bytes(tx.attachment()->data());
+      }
+    }
+
   };  // namespace transaction
 
   namespace endpoint {
@@ -0,0 +1,131 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <infra/service/http_server.hpp>
+#include <utils/logger.hpp>
+#include <utils/metrics.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace http_server {
+
+namespace {
+
+std::atomic<bool> running{false};
+std::thread thread;
+int listener = -1;
+
+void writeAll(int fd, const std::string &data) {
+  size_t done = 0;
+  while (done < data.size()) {
+    auto n = ::send(fd, data.data() + done, data.size() - done, MSG_NOSIGNAL);
+    if (n <= 0) return;
+    done += n;
+  }
+}
+
+std::string response(const std::string &status, const std::string &type,
+                     const std::string &body) {
+  return "HTTP/1.0 " + status + "\r\nContent-Type: " + type +
+         "\r\nContent-Length: " + std::to_string(body.size()) +
+         "\r\nConnection: close\r\n\r\n" + body;
+}
+
+void serve(int fd) {
+  // a client that doesn't send its request line in time is dropped
+  timeval timeout{1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+    auto n = ::recv(fd, buf, sizeof(buf), 0);
+    if (n <= 0) return;
+    request.append(buf, n);
+  }
+
+  const auto line = request.substr(0, request.find("\r\n"));
+  if (line.compare(0, 13, "GET /metrics ") == 0) {
+    writeAll(fd, response("200 OK", "text/plain; version=0.0.4",
+                          metrics::render()));
+  } else {
+    writeAll(fd, response("404 Not Found", "text/plain", "not found\n"));
+  }
+}
+
+void loop() {
+  while (running) {
+    pollfd pfd{listener, POLLIN, 0};
+    // wakes up now and then to see stop()
+    if (poll(&pfd, 1, 200) <= 0) continue;
+    auto fd = ::accept(listener, nullptr, nullptr);
+    if (fd < 0) continue;
+    serve(fd);
+    ::close(fd);
+  }
+}
+
+}  // namespace
+
+bool start(const std::string &address, uint16_t port) {
+  if (running) return true;
+
+  listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listener < 0) {
+    logger::error("http_server") << "socket: " << std::strerror(errno);
+    return false;
+  }
+  int yes = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+      ::bind(listener, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+      ::listen(listener, 16) != 0) {
+    logger::error("http_server") << "can't listen on " << address << ":"
+                                 << port << ": " << std::strerror(errno);
+    ::close(listener);
+    listener = -1;
+    return false;
+  }
+
+  logger::info("http_server") << "metrics on http://" << address << ":"
+                              << port << "/metrics";
+  running = true;
+  thread = std::thread(loop);
+  return true;
+}
+
+void stop() {
+  if (!running) return;
+  running = false;
+  thread.join();
+  ::close(listener);
+  listener = -1;
+}
+
+}  // namespace http_server
@@ -0,0 +1,39 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IROHA_HTTP_SERVER_HPP
+#define IROHA_HTTP_SERVER_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Minimal HTTP/1.0 server for operators: GET /metrics returns
+ * metrics::render(). One thread, one request per connection.
+ */
+namespace http_server {
+
+/**
+ * Listens on address:port in a background thread.
+ * @return false if the socket could not be bound
+ */
+bool start(const std::string &address, uint16_t port);
+
+void stop();
+
+}  // namespace http_server
+
+#endif  // IROHA_HTTP_SERVER_HPP
@@ -19,25 +19,114 @@ limitations under the License.
 //#include <connection/connection.hpp>
 #include <membership_service/hijiri.hpp>
 #include <membership_service/peer_service.hpp>
+#include <infra/config/iroha_config_with_json.hpp>
+#include <infra/config/peer_service_with_json.hpp>
+#include <service/connection.hpp>
+#include <utils/logger.hpp>
+#include <endpoint_generated.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace peer {
 namespace hijiri {
 
-// check are broken? peer
-void check(const std::string &ip) {
-    /*
-  if (!service::isExistIP(ip)) return;
-  auto check_peer_it = *service::findPeerIP(ip);
-  if (!connection::iroha::PeerService::Sumeragi::ping(ip)) {
-    if (check_peer_it->trustScore < 0.0) {
-      transaction::isssue::remove(check_peer_it->publicKey);
-    } else {
-      transaction::isssue::distruct(check_peer_it->publicKey);
+namespace {
+
+// weight of the newest ping in the moving averages
+const double alpha = 0.2;
+// round trip time that halves the trust score
+const double rttScaleMillis = 10.0;
+// trust scores are reported every reportRounds rounds of pings
+const size_t reportRounds = 10;
+
+std::mutex mutex;
+std::unordered_map<std::string, Measurement> measurements;
+// trust score last reported per public key
+std::unordered_map<std::string, double> reported;
+
+std::atomic_bool running(false);
+std::thread worker;
+
+void report() {
+  const auto maxTrust =
+      config::PeerServiceConfig::getInstance().getMaxTrustScore();
+  for (const auto &node : service::getAllPeerList()) {
+    if (node->publicKey == myself::getPublicKey()) continue;
+    const auto trust = std::round(
+        std::min(maxTrust, trustOf(measurementOf(node->ip))));
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = reported.find(node->publicKey);
+      if (it != reported.end() && it->second == trust) continue;
+      reported[node->publicKey] = trust;
     }
-  } else {
-    transaction::isssue::credit(check_peer_it->publicKey);
+    // goes through consensus like any transaction, so every peer applies
+    // the same score at the same point of the ledger
+    transaction::isssue::setTrust(myself::getIp(), node->publicKey, trust);
   }
-     */
+}
+
+}  // namespace
+
+void check(const std::string &ip) {
+  flatbuffers::FlatBufferBuilder fbb;
+  fbb.Finish(::iroha::CreatePingDirect(fbb, "Kagami",
+                                       myself::getIp().c_str()));
+  const auto &ping = *flatbuffers::GetRoot<::iroha::Ping>(fbb.GetBufferPointer());
+
+  const auto begin = std::chrono::steady_clock::now();
+  const bool answered =
+      connection::memberShipService::HijiriImpl::Kagami::send(ip, ping);
+  const double rtt = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &m = measurements[ip];
+  m.responseRate = (1 - alpha) * m.responseRate + alpha * (answered ? 1.0 : 0.0);
+  if (answered) {
+    m.rttMillis = m.pings == 0 ? rtt : (1 - alpha) * m.rttMillis + alpha * rtt;
+  }
+  m.pings++;
+}
+
+Measurement measurementOf(const std::string &ip) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = measurements.find(ip);
+  return it == measurements.end() ? Measurement() : it->second;
+}
+
+double trustOf(const Measurement &m) {
+  const auto maxTrust =
+      config::PeerServiceConfig::getInstance().getMaxTrustScore();
+  return maxTrust * m.responseRate / (1.0 + m.rttMillis / rttScaleMillis);
+}
+
+void start() {
+  const auto interval =
+      config::IrohaConfigManager::getInstance().getHijiriPingInterval(0);
+  if (interval == 0 || running.exchange(true)) return;
+
+  worker = std::thread([interval] {
+    logger::info("hijiri") << "ping every " << interval << "ms";
+    for (size_t round = 1; running; round++) {
+      for (const auto &node : service::getAllPeerList()) {
+        if (node->ip != myself::getIp()) check(node->ip);
+      }
+      if (round % reportRounds == 0) report();
+      std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    }
+  });
+}
+
+void stop() {
+  if (!running.exchange(false)) return;
+  if (worker.joinable()) worker.join();
 }
 
 }  // namespace hijiri
@@ -17,17 +17,39 @@ limitations under the License.
 #ifndef __CORE_HIJIRI_SERVICE_HPP__
 #define __CORE_HIJIRI_SERVICE_HPP__
 
+#include <cstdint>
 #include <map>
 #include <queue>
 #include <set>
+#include <string>
 #include <vector>
 
 namespace peer {
 namespace hijiri {
 // This is reputation System.
 
-// check are broken? peer
-void check(const std::string &ip);  // TODO
+// round trip time and response rate of a peer, measured with Kagami pings
+struct Measurement {
+  double rttMillis = 0.0;     // moving average over answered pings
+  double responseRate = 1.0;  // moving average, 1.0 if every ping is answered
+  uint64_t pings = 0;
+};
+
+// pings the peer once and updates its measurement
+void check(const std::string &ip);
+
+Measurement measurementOf(const std::string &ip);
+
+// trust score of a measurement: the max trust score for a peer answering
+// every ping at once, lower as it answers slower or drops pings
+double trustOf(const Measurement &m);
+
+// pings every peer each "hijiri_ping_interval_ms" in the background and
+// reports changed trust scores to the ledger with PeerSetTrust. A peer's
+// trust is the median of the scores all peers reported for it, so every
+// peer orders validators from the same numbers. 0 disables it.
+void start();
+void stop();
 
 namespace my{
 
@@ -20,7 +20,11 @@ limitations under the License.
 //
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <regex>
 
 #include <commands_generated.h>
@@ -35,9 +39,73 @@ limitations under the License.
 namespace peer {
 
 using PeerServiceConfig = config::PeerServiceConfig;
-Nodes peerList;
 bool is_active;
 
+namespace {
+
+// serializes changes, readers never take it
+std::mutex mutex;
+std::shared_ptr<const service::Registry> current;
+// bumped after each publish, lets readers reuse their snapshot
+std::atomic<uint64_t> version(0);
+
+std::shared_ptr<const service::Registry> build(Nodes all) {
+  auto registry = std::make_shared<service::Registry>();
+  for (const auto &node : all) {
+    registry->byIp.emplace(node->ip, node);
+    registry->byPublicKey.emplace(node->publicKey, node);
+    if (node->active) registry->active.push_back(node);
+  }
+  std::stable_sort(
+      registry->active.begin(), registry->active.end(),
+      [](const auto &a, const auto &b) { return a->trust > b->trust; });
+  registry->all = std::move(all);
+  return registry;
+}
+
+// mutex must be held
+void publish(Nodes all) {
+  std::atomic_store(&current, build(std::move(all)));
+  version.fetch_add(1, std::memory_order_release);
+}
+
+// snapshot cached per thread, reloaded only after a change; valid until
+// the next call on the same thread
+const service::Registry &snapshot() {
+  thread_local std::shared_ptr<const service::Registry> cached;
+  thread_local uint64_t cachedVersion = 0;
+  const auto latest = version.load(std::memory_order_acquire);
+  if (cached == nullptr || cachedVersion != latest) {
+    if (latest == 0) service::initialize();
+    cached = std::atomic_load(&current);
+    // a publish after the load of latest is picked up by the next call
+    cachedVersion = latest;
+  }
+  return *cached;
+}
+
+// trust score reported by each observer, per observed public key; mutex
+// must be held. Ordered maps, so every peer aggregates them the same way.
+std::map<std::string, std::map<std::string, double>> trustReports;
+
+// replaces the node of publicKey with a changed copy; mutex must be held
+bool replace(const std::string &publicKey,
+             const std::function<void(Node &)> &change) {
+  auto all = std::atomic_load(&current)->all;
+  for (auto &node : all) {
+    if (node->publicKey == publicKey) {
+      auto copy = std::make_shared<Node>(*node);
+      change(*copy);
+      node = std::move(copy);
+      publish(std::move(all));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
 namespace myself {
 
 std::string getPublicKey() {
@@ -55,9 +123,9 @@ void activate() { is_active = true; }
 void stop() { is_active = false; }
 
 bool isLeader() {
-  auto sorted_peers = service::getActivePeerList();
-  if (sorted_peers.empty()) return false;
-  auto peer = *sorted_peers.begin();
+  const auto &active = snapshot().active;
+  if (active.empty()) return false;
+  const auto &peer = active.front();
   return peer->publicKey == getPublicKey() && peer->ip == getIp();
 }
 
@@ -67,76 +135,64 @@ namespace service {
 
 // this function must be invoke before use peer-service.
 void initialize() {
-  if (!peerList.empty()) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (current != nullptr) {
     return;
   }
+  Nodes all;
   for (const auto &json_peer : PeerServiceConfig::getInstance().getGroup()) {
-    peerList.push_back(std::make_shared<Node>(
+    all.push_back(std::make_shared<Node>(
         json_peer["ip"].get<std::string>(),
         json_peer["publicKey"].get<std::string>(),
         PeerServiceConfig::getInstance().getMaxTrustScore()));
   }
+  publish(std::move(all));
   is_active = false;
 }
 
-size_t getMaxFaulty() {
-  return std::max(0, ((int)getActivePeerList().size() - 1) / 3);
+std::shared_ptr<const Registry> registry() {
+  snapshot();
+  return std::atomic_load(&current);
 }
 
-Nodes getAllPeerList() {
-  initialize();
-  return peerList;
+size_t getMaxFaulty() {
+  return std::max(0, ((int)snapshot().active.size() - 1) / 3);
 }
-Nodes getActivePeerList() {
-  initialize();
-
-  Nodes nodes;
-  for (const auto &node : peerList) {
-    if (node->active) {
-      nodes.push_back(
-          std::make_unique<peer::Node>(node->ip, node->publicKey, node->trust));
-    }
-  }
 
-  // TODO: maintain nodes already sorted
-  sort(nodes.begin(), nodes.end(),
-       [](const auto &a, const auto &b) { return a->trust > b->trust; });
+Nodes getAllPeerList() { return snapshot().all; }
 
-  return nodes;
-}
+Nodes getActivePeerList() { return snapshot().active; }
 
 std::vector<std::string> getIpList() {
   std::vector<std::string> ret_ips;
-  for (const auto &node : getActivePeerList()) {
+  for (const auto &node : snapshot().active) {
     ret_ips.push_back(node->ip);
   }
   return ret_ips;
 }
 
 // is exist which peer?
-bool isExistIP(const std::string &ip) {
-  return findPeerIP(ip) != peerList.end();
-}
+bool isExistIP(const std::string &ip) { return snapshot().byIp.count(ip) != 0; }
 
 bool isExistPublicKey(const std::string &publicKey) {
-  return findPeerPublicKey(publicKey) != peerList.end();
+  return snapshot().byPublicKey.count(publicKey) != 0;
 }
 
-Nodes::iterator findPeerIP(const std::string &ip) {
-  initialize();
-  return std::find_if(peerList.begin(), peerList.end(),
-                      [&ip](const auto &p) { return p->ip == ip; });
+std::shared_ptr<const Node> findPeerIP(const std::string &ip) {
+  const auto &byIp = snapshot().byIp;
+  auto it = byIp.find(ip);
+  return it == byIp.end() ? nullptr : it->second;
 }
 
-Nodes::iterator findPeerPublicKey(const std::string &publicKey) {
-  initialize();
-  return std::find_if(
-      peerList.begin(), peerList.end(),
-      [&publicKey](const auto &p) { return p->publicKey == publicKey; });
+std::shared_ptr<const Node> findPeerPublicKey(const std::string &publicKey) {
+  const auto &byPublicKey = snapshot().byPublicKey;
+  auto it = byPublicKey.find(publicKey);
+  return it == byPublicKey.end() ? nullptr : it->second;
 }
 
-std::shared_ptr<peer::Node> leaderPeer() {
-  return std::move(*getActivePeerList().begin());
+std::shared_ptr<const Node> leader() {
+  const auto &active = snapshot().active;
+  return active.empty() ? nullptr : active.front();
 }
 
 }  // namespace service
@@ -211,11 +267,16 @@ namespace executor {
 // invoke when execute transaction
 bool add(const peer::Node &peer) {
   try {
-    if (service::isExistIP(peer.ip))
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto registry = std::atomic_load(&current);
+    if (registry->byIp.count(peer.ip))
       throw exception::service::DuplicationIPException(peer.ip);
-    if (service::isExistPublicKey(peer.publicKey))
+    if (registry->byPublicKey.count(peer.publicKey))
       throw exception::service::DuplicationPublicKeyException(peer.publicKey);
-    peerList.emplace_back(std::make_shared<peer::Node>(peer));
+    auto all = registry->all;
+    all.push_back(std::make_shared<peer::Node>(peer));
+    publish(std::move(all));
   } catch (exception::service::DuplicationPublicKeyException &e) {
     logger::warning("addPeer") << e.what();
     return false;
@@ -227,10 +288,16 @@ bool add(const peer::Node &peer) {
 }
 bool remove(const std::string &publicKey) {
   try {
-    auto it = service::findPeerPublicKey(publicKey);
-    if (!service::isExistPublicKey(publicKey))
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto all = std::atomic_load(&current)->all;
+    auto it = std::find_if(all.begin(), all.end(), [&publicKey](const auto &p) {
+      return p->publicKey == publicKey;
+    });
+    if (it == all.end())
       throw exception::service::UnExistFindPeerException(publicKey);
-    peerList.erase(it);
+    all.erase(it);
+    publish(std::move(all));
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("removePeer") << e.what();
     return false;
@@ -240,10 +307,13 @@ bool remove(const std::string &publicKey) {
 
 bool setTrust(const std::string &publicKey, const double &trust) {
   try {
-    if (!service::isExistPublicKey(publicKey))
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!replace(publicKey, [&trust](Node &node) {
+          node.trust = std::min(
+              PeerServiceConfig::getInstance().getMaxTrustScore(), trust);
+        }))
       throw exception::service::UnExistFindPeerException(publicKey);
-    service::findPeerPublicKey(publicKey)->get()->trust =
-        std::min(PeerServiceConfig::getInstance().getMaxTrustScore(), trust);
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("validate setTrust") << e.what();
     return false;
@@ -251,14 +321,51 @@ bool setTrust(const std::string &publicKey, const double &trust) {
   return true;
 }
 
+bool reportTrust(const std::string &observer, const std::string &publicKey,
+                 const double &trust) {
+  try {
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto registry = std::atomic_load(&current);
+    if (!registry->byPublicKey.count(publicKey))
+      throw exception::service::UnExistFindPeerException(publicKey);
+    if (!registry->byPublicKey.count(observer))
+      throw exception::service::UnExistFindPeerException(observer);
+
+    auto &reports = trustReports[publicKey];
+    reports[observer] = trust;
+    // reports of peers removed since are left out
+    std::vector<double> scores;
+    for (const auto &report : reports) {
+      if (registry->byPublicKey.count(report.first))
+        scores.push_back(report.second);
+    }
+    std::sort(scores.begin(), scores.end());
+    const auto mid = scores.size() / 2;
+    const auto median = scores.size() % 2 == 1
+                            ? scores[mid]
+                            : (scores[mid - 1] + scores[mid]) / 2;
+    replace(publicKey, [median](Node &node) {
+      node.trust =
+          std::min(PeerServiceConfig::getInstance().getMaxTrustScore(), median);
+    });
+  } catch (exception::service::UnExistFindPeerException &e) {
+    logger::warning("validate reportTrust") << e.what();
+    return false;
+  }
+  return true;
+}
+
 bool changeTrust(const std::string &publicKey, const double &trust) {
   try {
-    if (!service::isExistPublicKey(publicKey))
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!replace(publicKey, [&trust](Node &node) {
+          node.trust = std::min(
+              PeerServiceConfig::getInstance().getMaxTrustScore(),
+              node.trust + trust);
+        }))
       throw exception::service::UnExistFindPeerException(publicKey);
-    auto it = service::findPeerPublicKey(publicKey)->get();
-    it->trust += trust;
-    it->trust = std::min(PeerServiceConfig::getInstance().getMaxTrustScore(),
-                         it->trust);
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("validate changeTrust") << e.what();
     return false;
@@ -268,9 +375,10 @@ bool changeTrust(const std::string &publicKey, const double &trust) {
 
 bool setActive(const std::string &publicKey, const bool active) {
   try {
-    if (!service::isExistPublicKey(publicKey))
+    service::initialize();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!replace(publicKey, [active](Node &node) { node.active = active; }))
       throw exception::service::UnExistFindPeerException(publicKey);
-    service::findPeerPublicKey(publicKey)->get()->active = active;
   } catch (exception::service::UnExistFindPeerException &e) {
     logger::warning("validate setActive") << e.what();
     return false;
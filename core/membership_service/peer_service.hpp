@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace peer {
@@ -64,7 +65,8 @@ struct Node {
   bool isDefaultPubKey() const { return publicKey == defaultPubKey(); }
 };
 
-using Nodes = std::vector<std::shared_ptr<Node>>;
+// nodes are shared by registry snapshots, a change replaces the node
+using Nodes = std::vector<std::shared_ptr<const Node>>;
 
 namespace myself {
 
@@ -83,8 +85,22 @@ bool isLeader();
 
 namespace service {
 
+/**
+ * Peers as of one membership change. A snapshot is immutable: a change
+ * builds the next one and publishes it, readers keep the one they loaded.
+ */
+struct Registry {
+  Nodes all;     // in the order peers joined
+  Nodes active;  // active peers, highest trust first
+  std::unordered_map<std::string, std::shared_ptr<const Node>> byIp;
+  std::unordered_map<std::string, std::shared_ptr<const Node>> byPublicKey;
+};
+
 void initialize();
 
+// the current snapshot, loaded without taking a lock
+std::shared_ptr<const Registry> registry();
+
 size_t getMaxFaulty();
 Nodes getAllPeerList();
 Nodes getActivePeerList();
@@ -94,9 +110,11 @@ std::vector<std::string> getIpList();
 bool isExistIP(const std::string &);
 bool isExistPublicKey(const std::string &);
 
-Nodes::iterator findPeerIP(const std::string &ip);
-Nodes::iterator findPeerPublicKey(const std::string &publicKey);
-std::shared_ptr<peer::Node> leader();
+// nullptr if there is no such peer
+std::shared_ptr<const Node> findPeerIP(const std::string &ip);
+std::shared_ptr<const Node> findPeerPublicKey(const std::string &publicKey);
+// nullptr if no peer is active
+std::shared_ptr<const Node> leader();
 
 }  // namespace service
 
@@ -117,6 +135,10 @@ namespace executor {
 bool add(const peer::Node &);
 bool remove(const std::string &);
 bool setTrust(const std::string &, const double &);
+// records the score the observer peer measured for the peer, whose trust
+// becomes the median of the scores reported by the current peers
+bool reportTrust(const std::string &observer, const std::string &,
+                 const double &);
 bool changeTrust(const std::string &, const double &);
 bool setActive(const std::string &, const bool active);
 }  // namespace executor
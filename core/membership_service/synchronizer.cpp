@@ -26,14 +26,26 @@ limitations under the License.
 
 #include <infra/config/iroha_config_with_json.hpp>
 
-#include <utils/cache_map.hpp>
-#include <utils/timer.hpp>
 #include <ametsuchi/repository.hpp>
-#include <time.h>
+#include <endpoint_generated.h>
+#include <utils/logger.hpp>
+#include <utils/metrics.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 
 namespace peer{
   namespace sync {
+
+    namespace {
+      // transactions the leader committed that we don't have yet
+      metrics::Gauge& lag = metrics::gauge("iroha_sync_lag_transactions",
+          "Transactions behind the leader, while synchronizing");
+    }
     std::shared_ptr<::peer::Node> leader;
     void startSynchronizeLedger() {
       std::string default_leader_ip = config::IrohaConfigManager::getInstance().getConfigLeaderIp(
@@ -57,16 +69,43 @@ namespace peer{
       if( ::peer::myself::isActive() ) {
         ::peer::myself::stop();
         ::peer::transaction::isssue::setActive(leader->ip,::peer::myself::getIp(),false);
-        detail::appending();
       }
-      seekStartFetchIndex();
+      receiveTransactions();
     }
 
-    void seekStartFetchIndex() { // step3 ( not support )
+    void seekStartFetchIndex() { // step3
+      // tx_store is append only, everything after our last index is missing
+      detail::fetch_from_ = repository::getTransactionCount() + 1;
     }
 
     void receiveTransactions() { // step4;
-      // TODO call fetchStreamTransaction()
+      // the leader keeps committing while we catch up, go until roots match
+      const size_t max_rounds = 8;
+      for( size_t round = 0; round < max_rounds; round++ ) {
+        seekStartFetchIndex();
+        uint64_t height = 0;
+        auto sources = detail::findSources(height);
+        if( sources.empty() ) return;
+
+        const bool behind = height >= detail::fetch_from_;
+        lag.set(behind ? height + 1 - detail::fetch_from_ : 0);
+        if( behind && !detail::catchUp(detail::fetch_from_, height + 1, sources) ) return;
+
+        if( detail::checkRootHashAll() ) {
+          lag.set(0);
+          peerActivateStep();
+          return;
+        }
+
+        // roots differ: resync only from where our ledger left the leader's
+        const size_t common = std::min<uint64_t>(repository::getTransactionCount(), height) + 1;
+        size_t diverged = common;
+        if( !detail::findDivergence(leader->ip, common, diverged) ) return;
+        if( diverged < common ) {
+          logger::warning("sync") << "ledger diverged from the leader at " << diverged;
+          repository::truncate(diverged);
+        }
+      }
     }
 
     void peerActivateStep() { // step5;
@@ -77,13 +116,12 @@ namespace peer{
 
     namespace detail{
 
-      structure::CacheMap<size_t,const iroha::Transaction*> temp_tx_;
-      size_t current_;
-      time_t upd_time_;
+      size_t fetch_from_ = 1;
 
       // if roothash is trust roothash, return true. othrewise return false.
       bool checkRootHashAll(){
-        std::string root_hash = repository::getMerkleRoot();
+        // hex only on the wire, Ping.message is a string
+        std::string root_hash = hash::to_hex(repository::getMerkleRoot());
         std::string myip = ::peer::myself::getPublicKey();
 
         auto vec = flatbuffer_service::endpoint::CreatePing(root_hash,myip);
@@ -92,50 +130,203 @@ namespace peer{
           return true;
         return false;
       }
-      bool append_temporary(size_t tx_id,const iroha::Transaction* tx){
-        temp_tx_.set( tx_id, tx );
+
+      std::vector<Source> findSources(uint64_t& height){
+        using connection::memberShipService::SyncImpl::checkHash::send;
+        auto vec = flatbuffer_service::endpoint::CreatePing(
+            hash::to_hex(repository::getMerkleRoot()), ::peer::myself::getIp());
+        auto &ping = *flatbuffers::GetRoot<::iroha::Ping>(vec.data());
+
+        // the leader decides how far we go
+        if( !send(leader->ip, ping, height) ) return {};
+
+        std::vector<Source> sources{ {leader->ip, height} };
+        for( auto&& peer : ::peer::service::getActivePeerList() ) {
+          if( peer->ip == leader->ip || peer->ip == ::peer::myself::getIp() ) continue;
+          uint64_t peer_height = 0;
+          send(peer->ip, ping, peer_height);
+          if( peer_height >= height ) sources.push_back({peer->ip, peer_height});
+        }
+        return sources;
       }
-      SYNCHRO_RESULT append(){
-        size_t old_current = current_;
-        while( temp_tx_.count(current_) ) {
-          auto &ap_tx = *temp_tx_[current_];
-          repository::append(ap_tx);
-          current_++;
+
+      bool findDivergence(const std::string& ip, size_t to, size_t& index){
+        using connection::memberShipService::SyncImpl::getMerkleNodes::send;
+        index = to;
+        if( to <= 1 ) return true;
+
+        // levels descended per round trip, 2^levels nodes are compared
+        const size_t levels = std::min<size_t>(8, std::max<size_t>(1,
+            config::IrohaConfigManager::getInstance().getSyncDiffLevels(4)));
+
+        size_t level = 0;
+        while( (size_t(1) << level) < to - 1 ) level++;
+
+        std::vector<hash::Hash32> theirs;
+        if( !send(ip, to, level, 0, 1, theirs) ) return false;
+        if( theirs == repository::getMerkleNodes(to, level, 0, 1) ) return true;
+
+        // the root differs, follow the first differing child down to a leaf
+        size_t node = 0;
+        while( level > 0 ) {
+          const size_t down = std::min(levels, level);
+          const size_t first = node << down;
+          const size_t count = size_t(1) << down;
+          level -= down;
+
+          if( !send(ip, to, level, first, count, theirs) ) return false;
+          auto mine = repository::getMerkleNodes(to, level, first, count);
+
+          size_t i = 0;
+          while( i < mine.size() && i < theirs.size() && mine[i] == theirs[i] ) i++;
+          // the parent differed, so must a child
+          if( i == mine.size() || i == theirs.size() ) return false;
+          node = first + i;
         }
-        if( old_current != current_) {
-          if( checkRootHashAll() ) return SYNCHRO_RESULT::APPEND_FINISHED;
+        index = node + 1;
+        return true;
+      }
+
+      namespace {
+        struct Chunk {
+          enum State { PENDING, FETCHING, READY, DONE };
+          uint64_t from, to;
+          State state = PENDING;
+          size_t failures = 0;
+          std::vector<std::vector<uint8_t>> txs;
+        };
+
+        // [from, to) from ip; true if every transaction arrived in order
+        bool fetchChunk(const std::string& ip, uint64_t from, uint64_t to,
+                        std::vector<std::vector<uint8_t>>& txs) {
+          using connection::memberShipService::SyncImpl::fetchStreamTransaction::send;
+          txs.clear();
+          txs.reserve(to - from);
+          bool ok = send(ip, from, to, [&](const ::iroha::TxBatch& batch) {
+            if( batch.index() != from + txs.size() || batch.transactions() == nullptr ) return false;
+            for( const auto& wrapper : *batch.transactions() ) {
+              if( wrapper->tx() == nullptr ) return false;
+              txs.emplace_back(wrapper->tx()->begin(), wrapper->tx()->end());
+            }
+            return txs.size() <= to - from;
+          });
+          return ok && txs.size() == to - from;
         }
-        if( !temp_tx_.empty() ){ // if started downlaoding
-          // if elapsed that tiem is updated more than 2 sec and cache has more than index tx.
-          if( time(NULL) - upd_time_ > 2 && temp_tx_.getMaxKey() > current_ )
-            return SYNCHRO_RESULT::APPEND_ERROR;
+
+        // the root of the chunk must match the one of the verifying source
+        bool verifyChunk(const std::string& ip, uint64_t from, uint64_t to,
+                         const std::vector<std::vector<uint8_t>>& txs) {
+          hash::Hash32 expected;
+          if( !connection::memberShipService::SyncImpl::getRangeRoot::send(
+                  ip, from, to, expected) ) return false;
+          return repository::rangeRootOf(txs) == expected;
         }
-        return SYNCHRO_RESULT::APPEND_ONGOING;
-      }
-      void appending(){
-        clearCache();
-
-        while( !::peer::myself::isActive() ) {
-          timer::waitTimer(1000);
-          switch( append() ) {
-            case SYNCHRO_RESULT::APPEND_ERROR:
-              checkRootHashAll();
-              return;
-            case SYNCHRO_RESULT::APPEND_FINISHED:
-              peerActivateStep();
-              return;
-            case SYNCHRO_RESULT::APPEND_ONGOING:
+      }  // namespace
+
+      bool catchUp(uint64_t from, uint64_t to, const std::vector<Source>& sources){
+        const uint64_t chunk_size = std::max<size_t>(
+            1, config::IrohaConfigManager::getInstance().getSyncChunkSize(1024));
+        // chunks fetched but not appended yet, bounds the memory in use
+        const size_t window = 2 * sources.size();
+        // a source that failed this many chunks in a row is dropped
+        const size_t max_strikes = 3;
+
+        std::vector<Chunk> chunks;
+        for( uint64_t i = from; i < to; i += chunk_size ) {
+          chunks.emplace_back();
+          chunks.back().from = i;
+          chunks.back().to = std::min(to, i + chunk_size);
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t applied = 0;
+        size_t alive = sources.size();
+        bool abort = false;
+
+        auto worker = [&](size_t k) {
+          const auto& ip = sources[k].ip;
+          // chunks of the others are checked against the leader's root, the
+          // leader's against another source, or trusted if it is alone: the
+          // root of the whole ledger is compared with the leader's after all
+          const std::string verifier = k != 0 ? sources[0].ip
+              : sources.size() > 1 ? sources[1].ip : "";
+          size_t strikes = 0;
+
+          std::unique_lock<std::mutex> lock(mutex);
+          // until every chunk is appended, a chunk failing elsewhere may
+          // come back to PENDING and be taken over here
+          while( !abort && applied < chunks.size() && strikes < max_strikes ) {
+            auto it = std::find_if(chunks.begin() + applied, chunks.end(),
+                [](const Chunk& c) { return c.state == Chunk::PENDING; });
+            if( it == chunks.end() ||
+                static_cast<size_t>(it - chunks.begin()) >= applied + window ) {
+              cv.wait(lock);
+              continue;
+            }
+
+            auto& chunk = *it;
+            chunk.state = Chunk::FETCHING;
+            lock.unlock();
+
+            std::vector<std::vector<uint8_t>> txs;
+            bool ok = fetchChunk(ip, chunk.from, chunk.to, txs) &&
+                      (verifier.empty() ||
+                       verifyChunk(verifier, chunk.from, chunk.to, txs));
+
+            lock.lock();
+            if( ok ) {
+              chunk.txs = std::move(txs);
+              chunk.state = Chunk::READY;
+              strikes = 0;
+            } else {
+              logger::warning("sync") << "chunk [" << chunk.from << ", " << chunk.to
+                                      << ") from " << ip << " failed";
+              chunk.state = Chunk::PENDING;
+              strikes++;
+              if( ++chunk.failures > max_strikes * sources.size() ) abort = true;
+            }
+            cv.notify_all();
+          }
+          alive--;
+          cv.notify_all();
+        };
+
+        std::vector<std::thread> workers;
+        for( size_t k = 0; k < sources.size(); k++ ) workers.emplace_back(worker, k);
+
+        // append in order as soon as the next chunk is there
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          while( applied < chunks.size() ) {
+            cv.wait(lock, [&] {
+              return abort || alive == 0 || chunks[applied].state == Chunk::READY;
+            });
+            if( chunks[applied].state != Chunk::READY ) {
+              abort = true;
               break;
+            }
+
+            auto txs = std::move(chunks[applied].txs);
+            lock.unlock();
+            repository::appendBatch(txs);
+            lock.lock();
+
+            fetch_from_ = chunks[applied].to;
+            chunks[applied].state = Chunk::DONE;
+            applied++;
+            cv.notify_all();
           }
         }
+        cv.notify_all();
+        for( auto& w : workers ) w.join();
 
-      }
-      void clearCache(){
-        current_ = 0;
-        temp_tx_.clear();
+        logger::info("sync") << "appended [" << from << ", " << fetch_from_ << ") from "
+                             << sources.size() << " peers";
+        return !abort;
       }
     } // namespace datail
 
 
   } // namespace sync
-} // namespace peer
\ No newline at end of file
+} // namespace peer
@@ -21,9 +21,9 @@ limitations under the License.
 #ifndef IROHA_SYNCHRONIZER_H
 #define IROHA_SYNCHRONIZER_H
 
-#include <transaction_generated.h>
-#include <utils/cache_map.hpp>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace peer{
   namespace sync{
@@ -32,24 +32,36 @@ namespace peer{
     void startSynchronizeLedger();
     void checkRootHashStep(); // step1
     void peerStopStep(); // step2
-    void seekStartFetchIndex(); // step3 ( not support )
+    void seekStartFetchIndex(); // step3
     void receiveTransactions(); // step4;
     void peerActivateStep(); // step5;
 
-    enum SYNCHRO_RESULT {
-      APPEND_ONGOING,
-      APPEND_ERROR,
-      APPEND_FINISHED,
-    };
-
     namespace detail{
+      // next index to fetch, set by seekStartFetchIndex()
+      extern size_t fetch_from_;
+
       // if roothash is trust roothash, return true. othrewise return false.
       bool checkRootHashAll();
 
-      bool append_temporary(size_t,const iroha::Transaction*);
-      SYNCHRO_RESULT append();
-      void appending();
-      void clearCache();
+      struct Source {
+        std::string ip;
+        uint64_t height;  // index of its last committed transaction
+      };
+
+      // leader and every active peer at least as far as it, leader first;
+      // height is set to the leader's height
+      std::vector<Source> findSources(uint64_t& height);
+
+      // splits [from, to) in chunks, fetches them from sources in parallel,
+      // checks each one against the merkle root the leader, sources[0],
+      // has for it, and appends them in order. A failed chunk is fetched
+      // again by any source. false if the range could not be completed.
+      bool catchUp(uint64_t from, uint64_t to, const std::vector<Source>& sources);
+
+      // first index in [1, to) where our transaction differs from the one of
+      // ip, or to if there is none. Compares merkle nodes top down, a few
+      // levels per round trip. false if ip did not answer consistently.
+      bool findDivergence(const std::string& ip, size_t to, size_t& index);
     } // namespace datail
 
   } // namespace sync
@@ -0,0 +1,268 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+                 http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "executor.hpp"
+#include "validator.hpp"
+#include <ametsuchi/repository.hpp>
+#include <infra/config/iroha_config_with_json.hpp>
+#include <utils/logger.hpp>
+#include <utils/tracing.hpp>
+#include <commands_generated.h>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+namespace runtime {
+    namespace executor {
+
+        static size_t threadsCount() {
+            // "concurrency": 0 in config.json means one thread per core
+            auto count = config::IrohaConfigManager::getInstance().getConcurrency(0);
+            return count != 0 ? count : std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // built on the first block, not while statics are initialized
+        static ThreadPool& pool() {
+            static ThreadPool pool(ThreadPoolOptions{
+                .threads_count = threadsCount(),
+                .worker_queue_size =
+                    config::IrohaConfigManager::getInstance().getPoolWorkerQueueSize(1024),
+            });
+            return pool;
+        }
+
+        namespace detail {
+
+            std::string accountKey(const flatbuffers::String* pubKey) {
+                return "account/" + (pubKey == nullptr ? "" : pubKey->str());
+            }
+
+            std::string peerKey(const flatbuffers::String* pubKey) {
+                return "peer/" + (pubKey == nullptr ? "" : pubKey->str());
+            }
+
+            std::string assetKey(
+                const flatbuffers::String* ledger,
+                const flatbuffers::String* domain,
+                const flatbuffers::String* name
+            ) {
+                return "asset/" + ledger->str() + "/" + domain->str() + "/" + name->str();
+            }
+
+            std::string assetKey(const iroha::Asset* asset) {
+                switch (asset->asset_type()) {
+                    case iroha::AnyAsset::ComplexAsset: {
+                        auto a = asset->asset_as_ComplexAsset();
+                        return assetKey(a->ledger_name(), a->domain_name(), a->asset_name());
+                    }
+                    case iroha::AnyAsset::Currency: {
+                        auto a = asset->asset_as_Currency();
+                        return assetKey(a->ledger_name(), a->domain_name(), a->currency_name());
+                    }
+                    case iroha::AnyAsset::NONE: break;
+                }
+                return "asset/";
+            }
+
+            // the creator has to exist, but an account may add itself
+            bool creatorExists(const iroha::Transaction& tx, bool uncommitted) {
+                if (tx.command_type() == iroha::Command::AccountAdd) {
+                    auto account = tx.command_as_AccountAdd()->account_nested_root();
+                    if (account->pubKey() != nullptr &&
+                        account->pubKey()->str() == tx.creatorPubKey()->str()) {
+                        return true;
+                    }
+                }
+                return validator::account_exist_validator(*tx.creatorPubKey(), uncommitted);
+            }
+
+            bool validate(const iroha::Transaction& tx, bool uncommitted) {
+                return creatorExists(tx, uncommitted) &&
+                       validator::permission_validator(tx, uncommitted) &&
+                       validator::logic_validator(tx, uncommitted);
+            }
+
+        };
+
+        AccessSet accessSetOf(const iroha::Transaction& tx) {
+            AccessSet set;
+            // every validator looks the creator up
+            set.reads.insert(detail::accountKey(tx.creatorPubKey()));
+
+            switch (tx.command_type()) {
+                case iroha::Command::Add: {
+                    auto cmd = tx.command_as_Add();
+                    set.reads.insert(detail::assetKey(cmd->asset_nested_root()));
+                    set.writes.insert(detail::accountKey(cmd->accPubKey()));
+                } break;
+                case iroha::Command::Subtract: {
+                    auto cmd = tx.command_as_Subtract();
+                    set.reads.insert(detail::assetKey(cmd->asset_nested_root()));
+                    set.writes.insert(detail::accountKey(cmd->accPubKey()));
+                } break;
+                case iroha::Command::Transfer: {
+                    auto cmd = tx.command_as_Transfer();
+                    set.reads.insert(detail::assetKey(cmd->asset_nested_root()));
+                    set.writes.insert(detail::accountKey(cmd->sender()));
+                    set.writes.insert(detail::accountKey(cmd->receiver()));
+                } break;
+                case iroha::Command::AssetCreate: {
+                    auto cmd = tx.command_as_AssetCreate();
+                    set.writes.insert(detail::assetKey(
+                        cmd->ledger_name(), cmd->domain_name(), cmd->asset_name()));
+                } break;
+                case iroha::Command::AssetRemove: {
+                    auto cmd = tx.command_as_AssetRemove();
+                    set.writes.insert(detail::assetKey(
+                        cmd->ledger_name(), cmd->domain_name(), cmd->asset_name()));
+                } break;
+                case iroha::Command::AccountAdd: {
+                    auto account = tx.command_as_AccountAdd()->account_nested_root();
+                    set.writes.insert(detail::accountKey(account->pubKey()));
+                } break;
+                case iroha::Command::AccountRemove: {
+                    set.writes.insert(detail::accountKey(
+                        tx.command_as_AccountRemove()->pubkey()));
+                } break;
+                case iroha::Command::PeerAdd: {
+                    auto peer = tx.command_as_PeerAdd()->peer_nested_root();
+                    set.writes.insert(detail::peerKey(peer->publicKey()));
+                } break;
+                case iroha::Command::PeerRemove: {
+                    set.writes.insert(detail::peerKey(
+                        tx.command_as_PeerRemove()->peerPubKey()));
+                } break;
+                case iroha::Command::PeerSetActive: {
+                    set.writes.insert(detail::peerKey(
+                        tx.command_as_PeerSetActive()->peerPubKey()));
+                } break;
+                case iroha::Command::PeerSetTrust: {
+                    set.writes.insert(detail::peerKey(
+                        tx.command_as_PeerSetTrust()->peerPubKey()));
+                } break;
+                case iroha::Command::PeerChangeTrust: {
+                    set.writes.insert(detail::peerKey(
+                        tx.command_as_PeerChangeTrust()->peerPubKey()));
+                } break;
+                case iroha::Command::PermissionAdd: {
+                    auto target = tx.command_as_PermissionAdd()->targetAccount();
+                    if (target == nullptr) set.global = true;
+                    else set.writes.insert(detail::accountKey(target));
+                } break;
+                case iroha::Command::PermissionRemove: {
+                    auto target = tx.command_as_PermissionRemove()->targetAccount();
+                    if (target == nullptr) set.global = true;
+                    else set.writes.insert(detail::accountKey(target));
+                } break;
+                default:
+                    set.global = true;
+                    break;
+            }
+            return set;
+        }
+
+        std::vector<bool> findConflicts(const std::vector<AccessSet>& sets) {
+            std::vector<bool> conflicts(sets.size(), false);
+            std::unordered_set<std::string> written;
+            bool globalWritten = false;
+
+            for (size_t i = 0; i < sets.size(); i++) {
+                const auto& set = sets[i];
+                if (globalWritten || (set.global && !written.empty())) {
+                    conflicts[i] = true;
+                } else {
+                    for (const auto& key : set.reads) {
+                        if (written.count(key)) {
+                            conflicts[i] = true;
+                            break;
+                        }
+                    }
+                }
+                written.insert(set.writes.begin(), set.writes.end());
+                globalWritten |= set.global;
+            }
+            return conflicts;
+        }
+
+        std::vector<bool> processBlock(
+            const std::vector<const iroha::Transaction*>& block
+        ) {
+            // 1. speculative validation against the committed WSV; every
+            // read opens a read-only transaction of its own, the append
+            // transaction belongs to the writer thread of the repository
+            tracing::Span validating("runtime.validate");
+            std::vector<AccessSet> sets(block.size());
+            std::vector<std::future<bool>> verdicts;
+            verdicts.reserve(block.size());
+            for (size_t i = 0; i < block.size(); i++) {
+                auto task = std::make_shared<std::packaged_task<bool()>>(
+                    [tx = block[i], access = &sets[i]] {
+                        *access = accessSetOf(*tx);
+                        return detail::validate(*tx, false);
+                    });
+                verdicts.push_back(task->get_future());
+                try {
+                    pool().process([task] { (*task)(); });
+                } catch (const std::runtime_error& e) {
+                    // the queue is full: validate it here instead
+                    logger::debug("executor") << "validating inline: " << e.what();
+                    (*task)();
+                }
+            }
+
+            std::vector<bool> result(block.size());
+            for (size_t i = 0; i < block.size(); i++) {
+                result[i] = verdicts[i].get();
+            }
+            validating.end();
+
+            // 2. apply in block order, re-executing stale speculations
+            // against what the block appended before them; the synchronizer
+            // can not append between them
+            tracing::Span applying("runtime.apply");
+            const auto conflicts = findConflicts(sets);
+            size_t appended = 0;
+            repository::write([&] {
+                for (size_t i = 0; i < block.size(); i++) {
+                    if (conflicts[i]) {
+                        result[i] = detail::validate(*block[i], true);
+                    }
+                    if (!result[i]) {
+                        logger::info("executor") << "reject transaction " << i
+                                                 << " of the block";
+                        continue;
+                    }
+                    repository::append(*block[i]);
+                    appended++;
+                }
+                // the next block speculates on this one
+                repository::commit();
+            });
+
+            logger::debug("executor") << "appended " << appended << " of "
+                                      << block.size() << " transactions, "
+                                      << std::count(conflicts.begin(), conflicts.end(), true)
+                                      << " re-executed";
+            return result;
+        }
+
+    };
+};
@@ -0,0 +1,63 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+                 http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef __CORE_RUNTIME_EXECUTOR_HPP__
+#define __CORE_RUNTIME_EXECUTOR_HPP__
+
+#include <transaction_generated.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+namespace runtime {
+    namespace executor {
+
+        /**
+         * WSV keys a transaction reads and writes.
+         * Keys are "account/<pubKey>", "asset/<ledger>/<domain>/<name>"
+         * and "peer/<pubKey>". Commands we can't key (chaincode, multisig,
+         * permission changes without a target account) set `global`
+         * and are ordered against every other transaction in the block.
+         */
+        struct AccessSet {
+            std::set<std::string> reads;
+            std::set<std::string> writes;
+            bool global = false;
+        };
+
+        AccessSet accessSetOf(const iroha::Transaction& tx);
+
+        /**
+         * Marks transactions whose read set overlaps the write set of an
+         * earlier transaction in the same block.
+         */
+        std::vector<bool> findConflicts(const std::vector<AccessSet>& sets);
+
+        /**
+         * Runs the validators of all transactions in parallel against the
+         * committed WSV, then appends the valid ones in block order and
+         * commits the block. Rejected transactions are not appended.
+         * Conflicting transactions are validated again, serially, once
+         * every transaction before them has been appended.
+         * @return verdict of the validators for each transaction
+         */
+        std::vector<bool> processBlock(
+            const std::vector<const iroha::Transaction*>& block);
+    };
+};
+
+#endif
@@ -14,26 +14,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "runtime.hpp"
-#include "validator.hpp"
-#include <ametsuchi/repository.hpp>
-
-#include <infra/ametsuchi/include/ametsuchi/ametsuchi.h>
+#include "executor.hpp"
 
 namespace runtime{
 
     void processTransaction(const iroha::Transaction& tx){
-        if(!validator::account_exist_validator(*tx.creatorPubKey())){
-            // Reject
-            //return;
-        }
-        if(!validator::permission_validator(tx)){
-            // Reject
-        }
-        if(!validator::logic_validator(tx)){
-            // Reject
-        }
-        repository::append(tx);
-      std::cout << "APPENDED\n";
+        executor::processBlock({&tx});
+    }
+
+    std::vector<bool> processBlock(const std::vector<const iroha::Transaction*>& txs){
+        return executor::processBlock(txs);
     }
 
 };
\ No newline at end of file
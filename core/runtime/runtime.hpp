@@ -20,10 +20,16 @@ limitations under the License.
 #include <main_generated.h>
 #include "command/add.hpp"
 
+#include <vector>
+
 namespace runtime{
 
     void processTransaction(const iroha::Transaction& tx);
 
+    // Validates transactions in parallel and appends them in the given order.
+    // Returns whether each transaction was appended.
+    std::vector<bool> processBlock(const std::vector<const iroha::Transaction*>& txs);
+
 };
 
 #endif //IROHA_RUNTIME_HPP
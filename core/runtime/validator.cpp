@@ -24,35 +24,30 @@ limitations under the License.
 namespace runtime {
     namespace validator {
 
-        bool account_exist_validator(const flatbuffers::String &publicKey){
-            return repository::existAccountOf(publicKey);
+        bool account_exist_validator(const flatbuffers::String &publicKey,
+                                     bool uncommitted){
+            return repository::existAccountOf(publicKey, uncommitted);
         }
 
         auto prev_validator = [](
             const flatbuffers::String& publicKey,
             const flatbuffers::String& target_ledger,
             const flatbuffers::String& target_domain,
-            const flatbuffers::String& target_asset
-        ) -> std::function<bool(const ::iroha::Command)> {
-            auto asset_permissions  = repository::permission::getPermissionAssetOf(publicKey);
-            for(const iroha::AccountPermissionAsset* ap: asset_permissions) {
-                if (
-                    ap->asset_name()->str()  == target_asset.str() &&
-                    ap->domain_name()->str() == target_domain.str() &&
-                    ap->ledger_name()->str() == target_ledger.str()
-                ){
-                    return [=](const iroha::Command c) -> bool{
-                        return (ap->read()  && (
-                            (ap->transfer() && iroha::Command::Transfer == c ) ||
-                            (ap->add()      && iroha::Command::Add == c ) ||
-                            (ap->subtract() && iroha::Command::Subtract == c )
-                        ));
-                    };
-                }
+            const flatbuffers::String& target_asset,
+            const iroha::Command c,
+            bool uncommitted
+        ) -> bool {
+            using namespace ametsuchi::permission;
+            const uint8_t capabilities = repository::permission::getAssetCapabilitiesOf(
+                publicKey, target_ledger, target_domain, target_asset, uncommitted
+            );
+            if (!(capabilities & READ)) return false;
+            switch (c) {
+                case iroha::Command::Transfer: return capabilities & TRANSFER;
+                case iroha::Command::Add:      return capabilities & ADD;
+                case iroha::Command::Subtract: return capabilities & SUBTRACT;
+                default:                       return false;
             }
-            return [](const iroha::Command c) -> bool{
-                return false;
-            };
         };
 
         auto getUrlFromAsse = [](const iroha::Asset* asset) ->
@@ -80,7 +75,7 @@ namespace runtime {
             }
         };
 
-        bool permission_validator(const iroha::Transaction& tx){
+        bool permission_validator(const iroha::Transaction& tx, bool uncommitted){
             const flatbuffers::String* ledger_name = nullptr;
             const flatbuffers::String* domain_name = nullptr;
             const flatbuffers::String* asset_name  = nullptr;
@@ -91,11 +86,11 @@ namespace runtime {
                 }break;
                 case iroha::Command::Subtract: {
                     std::tie(ledger_name,domain_name,asset_name) =
-                        getUrlFromAsse(tx.command_as_Add()->asset_nested_root());
+                        getUrlFromAsse(tx.command_as_Subtract()->asset_nested_root());
                 }break;
                 case iroha::Command::Transfer: {
                     std::tie(ledger_name,domain_name,asset_name) =
-                        getUrlFromAsse(tx.command_as_Add()->asset_nested_root());
+                        getUrlFromAsse(tx.command_as_Transfer()->asset_nested_root());
                 }break;
                 case iroha::Command::AssetCreate:           return true;
                 case iroha::Command::AssetRemove:           return true;
@@ -127,12 +122,14 @@ namespace runtime {
                 *tx.creatorPubKey(),
                 *ledger_name,
                 *domain_name,
-                *asset_name
-            )(tx.command_type());
+                *asset_name,
+                tx.command_type(),
+                uncommitted
+            );
         }
 
-        bool logic_validator(const iroha::Transaction &tx){
-
+        bool logic_validator(const iroha::Transaction &tx, bool /* uncommitted */){
+            return true;
         }
 
     };
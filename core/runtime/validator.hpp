@@ -22,11 +22,19 @@ limitations under the License.
 namespace runtime {
     namespace validator {
 
-        bool account_exist_validator(const flatbuffers::String &publicKey);
-
-        bool permission_validator(const iroha::Transaction &tx);
-
-        bool logic_validator(const iroha::Transaction &tx);
+        /*
+         * uncommitted: validate against the WSV with the transactions
+         * appended so far, on the writer thread; otherwise against the
+         * committed WSV, from any thread.
+         */
+        bool account_exist_validator(const flatbuffers::String &publicKey,
+                                     bool uncommitted = false);
+
+        bool permission_validator(const iroha::Transaction &tx,
+                                  bool uncommitted = false);
+
+        bool logic_validator(const iroha::Transaction &tx,
+                             bool uncommitted = false);
     };
 };
 
@@ -14,6 +14,7 @@ limitations under the License.
 #ifndef __CONNECTION__
 #define __CONNECTION__
 
+#include <crypto/hash.hpp>
 #include <utils/expected.hpp>
 
 #include <main_generated.h>
@@ -22,11 +23,15 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace iroha {
   struct Transaction;
   struct ConsensusEvent;
   struct Ping;
+  struct TxBatch;
+  struct AssetQuery;
+  struct TransactionBatch;
 }  // namespace iroha
 
 namespace flatbuffers {
@@ -53,6 +58,22 @@ namespace iroha {
 
     bool send(const std::string& ip, const ::iroha::ConsensusEvent& msg);
     bool sendAll(const ::iroha::ConsensusEvent& msg);
+
+    /**
+     * Children of peer in the relay tree of a broadcast from origin.
+     * peers (in validator order) is rotated so that origin comes first,
+     * then the peer at position i forwards to positions i*fanout+1 ..
+     * i*fanout+fanout.
+     */
+    std::vector<std::string> relayChildren(const std::vector<std::string>& peers,
+                                           const std::string& origin,
+                                           const std::string& peer, size_t fanout);
+    /**
+     * The validator order sumeragi uses, which sendAll and the relay build
+     * the tree from; it differs from the config after a reload or a trust
+     * reorder. Until it is set, the config order is used.
+     */
+    void setRelayOrder(std::vector<std::string> ips);
     void receive(Verify::CallBackFunc&& callback);
 
     }  // namespace Verify
@@ -81,14 +102,38 @@ namespace iroha {
     }
     }*/
     }  // namespace Torii
+
+    namespace ToriiBatch {
+      // the code of each transaction of the batch, in order
+      using CallBackFunc = std::function<std::vector<::iroha::Code>(
+          const std::string& /* from */, const ::iroha::TransactionBatch& /* batch */)>;
+      void receive(ToriiBatch::CallBackFunc&& callback);
+    }  // namespace ToriiBatch
+
+    namespace Publish {
+      // keeps the published transaction bodies, returns how many it holds
+      using CallBackFunc = std::function<size_t(
+          const std::string& /* from */, const ::iroha::TransactionBatch& /* bodies */)>;
+      void receive(Publish::CallBackFunc&& callback);
+    }  // namespace Publish
+
+    namespace FetchPayload {
+      // the body of each digest in order, empty when unknown
+      using CallBackFunc = std::function<std::vector<std::vector<uint8_t>>(
+          const std::string& /* from */, const std::vector<hash::Hash32>& /* digests */)>;
+      void receive(FetchPayload::CallBackFunc&& callback);
+    }  // namespace FetchPayload
   }  // namespace SumeragiImpl
 }  // namespace iroha
 
 namespace iroha {
   namespace AssetRepositoryImpl {
     namespace AccountGetAsset {
-      using CallBackFunc = std::function<std::vector<const ::iroha::Asset*>(
-          const std::string& /* from */, flatbuffers::unique_ptr_t&& /* message */)>;
+      // called once per matching asset with its stored flatbuffer
+      using AssetVisitor = std::function<void(const uint8_t* /* data */, size_t /* size */)>;
+      using CallBackFunc = std::function<void(
+          const std::string& /* from */, const ::iroha::AssetQuery& /* query */,
+          const AssetVisitor& /* visit */)>;
 
       void receive(AccountGetAsset::CallBackFunc&& callback);
     }  // namespace AccountGetAsset
@@ -108,6 +153,22 @@ namespace SumeragiImpl {
 namespace Torii {
 bool send(const std::string& ip, const ::iroha::Transaction& tx);
 }  // namespace Torii
+namespace Publish {
+// true once the peer acknowledged holding every body within a second
+bool send(const std::string& ip, const std::vector<std::vector<uint8_t>>& bodies);
+}  // namespace Publish
+namespace FetchPayload {
+// bodies receives the body of each digest, empty when the peer lacks it;
+// false if the peer does not answer within a second
+bool send(const std::string& ip, const std::vector<hash::Hash32>& digests,
+          std::vector<std::vector<uint8_t>>& bodies);
+}  // namespace FetchPayload
+namespace ToriiBatch {
+// codes receives the status of each transaction, in order
+bool send(const std::string& ip,
+          const std::vector<const ::iroha::Transaction*>& txs,
+          std::vector<::iroha::Code>& codes);
+}  // namespace ToriiBatch
 }  // namespace SumeragiImpl
 
 /************************************************************************************
@@ -116,6 +177,8 @@ bool send(const std::string& ip, const ::iroha::Transaction& tx);
 namespace SyncImpl {
 namespace checkHash {
 bool send(const std::string& ip, const ::iroha::Ping& ping);
+// height - index of the last transaction committed by ip
+bool send(const std::string& ip, const ::iroha::Ping& ping, uint64_t& height);
 }  // namespace checkHash
 namespace getPeers {
 bool send(const std::string& ip, const ::iroha::Ping& ping);
@@ -127,6 +190,25 @@ using CallBackFunc = std::function<std::vector<const ::iroha::Transaction*>(
 void receive(getTransactions::CallBackFunc&& callback);
 bool send(const std::string& ip, const ::iroha::Ping& ping);
 }  // namespace getTransactions
+namespace fetchStreamTransaction {
+// return false to stop the stream
+using CallBackFunc = std::function<bool(const ::iroha::TxBatch&)>;
+
+// streams committed transactions [from, to) from ip, to == 0 means up to last
+bool send(const std::string& ip, uint64_t from, uint64_t to,
+          CallBackFunc&& callback);
+}  // namespace fetchStreamTransaction
+namespace getRangeRoot {
+// merkle root of transactions [from, to) committed by ip
+bool send(const std::string& ip, uint64_t from, uint64_t to,
+          hash::Hash32& root);
+}  // namespace getRangeRoot
+namespace getMerkleNodes {
+// nodes [first, first + count) of level of the merkle tree over transactions
+// [1, to) committed by ip, see repository::getMerkleNodes
+bool send(const std::string& ip, uint64_t to, uint32_t level, uint64_t first,
+          uint32_t count, std::vector<hash::Hash32>& nodes);
+}  // namespace getMerkleNodes
 }  // namespace SyncImpl
 }  // namespace memberShipService
 
@@ -40,6 +40,10 @@ namespace peer {
 struct Node;
 }
 
+namespace hash {
+class Sha3_256;
+}
+
 namespace flatbuffers {
 template <class T>
 class Offset;
@@ -97,6 +101,37 @@ namespace flatbuffer_service {
   Expected<flatbuffers::unique_ptr_t> makeCommit(
     const iroha::ConsensusEvent &event);
 
+  /**
+   * toDigestEvent(event)
+   * - same event with the sha3-256 of each transaction in digests and
+   *   no transaction bodies.
+   */
+  Expected<flatbuffers::unique_ptr_t> toDigestEvent(
+    const iroha::ConsensusEvent &event);
+
+  /**
+   * fromDigestEvent(event, bodies)
+   * - puts bodies[i], the transaction of the i-th digest, back into the
+   *   event. Fails when the count or a digest does not match.
+   */
+  Expected<flatbuffers::unique_ptr_t> fromDigestEvent(
+    const iroha::ConsensusEvent &event,
+    const std::vector<std::vector<uint8_t>> &bodies);
+
+  /**
+   * withTrace(event, trace)
+   * - same event continuing the given trace, see utils/tracing.hpp
+   */
+  Expected<flatbuffers::unique_ptr_t> withTrace(
+    const iroha::ConsensusEvent &event, const iroha::TraceContext &trace);
+
+  /**
+   * withHeight(event, height)
+   * - same event proposed at the given ledger height
+   */
+  Expected<flatbuffers::unique_ptr_t> withHeight(
+    const iroha::ConsensusEvent &event, uint64_t height);
+
   namespace peer {  // namespace peer
 
     flatbuffers::Offset<PeerAdd> CreateAdd(flatbuffers::FlatBufferBuilder &fbb, const ::peer::Node &peer);
@@ -171,6 +206,13 @@ namespace flatbuffer_service {
       const flatbuffers::Offset<void>& command,
       flatbuffers::Offset<iroha::Attachment> attachment
     );
+
+    /**
+     * Absorbs creatorPubKey, timestamp, command and attachment of tx into
+     * sha in a canonical binary form, read straight from the flatbuffer.
+     * Signatures and the hash field are not part of it.
+     */
+    void absorbSignedFields(hash::Sha3_256 &sha, const iroha::Transaction &tx);
   }
 
   namespace endpoint {
@@ -142,6 +142,9 @@ InvalidMessageLengthException::InvalidMessageLengthException(
     const std::string &message)
     : Insecure("Message " + message + " has wrong length") {}
 
+InvalidBase64Exception::InvalidBase64Exception(const std::string &message)
+    : Insecure("Base64 input is invalid, cause is: " + message) {}
+
 }  // namespace crypto
 
 }  // namespace exception
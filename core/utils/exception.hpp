@@ -176,6 +176,11 @@ class InvalidMessageLengthException : public Insecure {
   explicit InvalidMessageLengthException(const std::string &);
 };
 
+class InvalidBase64Exception : public Insecure {
+ public:
+  explicit InvalidBase64Exception(const std::string &);
+};
+
 }  // namespace crypto
 }  // namespace exception
 
@@ -7,22 +7,46 @@
 
 #include <utils/logger.hpp>
 #include <iomanip>
+#include <sstream>
 #include <string>
+#include <utility>
 namespace explore {
 
     namespace sumeragi{
 
+        namespace detail {
+            template <typename Line>
+            inline void append(Line&) {}
+
+            template <typename Line, typename T, typename... Rest>
+            inline void append(Line& line, T&& t, Rest&&... rest) {
+                line << std::forward<T>(t);
+                append(line, std::forward<Rest>(rest)...);
+            }
+        }
+
         struct PrintProgress {
             int MAX;
             PrintProgress():MAX(100){};
 
-            void print(int progressNum, std::string &&msg) {
-                logger::explore("sumeragi") << "\033[95m+| " << std::setw(3) << progressNum / MAX << "|+\033[0m" << msg;
+            // the parts of msg are streamed one after another, nothing is
+            // built if explore is off
+            template <typename... Msg>
+            void print(int progressNum, Msg&&... msg) {
+                if (!logger::enabled(logger::LogLevel::Explore)) return;
+                auto&& line = logger::explore("sumeragi");
+                line << "\033[95m+| " << std::setw(3) << progressNum / MAX << "|+\033[0m";
+                detail::append(line, std::forward<Msg>(msg)...);
             }
         };
 
-        inline void printInfo(std::string&& msg){
-            logger::explore("sumeragi") << "\x1b[36m " << msg << " \033[0m";
+        template <typename... Msg>
+        inline void printInfo(Msg&&... msg){
+            if (!logger::enabled(logger::LogLevel::Explore)) return;
+            auto&& line = logger::explore("sumeragi");
+            line << "\x1b[36m ";
+            detail::append(line, std::forward<Msg>(msg)...);
+            line << " \033[0m";
         }
 
         inline void initialize(){
@@ -40,6 +64,7 @@ namespace explore {
         }
 
         inline void printJudge(int numValidSignatures, int numValidationPeer, int faulty) {
+            if (!logger::enabled(logger::LogLevel::Explore)) return;
             std::stringstream resLine[5];
             for (int i = 0; i < numValidationPeer; i++) {
                 if (i < numValidSignatures) {
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <iostream>
 #include <regex>
+#include <vector>
 
 namespace ip_tools {
 
@@ -17,115 +17,316 @@ limitations under the License.
 #include "logger.hpp"
 #include "datetime.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <string>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace logger {
 
 //enum class LogLevel { Debug = 0, Explore, Info, Warning, Error, Fatal };
-static const std::string level_names[]{
+static const char *level_names[]{
     "DEBUG", "EXPLORE", "INFO", "WARNING", "ERROR (-A-)", "FATAL (`o')"};
 
 namespace detail {
-  LogLevel LOG_LEVEL = LogLevel::Debug;
-}
 
-void setLogLevel(LogLevel lv) {
-  detail::LOG_LEVEL = lv;
-  spdlog::set_level((spdlog::level::level_enum)lv);
+std::atomic<int> LOG_LEVEL{static_cast<int>(LogLevel::Debug)};
+
+const size_t textSize = 1024;
+
+// writes into a fixed buffer, what doesn't fit is dropped
+class fixed_buf : public std::streambuf {
+ public:
+  void reset(char *begin, size_t size) { setp(begin, begin + size); }
+  size_t size() const { return pptr() - pbase(); }
+};
+
+struct line {
+  line() : stream(&buf) {}
+
+  std::uint64_t time;
+  LogLevel level;
+  std::string caller;
+  char text[textSize];
+  fixed_buf buf;
+  std::ostream stream;
+  bool busy = false;
+};
+
+// "<unixtime> <level> [<caller>] <text>\n", as datetime::unixtime_str()
+// prints the time; out keeps its capacity from line to line
+void render(std::string &out, std::uint64_t time, LogLevel level,
+            const std::string &caller, const char *text, size_t textLength) {
+  char number[24];
+  std::snprintf(number, sizeof(number), "%llu",
+                static_cast<unsigned long long>(time));
+  out.clear();
+  out += number;
+  if (level != LogLevel::Explore) {
+    out += ' ';
+    out += level_names[static_cast<int>(level)];
+  }
+  out += " [";
+  out += caller;
+  out += "] ";
+  out.append(text, textLength);
+  out += '\n';
 }
 
-class console_sink : public spdlog::sinks::base_sink<std::mutex> {
-  using MyType = console_sink;
+void write(const std::string &rendered, LogLevel level) {
+  auto output = LogLevel::Error <= level ? stderr : stdout;
+  fwrite(rendered.data(), sizeof(char), rendered.size(), output);
+}
 
+/**
+ * Bounded multi-producer queue of lines (D. Vyukov's array queue): a
+ * producer claims a slot with one CAS and publishes it with its sequence.
+ */
+class ring {
  public:
-  console_sink() {}
-  static std::shared_ptr<MyType> instance() {
-    static std::shared_ptr<MyType> instance = std::make_shared<MyType>();
-    return instance;
+  struct slot {
+    std::atomic<size_t> sequence;
+    std::uint64_t time;
+    LogLevel level;
+    // grows to the longest caller seen in this slot, then stays
+    std::string caller;
+    size_t textLength;
+    char text[textSize];
+  };
+
+  explicit ring(size_t capacity)
+      : slots_(new slot[capacity]), mask_(capacity - 1) {
+    for (size_t i = 0; i < capacity; i++) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
   }
 
-  void _sink_it(const spdlog::details::log_msg &msg) override {
-    auto output =
-        static_cast<int>(LogLevel::Error) <= msg.level ? stderr : stdout;
-    fwrite(msg.formatted.data(), sizeof(char), msg.formatted.size(), output);
-    fflush(output);
+  bool push(const line &l, size_t textLength) {
+    auto pos = tail_.load(std::memory_order_relaxed);
+    slot *s;
+    while (true) {
+      s = &slots_[pos & mask_];
+      auto seq = s->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;  // full
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    s->time = l.time;
+    s->level = l.level;
+    s->caller = l.caller;
+    s->textLength = textLength;
+    std::memcpy(s->text, l.text, textLength);
+    s->sequence.store(pos + 1, std::memory_order_release);
+    return true;
   }
 
-  void flush() override {
-    fflush(stdout);
-    fflush(stderr);
+  // single consumer
+  slot *front() {
+    auto s = &slots_[head_ & mask_];
+    return s->sequence.load(std::memory_order_acquire) == head_ + 1 ? s
+                                                                   : nullptr;
   }
-};
 
-class console_formatter : public spdlog::formatter {
-  using MyType = console_formatter;
+  void pop() {
+    slots_[head_ & mask_].sequence.store(head_ + mask_ + 1,
+                                         std::memory_order_release);
+    head_++;
+  }
 
+ private:
+  std::unique_ptr<slot[]> slots_;
+  const size_t mask_;
+  std::atomic<size_t> tail_{0};
+  size_t head_ = 0;
+};
+
+/**
+ * Background writer of the ring.
+ */
+class sink {
  public:
-  console_formatter() {}
-  static std::shared_ptr<MyType> instance() {
-    static std::shared_ptr<MyType> instance = std::make_shared<MyType>();
+  static sink &instance() {
+    static sink instance;
     return instance;
   }
 
-  void format(spdlog::details::log_msg &msg) override {
-    msg.formatted << datetime::unixtime_str()
-                  << (msg.level != (spdlog::level::level_enum)LogLevel::Explore
-                          ? " " + level_names[msg.level]
-                          : "")
-                  << " [" << *msg.logger_name << "] " << msg.raw.str();
-    // write eol
-    msg.formatted.write(spdlog::details::os::eol,
-                        spdlog::details::os::eol_size);
+  ~sink() { stop(); }
+
+  bool running() const { return running_.load(std::memory_order_acquire); }
+
+  void start() {
+    std::lock_guard<std::mutex> lock(control_);
+    if (running()) return;
+    if (!ring_) ring_.reset(new ring(4096));
+    stop_ = false;
+    thread_ = std::thread([this] { run(); });
+    running_.store(true, std::memory_order_release);
   }
-};
 
-base::base(std::string &&caller, LogLevel level) noexcept
-    : caller(caller),
-      uncaught(std::uncaught_exception()),
-      level((spdlog::level::level_enum)level) {
-  console = spdlog::get(caller);
-  if (!console) {
-    console =
-        std::make_shared<spdlog::logger>(caller, console_sink::instance());
-    console->set_level((spdlog::level::level_enum)detail::LOG_LEVEL);
-    console->set_formatter(console_formatter::instance());
+  void stop() {
+    std::lock_guard<std::mutex> lock(control_);
+    if (!running()) return;
+    running_.store(false, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
   }
-}
 
-base::base(const std::string &caller, LogLevel level) noexcept
-    : caller(caller),
-      uncaught(std::uncaught_exception()),
-      level((spdlog::level::level_enum)level) {
-  console = spdlog::get(caller);
-  if (!console) {
-    console =
-        std::make_shared<spdlog::logger>(caller, console_sink::instance());
-    console->set_level((spdlog::level::level_enum)detail::LOG_LEVEL);
-    console->set_formatter(console_formatter::instance());
+  void push(const line &l, size_t textLength) {
+    // below Warning a full queue drops the line rather than stalling
+    // consensus, Warning and above wait for room
+    while (!ring_->push(l, textLength)) {
+      if (l.level < LogLevel::Warning) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      std::this_thread::yield();
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    if (sleeping_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      wakeup_.notify_one();
+    }
   }
+
+  void flush() {
+    if (!running()) {
+      fflush(stdout);
+      fflush(stderr);
+      return;
+    }
+    const auto target = queued_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex_);
+    wakeup_.notify_one();
+    drained_.wait(lock, [&] { return written_ >= target || stop_; });
+  }
+
+ private:
+  void run() {
+    std::string rendered;
+    while (true) {
+      size_t count = 0;
+      while (auto s = ring_->front()) {
+        render(rendered, s->time, s->level, s->caller, s->text,
+               s->textLength);
+        write(rendered, s->level);
+        ring_->pop();
+        count++;
+      }
+      if (auto dropped = dropped_.exchange(0)) {
+        const auto text =
+            std::to_string(dropped) + " lines dropped, queue full";
+        render(rendered, datetime::unixtime(), LogLevel::Warning, "logger",
+               text.data(), text.size());
+        write(rendered, LogLevel::Warning);
+      }
+      fflush(stdout);
+      fflush(stderr);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      written_ += count;
+      drained_.notify_all();
+      if (stop_ && ring_->front() == nullptr) return;
+      sleeping_.store(true, std::memory_order_release);
+      // the timeout covers a push racing with falling asleep
+      wakeup_.wait_for(lock, std::chrono::milliseconds(10),
+                       [&] { return stop_ || ring_->front() != nullptr; });
+      sleeping_.store(false, std::memory_order_release);
+    }
+  }
+
+  std::mutex control_;
+  std::atomic<bool> running_{false};
+  std::unique_ptr<ring> ring_;
+  std::thread thread_;
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::condition_variable drained_;
+  std::atomic<bool> sleeping_{false};
+  bool stop_ = false;
+
+  std::atomic<size_t> queued_{0};
+  size_t written_ = 0;
+  std::atomic<size_t> dropped_{0};
+};
+
+thread_local line current;
+
+std::ostream *open(const char *caller, size_t length, LogLevel level,
+                   line *&out) noexcept {
+  // a line logged while formatting another one gets its own buffer
+  out = current.busy ? new line() : &current;
+  out->busy = true;
+  out->time = datetime::unixtime();
+  out->level = level;
+  out->caller.assign(caller, length);
+
+  out->buf.reset(out->text, textSize);
+  auto &stream = out->stream;
+  stream.clear();
+  stream.flags(std::ios_base::dec | std::ios_base::skipws);
+  stream.width(0);
+  stream.precision(6);
+  stream.fill(' ');
+  return &stream;
 }
 
-base::~base() {
+void close(line *l) noexcept {
+  // a line cut by an exception is not written, as before
   if (!std::uncaught_exception()) {
-    console->log(level, stream.str());
+    auto length = l->buf.size();
+    if (l->stream.bad() && length >= 3) {
+      std::memcpy(l->text + length - 3, "...", 3);
+    }
+
+    auto &s = sink::instance();
+    if (s.running()) {
+      s.push(*l, length);
+      if (l->level == LogLevel::Fatal) s.flush();
+    } else {
+      thread_local std::string rendered;
+      render(rendered, l->time, l->level, l->caller, l->text, length);
+      write(rendered, l->level);
+      fflush(LogLevel::Error <= l->level ? stderr : stdout);
+    }
+  }
+
+  if (l == &current) {
+    l->busy = false;
+  } else {
+    delete l;
   }
 }
 
-debug::debug(std::string &&caller) noexcept : base(caller, LogLevel::Debug) {}
-debug::debug(const std::string &caller) noexcept
-    : base(caller, LogLevel::Debug) {}
-info::info(std::string &&caller) noexcept : base(caller, LogLevel::Info) {}
-info::info(const std::string &caller) noexcept : base(caller, LogLevel::Info) {}
-warning::warning(std::string &&caller) noexcept
-    : base(caller, LogLevel::Warning) {}
-warning::warning(const std::string &caller) noexcept
-    : base(caller, LogLevel::Warning) {}
-error::error(std::string &&caller) noexcept : base(caller, LogLevel::Error) {}
-error::error(const std::string &caller) noexcept
-    : base(caller, LogLevel::Error) {}
-fatal::fatal(std::string &&caller) noexcept : base(caller, LogLevel::Fatal) {}
-fatal::fatal(const std::string &caller) noexcept
-    : base(caller, LogLevel::Fatal) {}
-explore::explore(std::string &&caller) noexcept
-    : base(caller, LogLevel::Explore) {}
-explore::explore(const std::string &caller) noexcept
-    : base(caller, LogLevel::Explore) {}
+}  // namespace detail
+
+void setLogLevel(LogLevel lv) {
+  detail::LOG_LEVEL.store(static_cast<int>(lv), std::memory_order_relaxed);
+}
+
+void startAsync() { detail::sink::instance().start(); }
+
+void flush() { detail::sink::instance().flush(); }
+
+void stopAsync() {
+  detail::sink::instance().flush();
+  detail::sink::instance().stop();
+}
 }  // namespace logger
@@ -17,31 +17,84 @@ limitations under the License.
 #ifndef __LOGGER_HPP_
 #define __LOGGER_HPP_
 
+#include <atomic>
+#include <cstring>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
-#include <spdlog/spdlog.h>
+// levels below this are compiled out, see LOG_LEVEL_MIN in CMakeLists.txt
+#ifndef IROHA_LOG_LEVEL_MIN
+#define IROHA_LOG_LEVEL_MIN 0
+#endif
 
 namespace logger {
 
 enum class LogLevel { Debug = 0, Explore, Info, Warning, Error, Fatal };
 
+constexpr LogLevel compiledLevel =
+    static_cast<LogLevel>(IROHA_LOG_LEVEL_MIN);
+
 void setLogLevel(LogLevel);
 
+namespace detail {
+extern std::atomic<int> LOG_LEVEL;
+
+struct line;
+std::ostream *open(const char *caller, size_t length, LogLevel level,
+                   line *&out) noexcept;
+void close(line *line) noexcept;
+}  // namespace detail
+
+inline bool enabled(LogLevel level) {
+  return level >= compiledLevel &&
+         static_cast<int>(level) >=
+             detail::LOG_LEVEL.load(std::memory_order_relaxed);
+}
+
+/**
+ * From now on lines are queued in a ring buffer and written by a
+ * background thread. Until then every line is written by its caller.
+ */
+void startAsync();
+
+/**
+ * Returns when every line queued so far is written.
+ */
+void flush();
+
+/**
+ * Flushes and stops the background thread.
+ */
+void stopAsync();
+
+/**
+ * One line. Nothing is formatted unless its level is enabled; the text
+ * goes into a per-thread buffer of fixed size and is cut beyond it.
+ */
 struct base {
-  explicit base(std::string &&caller, LogLevel level) noexcept;
-  explicit base(const std::string &caller, LogLevel level) noexcept;
-  virtual ~base() = 0;
-  const std::string caller;
-  std::stringstream stream;
-  bool uncaught = true;
-  std::shared_ptr<spdlog::logger> console;
-  spdlog::level::level_enum level;
+  base(const std::string &caller, LogLevel level) noexcept
+      : stream(enabled(level) ? detail::open(caller.data(), caller.size(),
+                                             level, line)
+                              : nullptr) {}
+  base(const char *caller, LogLevel level) noexcept
+      : stream(enabled(level)
+                   ? detail::open(caller, std::strlen(caller), level, line)
+                   : nullptr) {}
+  ~base() {
+    if (stream != nullptr) detail::close(line);
+  }
+  base(const base &) = delete;
+  base &operator=(const base &) = delete;
+
+  detail::line *line = nullptr;
+  std::ostream *stream;
 };
 
 template <typename T>
 inline base &operator<<(base &record, T &&t) {
-  record.stream << std::forward<T>(t);
+  if (record.stream != nullptr) *record.stream << std::forward<T>(t);
   return record;
 }
 
@@ -50,35 +103,39 @@ inline base &operator<<(base &&record, T &&t) {
   return record << std::forward<T>(t);
 }
 
-struct debug : public base {
-  explicit debug(std::string &&caller) noexcept;
-  explicit debug(const std::string &caller) noexcept;
-};
-
-struct info : public base {
-  explicit info(std::string &&caller) noexcept;
-  explicit info(const std::string &caller) noexcept;
+template <LogLevel Level>
+struct record : public base {
+  explicit record(const std::string &caller) noexcept : base(caller, Level) {}
+  explicit record(const char *caller) noexcept : base(caller, Level) {}
 };
 
-struct warning : public base {
-  explicit warning(std::string &&caller) noexcept;
-  explicit warning(const std::string &caller) noexcept;
+// a line of a compiled out level, inlined to nothing
+struct disabled {
+  explicit disabled(const std::string &) noexcept {}
+  explicit disabled(const char *) noexcept {}
 };
 
-struct error : public base {
-  explicit error(std::string &&caller) noexcept;
-  explicit error(const std::string &caller) noexcept;
-};
+template <typename T>
+inline disabled &operator<<(disabled &record, T &&) {
+  return record;
+}
 
-struct fatal : public base {
-  explicit fatal(std::string &&caller) noexcept;
-  explicit fatal(const std::string &caller) noexcept;
-};
+template <typename T>
+inline disabled &operator<<(disabled &&record, T &&) {
+  return record;
+}
 
-struct explore : public base {
-  explicit explore(std::string &&caller) noexcept;
-  explicit explore(const std::string &caller) noexcept;
-};
+template <LogLevel Level>
+using level_t =
+    typename std::conditional<(Level >= compiledLevel), record<Level>,
+                              disabled>::type;
+
+using debug = level_t<LogLevel::Debug>;
+using explore = level_t<LogLevel::Explore>;
+using info = level_t<LogLevel::Info>;
+using warning = level_t<LogLevel::Warning>;
+using error = level_t<LogLevel::Error>;
+using fatal = level_t<LogLevel::Fatal>;
 }  // namespace logger
 
 #endif
@@ -0,0 +1,251 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "metrics.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace metrics {
+
+const size_t Histogram::subBuckets;
+const size_t Histogram::numBuckets;
+
+void Histogram::observe(uint64_t value) {
+  buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+size_t Histogram::bucketOf(uint64_t value) {
+  if (value < subBuckets) return value;
+  // value is in [4 << shift, 8 << shift)
+  const size_t shift = 63 - __builtin_clzll(value) - 2;
+  return shift * subBuckets + (value >> shift);
+}
+
+uint64_t Histogram::upperBound(size_t bucket) {
+  if (bucket < subBuckets) return bucket + 1;
+  const size_t shift = bucket / subBuckets - 1;
+  const uint64_t mantissa = bucket - shift * subBuckets;
+  if (shift + 3 >= 64 && mantissa + 1 == 2 * subBuckets) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return (mantissa + 1) << shift;
+}
+
+uint64_t Histogram::lastValue(size_t bucket) {
+  const auto bound = upperBound(bucket);
+  // the last bucket holds the largest value too
+  return bound == std::numeric_limits<uint64_t>::max() ? bound : bound - 1;
+}
+
+uint64_t Histogram::quantile(double q) const {
+  const auto total = count();
+  if (total == 0) return 0;
+  const auto rank = static_cast<uint64_t>(std::ceil(q * total));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < numBuckets; i++) {
+    seen += bucketCount(i);
+    if (seen >= rank && seen != 0) return upperBound(i);
+  }
+  return upperBound(numBuckets - 1);
+}
+
+namespace {
+
+struct Entry {
+  std::unique_ptr<Counter> counter;
+  std::unique_ptr<Gauge> gauge;
+  std::unique_ptr<Histogram> histogram;
+  std::function<double()> read;
+};
+
+struct Family {
+  std::string help;
+  std::string type;
+  // rendered labels -> metric, map nodes don't move
+  std::map<std::string, Entry> entries;
+};
+
+std::mutex mutex;
+std::map<std::string, Family> &families() {
+  static std::map<std::string, Family> families;
+  return families;
+}
+
+void escape(std::string &out, const std::string &value) {
+  for (auto c : value) {
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '"': out += "\\\""; break;
+      case '\n': out += "\\n"; break;
+      default: out += c;
+    }
+  }
+}
+
+// {a="x",b="y"} without the braces
+std::string keyOf(const Labels &labels) {
+  std::string key;
+  for (const auto &label : labels) {
+    if (!key.empty()) key += ',';
+    key += label.first;
+    key += "=\"";
+    escape(key, label.second);
+    key += '"';
+  }
+  return key;
+}
+
+// called with mutex held
+Entry &entryOf(const std::string &name, const std::string &help,
+               const std::string &type, const Labels &labels) {
+  auto &family = families()[name];
+  if (family.type.empty()) {
+    family.help = help;
+    family.type = type;
+  }
+  return family.entries[keyOf(labels)];
+}
+
+void number(std::string &out, double value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.9g", value);
+  out += buf;
+}
+
+void number(std::string &out, uint64_t value) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%llu",
+                static_cast<unsigned long long>(value));
+  out += buf;
+}
+
+void sample(std::string &out, const std::string &name, const char *suffix,
+            const std::string &key, const std::string &extra) {
+  out += name;
+  out += suffix;
+  if (!key.empty() || !extra.empty()) {
+    out += '{';
+    out += key;
+    if (!key.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+  }
+  out += ' ';
+}
+
+void renderHistogram(std::string &out, const std::string &name,
+                     const std::string &key, const Histogram &histogram) {
+  // buckets up to the last used one, the rest only add to +Inf
+  size_t last = 0;
+  std::array<uint64_t, Histogram::numBuckets> counts;
+  for (size_t i = 0; i < Histogram::numBuckets; i++) {
+    counts[i] = histogram.bucketCount(i);
+    if (counts[i] != 0) last = i + 1;
+  }
+
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < last; i++) {
+    cumulative += counts[i];
+    std::string le = "le=\"";
+    number(le, Histogram::lastValue(i) * histogram.unit());
+    le += '"';
+    sample(out, name, "_bucket", key, le);
+    number(out, cumulative);
+    out += '\n';
+  }
+  sample(out, name, "_bucket", key, "le=\"+Inf\"");
+  number(out, cumulative);
+  out += '\n';
+  sample(out, name, "_sum", key, "");
+  number(out, histogram.sum() * histogram.unit());
+  out += '\n';
+  sample(out, name, "_count", key, "");
+  number(out, cumulative);
+  out += '\n';
+}
+
+}  // namespace
+
+Counter &counter(const std::string &name, const std::string &help,
+                 const Labels &labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = entryOf(name, help, "counter", labels);
+  if (!entry.counter) entry.counter.reset(new Counter());
+  return *entry.counter;
+}
+
+Gauge &gauge(const std::string &name, const std::string &help,
+             const Labels &labels) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = entryOf(name, help, "gauge", labels);
+  if (!entry.gauge) entry.gauge.reset(new Gauge());
+  return *entry.gauge;
+}
+
+Histogram &histogram(const std::string &name, const std::string &help,
+                     const Labels &labels, double unit) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = entryOf(name, help, "histogram", labels);
+  if (!entry.histogram) entry.histogram.reset(new Histogram(unit));
+  return *entry.histogram;
+}
+
+void collect(const std::string &name, const std::string &help, Type type,
+             const Labels &labels, std::function<double()> read) {
+  std::lock_guard<std::mutex> lock(mutex);
+  entryOf(name, help, type == Type::Counter ? "counter" : "gauge", labels)
+      .read = std::move(read);
+}
+
+std::string render() {
+  std::string out;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (const auto &pair : families()) {
+    const auto &name = pair.first;
+    const auto &family = pair.second;
+    out += "# HELP " + name + " " + family.help + "\n";
+    out += "# TYPE " + name + " " + family.type + "\n";
+    for (const auto &e : family.entries) {
+      const auto &key = e.first;
+      const auto &entry = e.second;
+      if (entry.histogram) {
+        renderHistogram(out, name, key, *entry.histogram);
+        continue;
+      }
+      sample(out, name, "", key, "");
+      if (entry.counter) {
+        number(out, entry.counter->value());
+      } else if (entry.gauge) {
+        number(out, static_cast<double>(entry.gauge->value()));
+      } else if (entry.read) {
+        number(out, entry.read());
+      } else {
+        out += '0';
+      }
+      out += '\n';
+    }
+  }
+  return out;
+}
+
+}  // namespace metrics
@@ -0,0 +1,146 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IROHA_METRICS_HPP
+#define IROHA_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Process wide metrics, rendered in the Prometheus text format.
+ *  - a metric is looked up once, e.g. kept in a function static, and
+ *    updated with relaxed atomics afterwards
+ *  - values that already live elsewhere (queue depths, LMDB stats) are
+ *    read by a callback when rendered
+ */
+namespace metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+ public:
+  void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+ public:
+  void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+  void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+  int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Log-linear histogram of integer values (HdrHistogram style): every
+ * power of two is split in 4 buckets, so a bucket is at most 25% wide.
+ */
+class Histogram {
+ public:
+  static const size_t subBuckets = 4;
+  static const size_t numBuckets = 64 * subBuckets;
+
+  // unit - what one recorded value is in the rendered unit, e.g. 1e-6 to
+  // record microseconds of a metric in seconds
+  explicit Histogram(double unit) : unit_(unit) {}
+
+  void observe(uint64_t value);
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  double unit() const { return unit_; }
+
+  // value under which the given fraction of the observations are
+  uint64_t quantile(double q) const;
+
+  static size_t bucketOf(uint64_t value);
+  // first value of the next bucket
+  static uint64_t upperBound(size_t bucket);
+  // largest value of a bucket, its Prometheus "le"
+  static uint64_t lastValue(size_t bucket);
+  uint64_t bucketCount(size_t bucket) const {
+    return buckets_[bucket].load(std::memory_order_relaxed);
+  }
+
+ private:
+  const double unit_;
+  std::array<std::atomic<uint64_t>, numBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+};
+
+/**
+ * Observes the microseconds from construction to stop() or destruction.
+ */
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram &histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() { stop(); }
+
+  void stop() {
+    if (stopped_) return;
+    stopped_ = true;
+    histogram_.observe(std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count());
+  }
+
+ private:
+  Histogram &histogram_;
+  const std::chrono::steady_clock::time_point start_;
+  bool stopped_ = false;
+};
+
+/**
+ * Returns the metric of name and labels, registered on first call. A name
+ * has one type and one help text, the first ones given.
+ */
+Counter &counter(const std::string &name, const std::string &help,
+                 const Labels &labels = {});
+Gauge &gauge(const std::string &name, const std::string &help,
+             const Labels &labels = {});
+// latencies: record microseconds, rendered in seconds
+Histogram &histogram(const std::string &name, const std::string &help,
+                     const Labels &labels = {}, double unit = 1e-6);
+
+enum class Type { Counter, Gauge };
+
+/**
+ * Registers a metric read from read() at every render. read runs with the
+ * registry locked and must not register metrics itself.
+ */
+void collect(const std::string &name, const std::string &help, Type type,
+             const Labels &labels, std::function<double()> read);
+
+// every metric in the Prometheus text exposition format 0.0.4
+std::string render();
+
+}  // namespace metrics
+
+#endif  // IROHA_METRICS_HPP
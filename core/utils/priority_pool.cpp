@@ -0,0 +1,183 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "priority_pool.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace scheduling {
+
+namespace {
+// index of the worker running on this thread in its pool
+thread_local const void *currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+}  // namespace
+
+PriorityPool::PriorityPool(const PriorityPoolOptions &options)
+    : options_(options) {
+  auto threads = options_.threads != 0
+                     ? options_.threads
+                     : std::max(1u, std::thread::hardware_concurrency());
+  // at least one worker serves every lane
+  options_.reserved = std::min(options_.reserved, threads - 1);
+
+  for (size_t i = 0; i < threads; i++) {
+    workers_.emplace_back(new Worker());
+  }
+  for (size_t i = 0; i < threads; i++) {
+    workers_[i]->thread = std::thread([this, i] { run(i); });
+    pin(i);
+  }
+}
+
+PriorityPool::~PriorityPool() {
+  {
+    std::lock_guard<std::mutex> lock(idleMutex_);
+    stop_ = true;
+  }
+  idle_.notify_all();
+  idleReserved_.notify_all();
+  for (auto &worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+bool PriorityPool::serves(size_t worker, size_t lane) const {
+  return worker >= options_.reserved ||
+         lane == static_cast<size_t>(Lane::Consensus);
+}
+
+bool PriorityPool::process(Lane lane, Task task) {
+  const auto l = static_cast<size_t>(lane);
+  auto &counters = counters_[l];
+  if (counters.depth.fetch_add(1) >= options_.queueSize[l]) {
+    counters.depth.fetch_sub(1);
+    counters.rejected.fetch_add(1);
+    return false;
+  }
+
+  // a worker keeps its own work, other threads spread it round robin
+  // over the workers serving the lane
+  size_t target;
+  if (currentPool == this && serves(currentWorker, l)) {
+    target = currentWorker;
+  } else {
+    const auto first = serves(0, l) ? 0 : options_.reserved;
+    target = first + next_.fetch_add(1) % (workers_.size() - first);
+  }
+  {
+    std::lock_guard<std::mutex> lock(workers_[target]->mutex);
+    workers_[target]->queues[l].push_back(Item{std::move(task), Clock::now()});
+  }
+
+  // taking idleMutex_ orders the push before a worker's recheck
+  { std::lock_guard<std::mutex> lock(idleMutex_); }
+  idle_.notify_one();
+  if (lane == Lane::Consensus) idleReserved_.notify_one();
+  return true;
+}
+
+LaneStats PriorityPool::stats(Lane lane) const {
+  const auto &counters = counters_[static_cast<size_t>(lane)];
+  LaneStats res;
+  res.depth = counters.depth.load();
+  res.executed = counters.executed.load();
+  res.rejected = counters.rejected.load();
+  if (res.executed != 0) {
+    res.meanWaitMicros = counters.waitNanos.load() / 1000.0 / res.executed;
+  }
+  res.maxWaitMicros = counters.maxWaitNanos.load() / 1000.0;
+  return res;
+}
+
+bool PriorityPool::take(size_t self, Item &item, size_t &lane) {
+  const auto n = workers_.size();
+  for (lane = 0; lane < numLanes; lane++) {
+    if (!serves(self, lane)) break;
+    if (counters_[lane].depth.load() == 0) continue;
+
+    // own work oldest first, stolen work from the back of the victim
+    for (size_t i = 0; i < n; i++) {
+      auto &worker = *workers_[(self + i) % n];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      auto &queue = worker.queues[lane];
+      if (queue.empty()) continue;
+      if (i == 0) {
+        item = std::move(queue.front());
+        queue.pop_front();
+      } else {
+        item = std::move(queue.back());
+        queue.pop_back();
+      }
+      counters_[lane].depth.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void PriorityPool::run(size_t self) {
+  currentPool = this;
+  currentWorker = self;
+  const bool reserved = !serves(self, static_cast<size_t>(Lane::Ingress));
+
+  while (true) {
+    Item item;
+    size_t lane;
+    if (take(self, item, lane)) {
+      auto &counters = counters_[lane];
+      const uint64_t wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                Clock::now() - item.queued)
+                                .count();
+      counters.waitNanos.fetch_add(wait);
+      auto max = counters.maxWaitNanos.load();
+      while (wait > max && !counters.maxWaitNanos.compare_exchange_weak(max, wait)) {
+      }
+      item.task();
+      counters.executed.fetch_add(1);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(idleMutex_);
+    auto &idle = reserved ? idleReserved_ : idle_;
+    idle.wait(lock, [&] {
+      if (stop_) return true;
+      for (size_t l = 0; l < numLanes && serves(self, l); l++) {
+        if (counters_[l].depth.load() != 0) return true;
+      }
+      return false;
+    });
+    if (stop_) return;
+  }
+}
+
+void PriorityPool::pin(size_t self) {
+#ifdef __linux__
+  if (options_.cpus.empty()) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(options_.cpus[self % options_.cpus.size()], &set);
+  pthread_setaffinity_np(workers_[self]->thread.native_handle(), sizeof(set),
+                         &set);
+#endif
+}
+
+}  // namespace scheduling
@@ -0,0 +1,152 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IROHA_PRIORITY_POOL_HPP
+#define IROHA_PRIORITY_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace scheduling {
+
+// lanes in priority order, a lane is served only when the ones above are empty
+enum class Lane : size_t { Consensus = 0, Ingress = 1 };
+const size_t numLanes = 2;
+
+// move-only task, so tasks can own the flatbuffers they process
+class Task {
+ public:
+  Task() = default;
+
+  template <typename F,
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+  Task(F &&f)
+      : impl_(new Impl<typename std::decay<F>::type>(std::forward<F>(f))) {}
+
+  void operator()() { (*impl_)(); }
+  explicit operator bool() const { return impl_ != nullptr; }
+
+ private:
+  struct Base {
+    virtual ~Base() = default;
+    virtual void operator()() = 0;
+  };
+
+  template <typename F>
+  struct Impl : Base {
+    F f;
+    explicit Impl(F &&f) : f(std::move(f)) {}
+    explicit Impl(const F &f) : f(f) {}
+    void operator()() override { f(); }
+  };
+
+  std::unique_ptr<Base> impl_;
+};
+
+struct PriorityPoolOptions {
+  size_t threads = 0;   // 0: one per core
+  size_t reserved = 1;  // workers that run Consensus work only
+  // tasks queued per lane at most, process() refuses more
+  std::array<size_t, numLanes> queueSize{{4096, 1024}};
+  // worker i runs on cpus[i % cpus.size()], empty: not pinned
+  std::vector<size_t> cpus;
+};
+
+struct LaneStats {
+  size_t depth = 0;  // queued now
+  uint64_t executed = 0;
+  uint64_t rejected = 0;
+  double meanWaitMicros = 0.0;  // from process() to the start of the task
+  double maxWaitMicros = 0.0;
+};
+
+/**
+ * Work-stealing pool with priority lanes.
+ *  - each worker has a queue per lane; a worker takes the highest lane
+ *    with work, from its own queue first, else stolen from another one
+ *  - the first `reserved` workers run Consensus work only, so consensus
+ *    never waits behind a long Ingress task
+ *  - each lane has its own limit, a flood of Ingress is refused without
+ *    delaying Consensus
+ */
+class PriorityPool {
+ public:
+  explicit PriorityPool(const PriorityPoolOptions &options);
+  ~PriorityPool();
+
+  PriorityPool(const PriorityPool &) = delete;
+  PriorityPool &operator=(const PriorityPool &) = delete;
+
+  /**
+   * Queues task in lane.
+   * @return false if the lane is full, task is dropped
+   */
+  bool process(Lane lane, Task task);
+
+  LaneStats stats(Lane lane) const;
+
+  size_t size() const { return workers_.size(); }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Item {
+    Task task;
+    Clock::time_point queued;
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::array<std::deque<Item>, numLanes> queues;
+    std::thread thread;
+  };
+
+  struct Counters {
+    std::atomic<size_t> depth{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> waitNanos{0};
+    std::atomic<uint64_t> maxWaitNanos{0};
+  };
+
+  bool serves(size_t worker, size_t lane) const;
+  bool take(size_t self, Item &item, size_t &lane);
+  void run(size_t self);
+  void pin(size_t self);
+
+  PriorityPoolOptions options_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::array<Counters, numLanes> counters_;
+  std::atomic<size_t> next_{0};
+
+  std::mutex idleMutex_;
+  std::condition_variable idle_;          // workers serving every lane
+  std::condition_variable idleReserved_;  // Consensus only workers
+  bool stop_ = false;
+};
+
+}  // namespace scheduling
+
+#endif  // IROHA_PRIORITY_POOL_HPP
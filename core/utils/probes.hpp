@@ -0,0 +1,45 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IROHA_PROBES_HPP
+#define IROHA_PROBES_HPP
+
+/**
+ * Static tracepoints (USDT) of provider "iroha", for perf, bpftrace and
+ * SystemTap. A probe is a nop until a tracer attaches to it, e.g.
+ *   bpftrace -e 'usdt:./iroha-main:iroha:commit_start { @n = count(); }'
+ *   perf probe -x ./iroha-main sdt_iroha:ametsuchi_append_start
+ * Arguments are computed even when nobody listens: pass values at hand
+ * (sizes, pointers, c_str()), nothing to build for the probe alone.
+ * Without sys/sdt.h, see USDT in CMakeLists.txt, probes are compiled out.
+ */
+#ifdef IROHA_USDT
+#include <sys/sdt.h>
+
+#define IROHA_PROBE(name) DTRACE_PROBE(iroha, name)
+#define IROHA_PROBE1(name, a) DTRACE_PROBE1(iroha, name, a)
+#define IROHA_PROBE2(name, a, b) DTRACE_PROBE2(iroha, name, a, b)
+#define IROHA_PROBE3(name, a, b, c) DTRACE_PROBE3(iroha, name, a, b, c)
+#else
+#define IROHA_PROBE(name) \
+  do {                    \
+  } while (0)
+#define IROHA_PROBE1(name, a) IROHA_PROBE(name)
+#define IROHA_PROBE2(name, a, b) IROHA_PROBE(name)
+#define IROHA_PROBE3(name, a, b, c) IROHA_PROBE(name)
+#endif
+
+#endif  // IROHA_PROBES_HPP
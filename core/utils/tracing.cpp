@@ -0,0 +1,237 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "tracing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace tracing {
+
+namespace {
+
+std::atomic<bool> on{false};
+std::atomic<double> rate{0.0};
+
+std::mutex mutex;
+std::FILE *file = nullptr;
+bool first = true;
+uint32_t pid = 0;
+
+thread_local Context currentContext;
+
+uint32_t tid() {
+  static std::atomic<uint32_t> next{1};
+  thread_local const uint32_t id = next.fetch_add(1);
+  return id;
+}
+
+uint64_t newSpanId() {
+  thread_local std::mt19937_64 engine([] {
+    std::random_device device;
+    return device() ^ std::hash<std::thread::id>()(std::this_thread::get_id());
+  }());
+  uint64_t id;
+  do {
+    id = engine();
+  } while (id == 0);
+  return id;
+}
+
+void hex(std::string &out, const uint8_t *data, size_t size) {
+  static const char digits[] = "0123456789abcdef";
+  for (size_t i = 0; i < size; i++) {
+    out += digits[data[i] >> 4];
+    out += digits[data[i] & 0xf];
+  }
+}
+
+void hex(std::string &out, uint64_t value) {
+  uint8_t bytes[8];
+  for (int i = 7; i >= 0; i--) {
+    bytes[i] = value & 0xff;
+    value >>= 8;
+  }
+  hex(out, bytes, sizeof(bytes));
+}
+
+void escape(std::string &out, const std::string &value) {
+  for (unsigned char c : value) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      default:
+        if (c < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+}
+
+// writes one event of the JSON array, with mutex held
+void write(const std::string &event) {
+  if (file == nullptr) return;
+  std::fputs(first ? "\n" : ",\n", file);
+  std::fputs(event.c_str(), file);
+  first = false;
+}
+
+void emit(const char *name, const Context &context, uint64_t parent,
+          uint64_t start, uint64_t end, const std::string &attrs) {
+  std::string event;
+  event.reserve(256 + attrs.size());
+  event += "{\"name\":\"";
+  escape(event, name);
+  event += "\",\"cat\":\"iroha\",\"ph\":\"X\",\"ts\":";
+  event += std::to_string(start);
+  event += ",\"dur\":";
+  event += std::to_string(end - start);
+  event += ",\"tid\":";
+  event += std::to_string(tid());
+  event += ",\"args\":{\"trace\":\"";
+  hex(event, context.trace.data(), context.trace.size());
+  event += "\",\"span\":\"";
+  hex(event, context.span);
+  event += "\",\"parent\":\"";
+  hex(event, parent);
+  event += '"';
+  event += attrs;
+  event += "},\"pid\":";
+
+  std::lock_guard<std::mutex> lock(mutex);
+  event += std::to_string(pid);
+  event += '}';
+  write(event);
+}
+
+}  // namespace
+
+bool start(const std::string &path, double sampleRate,
+           const std::string &process) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (file != nullptr) std::fclose(file);
+  file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    on = false;
+    return false;
+  }
+  first = true;
+  pid = std::hash<std::string>()(process) & 0x7fffffff;
+  std::fputs("[", file);
+
+  // names the process of this peer in the viewer
+  std::string event = "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":";
+  event += std::to_string(pid);
+  event += ",\"args\":{\"name\":\"";
+  escape(event, process);
+  event += "\"}}";
+  write(event);
+
+  rate = sampleRate;
+  on = sampleRate > 0;
+  return true;
+}
+
+void stop() {
+  std::lock_guard<std::mutex> lock(mutex);
+  on = false;
+  if (file == nullptr) return;
+  std::fputs("\n]\n", file);
+  std::fclose(file);
+  file = nullptr;
+}
+
+bool enabled() { return on.load(std::memory_order_relaxed); }
+
+Context root(const TraceId &id) {
+  Context context;
+  context.trace = id;
+  if (!enabled()) return context;
+
+  // the first 53 bits of the id as a number in [0, 1)
+  uint64_t bits = 0;
+  for (size_t i = 0; i < sizeof(bits); i++) bits = (bits << 8) | id[i];
+  const double position = (bits >> 11) * (1.0 / (1ull << 53));
+  context.sampled = position < rate.load(std::memory_order_relaxed);
+  return context;
+}
+
+Context current() { return currentContext; }
+
+uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void record(const char *name, const Context &parent, uint64_t start) {
+  if (!parent.sampled || !enabled()) return;
+  Context context = parent;
+  context.span = newSpanId();
+  emit(name, context, parent.span, start, std::max(start, now()), "");
+}
+
+Span::Span(const char *name) : Span(name, currentContext) {}
+
+Span::Span(const char *name, const Context &parent)
+    : name_(name), context_(parent) {
+  if (!parent.sampled || !enabled()) {
+    context_.sampled = false;
+    ended_ = true;
+    return;
+  }
+  parent_ = parent.span;
+  context_.span = newSpanId();
+  start_ = now();
+  previous_ = currentContext;
+  currentContext = context_;
+}
+
+void Span::attr(const char *key, const std::string &value) {
+  if (ended_) return;
+  attrs_ += ",\"";
+  escape(attrs_, key);
+  attrs_ += "\":\"";
+  escape(attrs_, value);
+  attrs_ += '"';
+}
+
+void Span::end() {
+  if (ended_) return;
+  ended_ = true;
+  currentContext = previous_;
+  if (!enabled()) return;
+  emit(name_, context_, parent_, start_, std::max(start_, now()), attrs_);
+}
+
+Scope::Scope(const Context &context) : previous_(currentContext) {
+  currentContext = context;
+}
+
+Scope::~Scope() { currentContext = previous_; }
+
+}  // namespace tracing
@@ -0,0 +1,121 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef IROHA_TRACING_HPP
+#define IROHA_TRACING_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * Per-transaction trace spans, written to a local file in the Chrome trace
+ * event format (chrome://tracing, Perfetto).
+ *  - a trace is keyed by the transaction: its id is the start of the
+ *    transaction digest, so every peer derives the same id
+ *  - a trace is sampled from its id, so peers with the same rate agree on
+ *    which transactions they trace without talking
+ *  - the span running on a thread is its current one, new spans without an
+ *    explicit parent are its children; nothing is recorded off a trace
+ */
+namespace tracing {
+
+using TraceId = std::array<uint8_t, 16>;
+
+struct Context {
+  TraceId trace{};
+  uint64_t span = 0;  // 0: the root of the trace
+  bool sampled = false;
+};
+
+/**
+ * Starts writing the spans of a fraction sampleRate of the traces to path.
+ * process names this peer in the trace, e.g. its address.
+ * @return false if the file can't be opened
+ */
+bool start(const std::string &path, double sampleRate,
+           const std::string &process);
+
+// closes the file, spans ended later are dropped
+void stop();
+
+bool enabled();
+
+// the root of the trace of id, sampled or not
+Context root(const TraceId &id);
+
+// context of the span running on this thread, not sampled if none
+Context current();
+
+// microseconds since the epoch, the timestamps of the spans
+uint64_t now();
+
+/**
+ * Records a span of parent that started at start and ends now, e.g. the
+ * time a task waited in a queue.
+ */
+void record(const char *name, const Context &parent, uint64_t start);
+
+/**
+ * A span from construction to end() or destruction. It is the current span
+ * of its thread meanwhile, so spans must end in reverse order.
+ */
+class Span {
+ public:
+  // child of the current span
+  explicit Span(const char *name);
+  Span(const char *name, const Context &parent);
+  ~Span() { end(); }
+
+  Span(const Span &) = delete;
+  Span &operator=(const Span &) = delete;
+
+  // shown with the span, ignored if it is not sampled
+  void attr(const char *key, const std::string &value);
+
+  const Context &context() const { return context_; }
+
+  void end();
+
+ private:
+  const char *name_;
+  Context context_;
+  Context previous_;
+  uint64_t parent_ = 0;
+  uint64_t start_ = 0;
+  std::string attrs_;
+  bool ended_ = false;
+};
+
+/**
+ * Makes context the current one of this thread until destruction, e.g. to
+ * continue a trace in a task run by another thread.
+ */
+class Scope {
+ public:
+  explicit Scope(const Context &context);
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+ private:
+  Context previous_;
+};
+
+}  // namespace tracing
+
+#endif  // IROHA_TRACING_HPP
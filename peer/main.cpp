@@ -16,15 +16,21 @@ limitations under the License.
 
 #include <csignal>
 #include <atomic>
+#include <chrono>
 #include <thread>
 
 #include <service/connection.hpp>
 #include <consensus/sumeragi.hpp>
+#include <membership_service/hijiri.hpp>
+#include <infra/config/iroha_config_with_json.hpp>
 #include <infra/config/peer_service_with_json.hpp>
+#include <infra/service/http_server.hpp>
 #include <utils/logger.hpp>
+#include <utils/tracing.hpp>
 #include <ametsuchi/repository.hpp>
 
 std::atomic_bool running(true);
+std::atomic_bool reloadRequested(false);
 
 
 void signalHandler(int param) {;
@@ -32,10 +38,16 @@ void signalHandler(int param) {;
   exit(0);
 }
 
+// only flags the reload, config is parsed outside of the signal handler
+void reloadHandler(int) { reloadRequested = true; }
+
 int main() {
   if(std::signal(SIGINT, signalHandler) == SIG_ERR){
     logger::error("main") << "'SIGINT' Signal setting error!";
   }
+  if(std::signal(SIGHUP, reloadHandler) == SIG_ERR){
+    logger::error("main") << "'SIGHUP' Signal setting error!";
+  }
 
   if (getenv("IROHA_HOME") == nullptr) {
     logger::error("main") << "You must set IROHA_HOME!";
@@ -45,10 +57,28 @@ int main() {
   repository::init();
 
   logger::setLogLevel(logger::LogLevel::Debug);
+  // lines are written by a background thread from here on
+  logger::startAsync();
+
+  // spans of the sampled transactions, Chrome trace event format
+  const auto sampleRate =
+      config::IrohaConfigManager::getInstance().getTracingSampleRate(0);
+  if (sampleRate > 0 &&
+      !tracing::start(config::IrohaConfigManager::getInstance().getTracingFile(
+                          "/tmp/iroha_trace.json"),
+                      sampleRate,
+                      config::PeerServiceConfig::getInstance().getMyIp())) {
+    logger::error("main") << "can't open the trace file, tracing is off";
+  }
 
   connection::initialize();
   repository::front_repository::initialize_repository();
   sumeragi::initializeSumeragi();
+  peer::hijiri::start();
+  // GET /metrics, Prometheus text format
+  http_server::start(
+      config::IrohaConfigManager::getInstance().getHttpAddress("127.0.0.1"),
+      config::IrohaConfigManager::getInstance().getHttpPortNumber(1204));
   // peer::izanami::startIzanami();
 
   std::thread check_server([&](){
@@ -63,10 +93,26 @@ int main() {
           }
       }
   });
+  // values read per message follow a reload, ones sized at startup
+  // (thread pools, listening port, validator set) keep their first value
+  std::thread reloader([&](){
+      while (running){
+          if (reloadRequested.exchange(false)){
+              config::IrohaConfigManager::getInstance().reload();
+              config::PeerServiceConfig::getInstance().reload();
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      }
+  });
   connection::run();
   logger::info("main") << "check_server.detach()";
   running = false;
+  peer::hijiri::stop();
+  http_server::stop();
+  tracing::stop();
   check_server.join();
+  reloader.join();
   logger::info("main") << "Finish";
+  logger::stopAsync();
   return 0;
 }
@@ -20,6 +20,7 @@
 #include <endpoint_generated.h>
 #include <ametsuchi/exception.h>
 #include "../generator/tx_generator.h"
+#include <cstring>
 
 class Ametsuchi_Test : public ::testing::Test {
  protected:
@@ -337,4 +338,41 @@ TEST_F(Ametsuchi_Test, PeerTest) {
 
   ametsuchi_.commit();
 
-}
\ No newline at end of file
+}
+TEST_F(Ametsuchi_Test, TransactionRangeTest) {
+  std::vector<std::vector<uint8_t>> blobs;
+  for (int i = 0; i < 5; i++) {
+    flatbuffers::FlatBufferBuilder fbb(2048);
+    blobs.push_back(generator::random_transaction(
+        fbb, iroha::Command::AccountAdd,
+        generator::random_AccountAdd(
+            fbb, generator::random_account(std::to_string(i))).Union()));
+    ametsuchi_.append(&blobs.back());
+  }
+
+  // not committed yet
+  ASSERT_EQ(ametsuchi_.getTransactionCount(), 0);
+  ASSERT_EQ(ametsuchi_.getTransactionCount(true), 5);
+  ametsuchi_.commit();
+  ASSERT_EQ(ametsuchi_.getTransactionCount(), 5);
+
+  std::vector<size_t> visited;
+  ametsuchi_.getTransactionRange(
+      2, 5, [&](size_t index, const ametsuchi::AM_val &tx) {
+        const auto &blob = blobs[index - 1];
+        EXPECT_EQ(tx.size, blob.size());
+        EXPECT_EQ(std::memcmp(tx.data, blob.data(), blob.size()), 0);
+        visited.push_back(index);
+        return true;
+      });
+  ASSERT_EQ(visited, std::vector<size_t>({2, 3, 4}));
+
+  // stops when visit returns false
+  visited.clear();
+  ametsuchi_.getTransactionRange(1, 100,
+                                 [&](size_t index, const ametsuchi::AM_val &) {
+                                   visited.push_back(index);
+                                   return index < 2;
+                                 });
+  ASSERT_EQ(visited, std::vector<size_t>({1, 2}));
+}
@@ -154,6 +154,39 @@ TEST(NaiveMerkle, Tree128_100k_pushes) {
   SUCCEED();
 }
 
+TEST(NaiveMerkle, RootOfRange) {
+  ASSERT_EQ(MerkleTree::root_of({}), hash_t{});
+  ASSERT_EQ(MerkleTree::root_of({h}), h);
+
+  // a full range is the root of the tree holding it
+  ASSERT_EQ(MerkleTree::root_of({h, h}), roots[1]);
+  ASSERT_EQ(MerkleTree::root_of({h, h, h, h}), roots[3]);
+
+  // an odd node is carried up unchanged
+  auto hh = MerkleTree::hash(h, h);
+  ASSERT_EQ(MerkleTree::root_of({h, h, h}), MerkleTree::hash(hh, h));
+  ASSERT_EQ(MerkleTree::root_of({h, h, h}), roots[2]);
+}
+
+TEST(NaiveMerkle, LevelOfRange) {
+  auto hh = MerkleTree::hash(h, h);
+  std::vector<hash_t> leafs(5, h);
+
+  ASSERT_EQ(MerkleTree::level_of(leafs, 0), leafs);
+  ASSERT_EQ(MerkleTree::level_of(leafs, 1), std::vector<hash_t>({hh, hh, h}));
+  ASSERT_EQ(MerkleTree::level_of(leafs, 2),
+            std::vector<hash_t>({roots[3], h}));
+
+  // the top level is the root
+  ASSERT_EQ(MerkleTree::level_of(leafs, 3),
+            std::vector<hash_t>({MerkleTree::root_of(leafs)}));
+  ASSERT_EQ(MerkleTree::level_of(leafs, 10), MerkleTree::level_of(leafs, 3));
+
+  // an aligned part of the leafs gives the same nodes
+  ASSERT_EQ(MerkleTree::level_of({h, h}, 1)[0],
+            MerkleTree::level_of(leafs, 1)[1]);
+}
+
 // TODO(@warchant): add more tests, which use different combinations of block
 // size and number of trees. Add more tests for rollback.
 
@@ -0,0 +1,89 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ametsuchi/permission_index.h>
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace ametsuchi::permission;
+
+class PermissionIndex_Test : public ::testing::Test {
+ protected:
+  std::vector<std::unique_ptr<flatbuffers::FlatBufferBuilder>> buffers_;
+  size_t loads_ = 0;
+
+  ametsuchi::PermissionIndex index_;
+
+  // "alice" can read and transfer l1/d1/dollar, nobody else has permissions
+  PermissionIndex_Test()
+      : index_([this](const flatbuffers::String *pubKey,
+                      const ametsuchi::PermissionIndex::Visitor &visit) {
+          loads_++;
+          if (pubKey->str() == "alice") visit(permission(true, true));
+        }) {}
+
+  const ::iroha::AccountPermissionAsset *permission(bool read, bool transfer) {
+    buffers_.emplace_back(new flatbuffers::FlatBufferBuilder());
+    auto &fbb = *buffers_.back();
+    fbb.Finish(::iroha::CreateAccountPermissionAssetDirect(
+        fbb, "dollar", "d1", "l1", false, transfer, false, false, read));
+    return flatbuffers::GetRoot<::iroha::AccountPermissionAsset>(
+        fbb.GetBufferPointer());
+  }
+
+  const flatbuffers::String *str(const std::string &s) {
+    buffers_.emplace_back(new flatbuffers::FlatBufferBuilder());
+    auto &fbb = *buffers_.back();
+    fbb.Finish(fbb.CreateString(s));
+    return flatbuffers::GetRoot<flatbuffers::String>(fbb.GetBufferPointer());
+  }
+};
+
+TEST_F(PermissionIndex_Test, ReturnsCapabilities) {
+  auto mask = index_.get(str("alice"), str("l1"), str("d1"), str("dollar"));
+  ASSERT_EQ(mask, READ | TRANSFER);
+
+  ASSERT_EQ(index_.get(str("alice"), str("l1"), str("d1"), str("yen")), 0);
+  ASSERT_EQ(index_.get(str("bob"), str("l1"), str("d1"), str("dollar")), 0);
+}
+
+TEST_F(PermissionIndex_Test, LoadsAccountOnce) {
+  index_.get(str("alice"), str("l1"), str("d1"), str("dollar"));
+  index_.get(str("alice"), str("l1"), str("d1"), str("dollar"));
+  index_.get(str("alice"), str("l1"), str("d1"), str("yen"));
+  ASSERT_EQ(loads_, 1);
+}
+
+TEST_F(PermissionIndex_Test, DoesNotMixUpNameBoundaries) {
+  // "l1d" + "1" must not hit "l1" + "d1"
+  ASSERT_EQ(index_.get(str("alice"), str("l1d"), str("1"), str("dollar")), 0);
+}
+
+TEST_F(PermissionIndex_Test, InvalidateReloadsAccount) {
+  index_.get(str("alice"), str("l1"), str("d1"), str("dollar"));
+  index_.get(str("bob"), str("l1"), str("d1"), str("dollar"));
+  ASSERT_EQ(loads_, 2);
+
+  index_.invalidate(str("alice"));
+  index_.get(str("alice"), str("l1"), str("d1"), str("dollar"));
+  index_.get(str("bob"), str("l1"), str("d1"), str("dollar"));
+  ASSERT_EQ(loads_, 3);
+
+  index_.invalidate(nullptr);
+  index_.get(str("bob"), str("l1"), str("d1"), str("dollar"));
+  ASSERT_EQ(loads_, 4);
+}
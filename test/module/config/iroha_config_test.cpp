@@ -0,0 +1,56 @@
+/*
+Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <gtest/gtest.h>
+#include <infra/config/iroha_config_with_json.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace {
+void writeConfig(const std::string &home, const std::string &json) {
+  std::ofstream(home + "/config/config.json") << json;
+}
+}  // namespace
+
+TEST(IrohaConfigManager, valuesFollowReload) {
+  const std::string home = "/tmp/iroha_config_test";
+  mkdir(home.c_str(), 0755);
+  mkdir((home + "/config").c_str(), 0755);
+  setenv("IROHA_HOME", home.c_str(), 1);
+
+  writeConfig(home, R"({"grpc_port": 50052, "verify_relay_fanout": "two"})");
+  auto &config = config::IrohaConfigManager::getInstance();
+  const auto before = config.values();
+  ASSERT_EQ(before->grpcPort, 50052);
+  // mistyped values fall back to the default
+  ASSERT_EQ(before->verifyRelayFanout, 0);
+  ASSERT_EQ(config.getGrpcPortNumber(50051), 50052);
+
+  writeConfig(home, R"({"grpc_port": 50053, "verify_relay_fanout": 2})");
+  ASSERT_TRUE(config.reload());
+  ASSERT_EQ(config.values()->grpcPort, 50053);
+  ASSERT_EQ(config.values()->verifyRelayFanout, 2);
+  ASSERT_EQ(config.getGrpcPortNumber(50051), 50053);
+  // a snapshot taken before the reload does not change
+  ASSERT_EQ(before->grpcPort, 50052);
+
+  // an invalid file keeps the current values
+  writeConfig(home, "{ not json");
+  ASSERT_FALSE(config.reload());
+  ASSERT_EQ(config.values()->grpcPort, 50053);
+}
@@ -26,6 +26,7 @@
 #include <service/connection.hpp>
 
 #include <grpc++/grpc++.h>
+#include <atomic>
 #include <iostream>
 #include <string>
 #include <thread>
@@ -61,9 +62,19 @@ class connection_with_grpc_flatbuffer_test : public testing::Test {
           std::cout << flatbuffer_service::toString(*txroot) << std::endl;
         });
 
+    connection::iroha::SumeragiImpl::ToriiBatch::receive(
+        [](const std::string& from, const iroha::TransactionBatch& batch) {
+          std::vector<iroha::Code> codes;
+          for (const auto wrapper : *batch.transactions()) {
+            codes.push_back(wrapper->tx() == nullptr ? iroha::Code::FAIL
+                                                     : iroha::Code::UNDECIDED);
+          }
+          return codes;
+        });
+
     connection::iroha::AssetRepositoryImpl::AccountGetAsset::receive([=](
-            const std::string & /* from */, flatbuffers::unique_ptr_t &&query_ptr) -> std::vector<const ::iroha::Asset *>{
-        const iroha::AssetQuery& query = *flatbuffers::GetRoot<iroha::AssetQuery>(query_ptr.get());
+            const std::string & /* from */, const iroha::AssetQuery& query,
+            const connection::iroha::AssetRepositoryImpl::AccountGetAsset::AssetVisitor& visit) {
         flatbuffers::FlatBufferBuilder fbb;
 
         EXPECT_STREQ(query.pubKey()->c_str(),     "my_pubkey");
@@ -78,10 +89,7 @@ class connection_with_grpc_flatbuffer_test : public testing::Test {
               ).Union()
         );
         fbb.Finish(res_asset);
-        std::vector<const ::iroha::Asset *> res{
-            flatbuffers::GetMutableRoot<::iroha::Asset>(fbb.GetBufferPointer())
-        };
-        return res;
+        visit(fbb.GetBufferPointer(), fbb.GetSize());
     });
 
     connection::run();
@@ -167,30 +175,233 @@ TEST_F(connection_with_grpc_flatbuffer_test, AssetRepository_serverAccountGetAss
   auto res = response.GetRoot();
 
   ASSERT_EQ(res->assets()->Length(), 1);
-  ASSERT_EQ(res->assets()->Get(0)->asset_type(), iroha::AnyAsset::Currency);
+  ASSERT_EQ(res->assets()->Get(0)->asset_nested_root()->asset_type(), iroha::AnyAsset::Currency);
   ASSERT_STREQ(
-     res->assets()->Get(0)->asset_as_Currency()->currency_name()->c_str(),
+     res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->currency_name()->c_str(),
      "sample"
   );
   ASSERT_STREQ(
-      res->assets()->Get(0)->asset_as_Currency()->domain_name()->c_str(),
+      res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->domain_name()->c_str(),
       "my_domain"
   );
   ASSERT_STREQ(
-      res->assets()->Get(0)->asset_as_Currency()->ledger_name()->c_str(),
+      res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->ledger_name()->c_str(),
       "my_ledger"
   );
   ASSERT_STREQ(
-      res->assets()->Get(0)->asset_as_Currency()->description()->c_str(),
+      res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->description()->c_str(),
       "my_description"
   );
   ASSERT_STREQ(
-      res->assets()->Get(0)->asset_as_Currency()->amount()->c_str(),
+      res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->amount()->c_str(),
       "my_amount"
   );
   ASSERT_EQ(
-      res->assets()->Get(0)->asset_as_Currency()->precision(),
+      res->assets()->Get(0)->asset_nested_root()->asset_as_Currency()->precision(),
       0
   );
 
 }
+
+TEST_F(connection_with_grpc_flatbuffer_test, AssetRepository_concurrentAccountGetAsset) {
+  // calls are served by the completion queue threads and the handler pool
+  auto channel = grpc::CreateChannel(
+     "0.0.0.0:50051",
+     grpc::InsecureChannelCredentials()
+  );
+
+  std::vector<std::thread> clients;
+  std::atomic<int> succeeded(0);
+  for (int i = 0; i < 8; i++) {
+    clients.emplace_back([&] {
+      auto stub = iroha::AssetRepository::NewStub(channel);
+      grpc::ClientContext context;
+
+      flatbuffers::FlatBufferBuilder fbb;
+      fbb.Finish(iroha::CreateAssetQueryDirect(
+          fbb, "my_pubkey", "req_ledger_name", "req_domain_name",
+          "req_asset_name", true));
+      auto request = flatbuffers::BufferRef<iroha::AssetQuery>(
+          fbb.GetBufferPointer(), fbb.GetSize());
+      flatbuffers::BufferRef<iroha::AssetResponse> response;
+      if (stub->AccountGetAsset(&context, request, &response).ok() &&
+          response.GetRoot()->assets()->Length() == 1) {
+        succeeded++;
+      }
+    });
+  }
+  for (auto& client : clients) client.join();
+
+  ASSERT_EQ(succeeded, 8);
+}
+
+TEST_F(connection_with_grpc_flatbuffer_test, Sumeragi_VerifyStreamAcksAndResumes) {
+  auto channel = grpc::CreateChannel(
+     "0.0.0.0:50051",
+     grpc::InsecureChannelCredentials()
+  );
+  auto stub = iroha::Sumeragi::NewStub(channel);
+
+  flatbuffers::FlatBufferBuilder xbb;
+  const auto assetBuf = flatbuffer_service::asset::CreateCurrency(
+      "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+  const auto add = ::iroha::CreateAddDirect(xbb, "AccPubKey", &assetBuf);
+  xbb.Finish(iroha::CreateTransactionDirect(
+      xbb, "TX'S CREATOR", iroha::Command::Add, add.Union()));
+  auto event = flatbuffer_service::toConsensusEvent(
+      *flatbuffers::GetRoot<Transaction>(xbb.GetBufferPointer()));
+  ASSERT_TRUE(event);
+  flatbuffers::unique_ptr_t eventBuf;
+  event.move_value(eventBuf);
+  flatbuffers::FlatBufferBuilder ebb;
+  ebb.Finish(*flatbuffer_service::copyConsensusEvent(
+      ebb, *flatbuffers::GetRoot<ConsensusEvent>(eventBuf.get())));
+  const std::vector<uint8_t> eventBytes(
+      ebb.GetBufferPointer(), ebb.GetBufferPointer() + ebb.GetSize());
+
+  auto frame = [](flatbuffers::FlatBufferBuilder& fbb, uint64_t round,
+                  const std::vector<uint8_t>* event) {
+    fbb.Clear();
+    fbb.Finish(iroha::CreateVerifyFrameDirect(fbb, "stream_test_peer", 42,
+                                              round, event));
+    return flatbuffers::BufferRef<iroha::VerifyFrame>(fbb.GetBufferPointer(),
+                                                      fbb.GetSize());
+  };
+
+  flatbuffers::FlatBufferBuilder fbb;
+  flatbuffers::BufferRef<iroha::VerifyAck> ack;
+  uint32_t window;
+  {
+    grpc::ClientContext context;
+    auto stream = stub->VerifyStream(&context);
+    ASSERT_TRUE(stream->Write(frame(fbb, 0, nullptr)));
+    ASSERT_TRUE(stream->Read(&ack));
+    ASSERT_EQ(ack.GetRoot()->round(), 0);
+    window = ack.GetRoot()->credit();
+    ASSERT_GT(window, 0);
+
+    // acks are cumulative, one per half window
+    const uint32_t half = std::max(1u, window / 2);
+    for (uint64_t round = 1; round <= half; round++) {
+      ASSERT_TRUE(stream->Write(frame(fbb, round, &eventBytes)));
+    }
+    flatbuffers::BufferRef<iroha::VerifyAck> batchAck;
+    ASSERT_TRUE(stream->Read(&batchAck));
+    ASSERT_EQ(batchAck.GetRoot()->round(), half);
+    stream->WritesDone();
+    ASSERT_TRUE(stream->Finish().ok());
+  }
+  {
+    // a reconnect of the same session resumes after the delivered round
+    grpc::ClientContext context;
+    auto stream = stub->VerifyStream(&context);
+    ASSERT_TRUE(stream->Write(frame(fbb, 0, nullptr)));
+    flatbuffers::BufferRef<iroha::VerifyAck> resumeAck;
+    ASSERT_TRUE(stream->Read(&resumeAck));
+    ASSERT_EQ(resumeAck.GetRoot()->round(), std::max(1u, window / 2));
+    stream->WritesDone();
+    ASSERT_TRUE(stream->Finish().ok());
+  }
+}
+
+namespace {
+  // three transactions, the second one without its body
+  flatbuffers::BufferRef<iroha::TransactionBatch> makeBatch(
+      flatbuffers::FlatBufferBuilder& fbb) {
+    flatbuffers::FlatBufferBuilder xbb;
+    const auto assetBuf = flatbuffer_service::asset::CreateCurrency(
+        "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+    const auto add = ::iroha::CreateAddDirect(xbb, "AccPubKey", &assetBuf);
+    xbb.Finish(iroha::CreateTransactionDirect(
+        xbb, "TX'S CREATOR", iroha::Command::Add, add.Union()));
+
+    fbb.Clear();
+    std::vector<flatbuffers::Offset<iroha::TransactionWrapper>> wrappers;
+    for (int i = 0; i < 3; i++) {
+      wrappers.push_back(
+          i == 1 ? iroha::CreateTransactionWrapper(fbb)
+                 : iroha::CreateTransactionWrapper(
+                       fbb, fbb.CreateVector(xbb.GetBufferPointer(),
+                                             xbb.GetSize())));
+    }
+    fbb.Finish(iroha::CreateTransactionBatchDirect(fbb, &wrappers));
+    return flatbuffers::BufferRef<iroha::TransactionBatch>(
+        fbb.GetBufferPointer(), fbb.GetSize());
+  }
+}
+
+TEST_F(connection_with_grpc_flatbuffer_test, Sumeragi_ToriiBatchCodesEachTransaction) {
+  auto channel = grpc::CreateChannel(
+     "0.0.0.0:50051",
+     grpc::InsecureChannelCredentials()
+  );
+  auto stub = iroha::Sumeragi::NewStub(channel);
+
+  flatbuffers::FlatBufferBuilder fbb;
+  grpc::ClientContext context;
+  flatbuffers::BufferRef<iroha::BatchResponse> response;
+  ASSERT_TRUE(stub->ToriiBatch(&context, makeBatch(fbb), &response).ok());
+
+  auto codes = response.GetRoot()->codes();
+  ASSERT_EQ(codes->size(), 3);
+  ASSERT_EQ(codes->Get(0), static_cast<uint8_t>(iroha::Code::UNDECIDED));
+  ASSERT_EQ(codes->Get(1), static_cast<uint8_t>(iroha::Code::FAIL));
+  ASSERT_EQ(codes->Get(2), static_cast<uint8_t>(iroha::Code::UNDECIDED));
+}
+
+TEST_F(connection_with_grpc_flatbuffer_test, Sumeragi_ToriiStreamCodesEveryBatch) {
+  auto channel = grpc::CreateChannel(
+     "0.0.0.0:50051",
+     grpc::InsecureChannelCredentials()
+  );
+  auto stub = iroha::Sumeragi::NewStub(channel);
+
+  flatbuffers::FlatBufferBuilder fbb;
+  grpc::ClientContext context;
+  flatbuffers::BufferRef<iroha::BatchResponse> response;
+  auto writer = stub->ToriiStream(&context, &response);
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(writer->Write(makeBatch(fbb)));
+  }
+  writer->WritesDone();
+  ASSERT_TRUE(writer->Finish().ok());
+
+  auto codes = response.GetRoot()->codes();
+  ASSERT_EQ(codes->size(), 12);
+  for (size_t i = 0; i < codes->size(); i++) {
+    ASSERT_EQ(codes->Get(i),
+              static_cast<uint8_t>(i % 3 == 1 ? iroha::Code::FAIL
+                                              : iroha::Code::UNDECIDED));
+  }
+}
+
+TEST(RelayTree, ReachesEveryPeerOnceInLogDepth) {
+  std::vector<std::string> peers;
+  for (int i = 0; i < 25; i++) peers.push_back("10.0.0." + std::to_string(i));
+
+  for (const auto& origin : {peers[0], peers[7], peers[24]}) {
+    std::unordered_map<std::string, int> reached{{origin, 0}};
+    std::vector<std::string> frontier{origin};
+    int depth = 0;
+    while (!frontier.empty()) {
+      std::vector<std::string> next;
+      for (const auto& peer : frontier) {
+        for (const auto& child :
+             connection::iroha::SumeragiImpl::Verify::relayChildren(
+                 peers, origin, peer, 3)) {
+          ASSERT_EQ(reached.count(child), 0);
+          reached[child] = depth + 1;
+          next.push_back(child);
+        }
+      }
+      frontier = std::move(next);
+      if (!frontier.empty()) depth++;
+    }
+    ASSERT_EQ(reached.size(), peers.size());
+    // 1 + 3 + 9 < 25 <= 1 + 3 + 9 + 27
+    ASSERT_EQ(depth, 3);
+  }
+
+  ASSERT_TRUE(connection::iroha::SumeragiImpl::Verify::relayChildren(
+                  peers, peers[0], peers[0], 0).empty());
+}
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include <crypto/base64.hpp>
+#include <utils/exception.hpp>
 
 #include <gtest/gtest.h>
 #include <iostream>
@@ -165,3 +166,50 @@ TEST(Base64, HennaMozi) {
   int original_text_length = strlen((char*)original);
   test_text_equals_original_text(original, original_text_length);
 }
+
+TEST(Base64, EncodeAndDecodeEveryLength) {
+  // crosses the vector block sizes and every padding case
+  std::vector<unsigned char> message;
+  for (size_t i = 0; i < 200; i++) {
+    ASSERT_EQ(message, base64::decode(base64::encode(message)));
+    message.push_back(static_cast<unsigned char>(i * 37 + 11));
+  }
+}
+
+TEST(Base64, EncodeKnownVectors) {
+  // RFC 4648 section 10
+  auto enc = [](const std::string& s) {
+    return base64::encode(std::vector<unsigned char>(s.begin(), s.end()));
+  };
+  ASSERT_EQ("", enc(""));
+  ASSERT_EQ("Zg==", enc("f"));
+  ASSERT_EQ("Zm8=", enc("fo"));
+  ASSERT_EQ("Zm9v", enc("foo"));
+  ASSERT_EQ("Zm9vYg==", enc("foob"));
+  ASSERT_EQ("Zm9vYmE=", enc("fooba"));
+  ASSERT_EQ("Zm9vYmFy", enc("foobar"));
+}
+
+TEST(Base64, DecodeAcceptsUnpaddedInput) {
+  auto dec = [](const std::string& s) {
+    const auto bytes = base64::decode(s);
+    return std::string(bytes.begin(), bytes.end());
+  };
+  ASSERT_EQ("f", dec("Zg"));
+  ASSERT_EQ("fo", dec("Zm8"));
+  ASSERT_EQ("foob", dec("Zm9vYg"));
+}
+
+TEST(Base64, DecodeRejectsInvalidInput) {
+  const std::string long_prefix(64, 'A');
+  for (const std::string& invalid :
+       {std::string("A"), std::string("AB="), std::string("Zg="),
+        std::string("Z==="), std::string("Zg=a"), std::string("Zg==Zg=="),
+        std::string("Zh=="), std::string("Zm9="), std::string("Zm 9v"),
+        std::string("Zm9v\n"), long_prefix + "A-AA", long_prefix + "AAA_",
+        "A*" + long_prefix + "AA"}) {
+    ASSERT_THROW(base64::decode(invalid),
+                 exception::crypto::InvalidBase64Exception)
+        << invalid;
+  }
+}
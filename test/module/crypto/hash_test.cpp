@@ -17,6 +17,8 @@ limitations under the License.
 #include <crypto/hash.hpp>
 
 #include <gtest/gtest.h>
+#include <type_traits>
+#include <unordered_map>
 
 // Test Date cited by https://emn178.github.io/online-tools/
 
@@ -127,3 +129,45 @@ TEST(Hash, sha3_512_RU_text_LOOP) {
         res.c_str());
   }
 }
+
+TEST(Hash, sha3_256_stream_empty_text) {
+  std::string res =
+      "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a";
+  hash::Sha3_256 sha;
+  ASSERT_STREQ(sha.hexdigest().c_str(), res.c_str());
+}
+
+TEST(Hash, sha3_256_stream_equals_oneshot) {
+  std::string res =
+      "cb7c96616a2466df29a1edc2979ef5080945f92d1907c08a55b502eba063d638";
+  hash::Sha3_256 sha;
+  sha.update("Is the Order ");
+  sha.update("a distributed");
+  sha.update("");
+  sha.update(" ledger?");
+  ASSERT_STREQ(sha.hexdigest().c_str(), res.c_str());
+}
+
+TEST(Hash, sha3_256_Hash32_to_hex) {
+  std::string res =
+      "cb7c96616a2466df29a1edc2979ef5080945f92d1907c08a55b502eba063d638";
+  auto digest = hash::sha3_256("Is the Order a distributed ledger?");
+  ASSERT_STREQ(hash::to_hex(digest).c_str(), res.c_str());
+}
+
+TEST(Hash, Hash32_is_value_type) {
+  static_assert(std::is_trivially_copyable<hash::Hash32>::value,
+                "Hash32 should be trivially copyable");
+  static_assert(sizeof(hash::Hash32) == 32, "Hash32 should be 32 bytes");
+
+  auto a = hash::sha3_256("a");
+  auto b = hash::sha3_256("b");
+  auto copy = a;
+  ASSERT_EQ(a, copy);
+  ASSERT_NE(a, b);
+
+  std::unordered_map<hash::Hash32, int> map;
+  map[a] = 1;
+  map[b] = 2;
+  ASSERT_EQ(map[copy], 1);
+}
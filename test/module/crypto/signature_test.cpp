@@ -92,3 +92,21 @@ TEST(Signature, generatedByGO) {
 
   ASSERT_TRUE(signature::verify(signature_b64, message, public_key_b64));
 }
+
+TEST(Signature, malformedInputIsRejected) {
+  signature::KeyPair keyPair = signature::generateKeyPair();
+  const std::string message = "message";
+  const auto signature_b64 = signature::sign(message, keyPair);
+  const auto public_key_b64 = base64::encode(keyPair.publicKey);
+  ASSERT_TRUE(signature::verify(signature_b64, message, public_key_b64));
+
+  // not base64
+  ASSERT_FALSE(signature::verify("*", message, public_key_b64));
+  ASSERT_FALSE(signature::verify(signature_b64, message, "*"));
+  // valid base64 of the wrong size
+  ASSERT_FALSE(signature::verify(signature_b64.substr(0, 8), message,
+                                 public_key_b64));
+  ASSERT_FALSE(signature::verify(signature_b64, message,
+                                 public_key_b64.substr(0, 8)));
+  ASSERT_FALSE(signature::verify("", message, ""));
+}
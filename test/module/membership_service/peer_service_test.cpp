@@ -21,6 +21,8 @@
 
 #include <gtest/gtest.h>
 #include <membership_service/peer_service.hpp>
+#include <membership_service/hijiri.hpp>
+#include <infra/config/peer_service_with_json.hpp>
 
 
 TEST(peer_service_test, initialize_peer_test) {
@@ -134,4 +136,66 @@ TEST(peer_service_test, leader_peer_check_test) {
     }
   }
   ASSERT_TRUE(::peer::myself::isLeader());
-}
\ No newline at end of file
+}
+
+TEST(peer_service_test, hijiri_trust_follows_latency_test) {
+  ::peer::hijiri::Measurement fast, slow, lossy;
+  fast.rttMillis = 1.0;
+  slow.rttMillis = 50.0;
+  lossy.rttMillis = 1.0;
+  lossy.responseRate = 0.5;
+
+  ASSERT_GT(::peer::hijiri::trustOf(fast), ::peer::hijiri::trustOf(slow));
+  ASSERT_GT(::peer::hijiri::trustOf(fast), ::peer::hijiri::trustOf(lossy));
+  ASSERT_DOUBLE_EQ(::peer::hijiri::trustOf(::peer::hijiri::Measurement()),
+                   config::PeerServiceConfig::getInstance().getMaxTrustScore());
+}
+
+TEST(peer_service_test, registry_snapshot_is_immutable_test) {
+  auto before = ::peer::service::registry();
+  const auto n = before->all.size();
+  peer::Node peer5 = peer::Node("ip_5", "publicKey5", 10.0, "ledger", true);
+  ASSERT_TRUE(::peer::transaction::executor::add(peer5));
+  ASSERT_EQ(before->all.size(), n);
+  ASSERT_EQ(::peer::service::registry()->all.size(), n + 1);
+  ASSERT_EQ(::peer::service::findPeerIP("ip_5")->publicKey, "publicKey5");
+  ASSERT_EQ(::peer::service::findPeerPublicKey("publicKey5")->ip, "ip_5");
+
+  ASSERT_TRUE(::peer::transaction::executor::setTrust("publicKey5", 1.0));
+  ASSERT_EQ(before->byIp.count("ip_5"), 0);
+  ASSERT_EQ(::peer::service::findPeerIP("ip_5")->trust, 1.0);
+
+  ASSERT_TRUE(::peer::transaction::executor::remove("publicKey5"));
+  ASSERT_EQ(::peer::service::findPeerIP("ip_5"), nullptr);
+}
+
+TEST(peer_service_test, reported_trust_is_the_median_test) {
+  for (auto i = 1; i <= 3; i++) {
+    ASSERT_TRUE(::peer::transaction::executor::add(peer::Node(
+        "ip_observer" + std::to_string(i), "observer" + std::to_string(i),
+        10.0, "ledger", true)));
+  }
+  ASSERT_TRUE(::peer::transaction::executor::add(
+      peer::Node("ip_observed", "observed", 10.0, "ledger", true)));
+
+  ASSERT_TRUE(::peer::transaction::executor::reportTrust("observer1", "observed", 10.0));
+  ASSERT_EQ(::peer::service::findPeerPublicKey("observed")->trust, 10.0);
+  ASSERT_TRUE(::peer::transaction::executor::reportTrust("observer2", "observed", 90.0));
+  ASSERT_EQ(::peer::service::findPeerPublicKey("observed")->trust, 50.0);
+  ASSERT_TRUE(::peer::transaction::executor::reportTrust("observer3", "observed", 20.0));
+  ASSERT_EQ(::peer::service::findPeerPublicKey("observed")->trust, 20.0);
+
+  // a later report replaces the observer's own, not the others'
+  ASSERT_TRUE(::peer::transaction::executor::reportTrust("observer2", "observed", 30.0));
+  ASSERT_EQ(::peer::service::findPeerPublicKey("observed")->trust, 20.0);
+
+  // only peers report, and the reports of removed peers no longer count
+  ASSERT_FALSE(::peer::transaction::executor::reportTrust("stranger", "observed", 0.0));
+  ASSERT_TRUE(::peer::transaction::executor::remove("observer3"));
+  ASSERT_TRUE(::peer::transaction::executor::reportTrust("observer1", "observed", 10.0));
+  ASSERT_EQ(::peer::service::findPeerPublicKey("observed")->trust, 20.0);
+
+  for (auto key : {"observer1", "observer2", "observed"}) {
+    ASSERT_TRUE(::peer::transaction::executor::remove(key));
+  }
+}
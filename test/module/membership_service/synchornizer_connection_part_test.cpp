@@ -59,7 +59,7 @@ class synchornizer_connection_part_test : public ::testing::Test {
 
 TEST_F(synchornizer_connection_part_test, checkHashAllTest) {
   std::string ip = ::peer::myself::getIp();
-  std::string hash = repository::getMerkleRoot();
+  std::string hash = hash::to_hex(repository::getMerkleRoot());
   std::cout << ip << " " << hash << std::endl;
   auto vec = flatbuffer_service::endpoint::CreatePing(hash, ip);
   auto &ping = *flatbuffers::GetRoot<iroha::Ping>(vec.data());
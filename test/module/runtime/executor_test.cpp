@@ -0,0 +1,181 @@
+/*
+Copyright Soramitsu Co., Ltd. 2016 All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <ametsuchi/repository.hpp>
+#include <runtime/executor.hpp>
+#include "../../ametsuchi/generator/tx_generator.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <unistd.h>
+
+using runtime::executor::AccessSet;
+using runtime::executor::findConflicts;
+
+AccessSet makeSet(std::set<std::string> reads, std::set<std::string> writes) {
+  AccessSet set;
+  set.reads = reads;
+  set.writes = writes;
+  return set;
+}
+
+TEST(Executor, DisjointTransactionsDoNotConflict) {
+  auto conflicts = findConflicts({
+      makeSet({"account/a"}, {"account/a"}),
+      makeSet({"account/b"}, {"account/b"}),
+      makeSet({"account/c", "asset/l/d/x"}, {"account/d"}),
+  });
+  ASSERT_EQ(conflicts, std::vector<bool>({false, false, false}));
+}
+
+TEST(Executor, ReadAfterWriteConflicts) {
+  auto conflicts = findConflicts({
+      makeSet({"account/a"}, {"account/b"}),
+      makeSet({"account/b"}, {"account/c"}),
+      makeSet({"account/a"}, {}),
+  });
+  ASSERT_EQ(conflicts, std::vector<bool>({false, true, false}));
+}
+
+TEST(Executor, WriteBeforeReadInBlockOrderOnly) {
+  // the first transaction reads what the second writes: block order keeps
+  // the speculative result valid
+  auto conflicts = findConflicts({
+      makeSet({"account/b"}, {}),
+      makeSet({"account/a"}, {"account/b"}),
+  });
+  ASSERT_EQ(conflicts, std::vector<bool>({false, false}));
+}
+
+TEST(Executor, GlobalTransactionIsOrderedAgainstEverything) {
+  auto global = makeSet({"account/g"}, {});
+  global.global = true;
+
+  auto conflicts = findConflicts({
+      makeSet({"account/a"}, {"account/a"}),
+      global,
+      makeSet({"account/b"}, {"account/b"}),
+  });
+  ASSERT_EQ(conflicts, std::vector<bool>({false, true, true}));
+}
+
+namespace {
+// a fresh store, repository::init() refuses to open an existing one
+void initRepository() {
+  std::remove("/tmp/ametsuchi/data.mdb");
+  std::remove("/tmp/ametsuchi/lock.mdb");
+  rmdir("/tmp/ametsuchi");
+  repository::init();
+}
+
+std::vector<uint8_t> accountAdd(const std::string &pubKey,
+                                const std::vector<uint8_t> &account) {
+  flatbuffers::FlatBufferBuilder fbb;
+  return generator::random_transaction(
+      fbb, iroha::Command::AccountAdd,
+      generator::random_AccountAdd(fbb, account).Union(), 1, pubKey);
+}
+
+std::vector<uint8_t> accountAdd(const std::string &pubKey) {
+  return accountAdd(pubKey, generator::random_account(pubKey));
+}
+
+// an account that can read dollar, and add to it if add
+std::vector<uint8_t> accountWithPermission(const std::string &pubKey,
+                                           bool add) {
+  flatbuffers::FlatBufferBuilder permission;
+  permission.Finish(iroha::CreateAccountPermissionAssetDirect(
+      permission, "dollar", generator::DOMAIN_.c_str(),
+      generator::LEDGER_.c_str(), false, false, add, false, true));
+  std::vector<uint8_t> nested(
+      permission.GetBufferPointer(),
+      permission.GetBufferPointer() + permission.GetSize());
+
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<iroha::AccountPermissionAssetWrapper>>
+      permissions{iroha::CreateAccountPermissionAssetWrapperDirect(fbb, &nested)};
+  fbb.Finish(iroha::CreateAccount(
+      fbb, fbb.CreateString(pubKey), fbb.CreateString(""),
+      fbb.CreateString("alias"), 0, 1, 0, 0, 0, fbb.CreateVector(permissions)));
+  auto ptr = fbb.GetBufferPointer();
+  return {ptr, ptr + fbb.GetSize()};
+}
+
+std::vector<uint8_t> assetCreate(const std::string &creator) {
+  flatbuffers::FlatBufferBuilder fbb;
+  return generator::random_transaction(
+      fbb, iroha::Command::AssetCreate,
+      generator::random_AssetCreate(fbb, "dollar").Union(), 1, creator);
+}
+
+std::vector<uint8_t> add(const std::string &creator,
+                         const std::string &currency = "dollar") {
+  flatbuffers::FlatBufferBuilder fbb;
+  return generator::random_transaction(
+      fbb, iroha::Command::Add,
+      generator::random_Add(
+          fbb, creator,
+          generator::random_asset_wrapper_currency(10, 0, currency))
+          .Union(),
+      1, creator);
+}
+
+const iroha::Transaction *root(const std::vector<uint8_t> &tx) {
+  return flatbuffers::GetRoot<iroha::Transaction>(tx.data());
+}
+}  // namespace
+
+TEST(Executor, ProcessBlockAppendsOnlyValidTransactions) {
+  initRepository();
+
+  const auto alice = generator::random_public_key();
+  const auto bob = generator::random_public_key();
+  const auto addAlice = accountAdd(alice);
+  // alice only exists once the first transaction is appended: the
+  // speculation rejects it, the re-execution in block order accepts it
+  const auto create = assetCreate(alice);
+  // bob never exists
+  const auto addByBob = add(bob, generator::random_string(6));
+
+  auto verdicts =
+      runtime::executor::processBlock({root(addAlice), root(create),
+                                       root(addByBob)});
+  ASSERT_EQ(verdicts, std::vector<bool>({true, true, false}));
+  ASSERT_EQ(repository::getTransactionCount(), 2u);
+  ASSERT_TRUE(repository::existAccountOf(*root(addAlice)->creatorPubKey()));
+  ASSERT_FALSE(repository::existAccountOf(*root(addByBob)->creatorPubKey()));
+}
+
+TEST(Executor, ProcessBlockChecksPermissionsOfCommittedAccounts) {
+  initRepository();
+
+  const auto alice = generator::random_public_key();
+  const auto carol = generator::random_public_key();
+  const auto addAlice = accountAdd(alice, accountWithPermission(alice, true));
+  const auto addCarol = accountAdd(carol, accountWithPermission(carol, false));
+  const auto create = assetCreate(alice);
+  ASSERT_EQ(runtime::executor::processBlock(
+                {root(addAlice), root(addCarol), root(create)}),
+            std::vector<bool>({true, true, true}));
+
+  // the permission index loads both accounts from the committed block
+  const auto addByAlice = add(alice);
+  const auto addByCarol = add(carol);
+  ASSERT_EQ(runtime::executor::processBlock(
+                {root(addByAlice), root(addByCarol)}),
+            std::vector<bool>({true, false}));
+  ASSERT_EQ(repository::getTransactionCount(), 4u);
+}
@@ -18,6 +18,7 @@
 #include <main_generated.h>
 #include <endpoint_generated.h>
 #include <service/flatbuffer_service.h>
+#include <crypto/hash.hpp>
 #include <membership_service/peer_service.hpp>
 #include <utils/datetime.hpp>
 
@@ -1233,4 +1234,125 @@ TEST(FlatbufferServiceTest, EndPoint_Ping_Test) {
   auto &ping = *flatbuffers::GetRoot<iroha::Ping>(vec.data());
   ASSERT_TRUE(ping.message()->str() == "message!");
   ASSERT_TRUE(ping.sender()->str() == "sender!");
-}
\ No newline at end of file
+}
+/*********************************************************
+ * absorbSignedFields
+ *********************************************************/
+std::string digestOfAddTx(const std::string& accPubKey,
+                          const std::string& sigPubKey) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto currencyBuf = flatbuffer_service::asset::CreateCurrency(
+    "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+  std::vector<uint8_t> sigblob = {'a', 'b'};
+  std::vector<flatbuffers::Offset<::iroha::Signature>> signatures{
+    ::iroha::CreateSignatureDirect(fbb, sigPubKey.c_str(), &sigblob, 100000)};
+
+  fbb.Finish(::iroha::CreateTransactionDirect(
+    fbb, "Creator PubKey", iroha::Command::Add,
+    ::iroha::CreateAddDirect(fbb, accPubKey.c_str(), &currencyBuf).Union(),
+    &signatures, nullptr, 100000));
+
+  hash::Sha3_256 sha;
+  flatbuffer_service::transaction::absorbSignedFields(
+    sha, *flatbuffers::GetRoot<::iroha::Transaction>(fbb.GetBufferPointer()));
+  return sha.hexdigest();
+}
+
+TEST(FlatbufferServiceTest, absorbSignedFields_ignoresSignatures) {
+  ASSERT_EQ(digestOfAddTx("AccPubKey", "TxPubKey1"),
+            digestOfAddTx("AccPubKey", "TxPubKey2"));
+}
+
+TEST(FlatbufferServiceTest, absorbSignedFields_coversCommand) {
+  ASSERT_NE(digestOfAddTx("AccPubKey", "TxPubKey1"),
+            digestOfAddTx("AccPubKey2", "TxPubKey1"));
+}
+
+/*********************************************************
+ * toDigestEvent / fromDigestEvent
+ *********************************************************/
+TEST(FlatbufferServiceTest, digestEvent_roundTrip) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto currencyBuf = flatbuffer_service::asset::CreateCurrency(
+    "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+  std::vector<uint8_t> sigblob = {'a', 'b'};
+  std::vector<flatbuffers::Offset<::iroha::Signature>> signatures{
+    ::iroha::CreateSignatureDirect(fbb, "TxPubKey1", &sigblob, 100000)};
+  fbb.Finish(::iroha::CreateTransactionDirect(
+    fbb, "Creator PubKey", iroha::Command::Add,
+    ::iroha::CreateAddDirect(fbb, "AccPubKey", &currencyBuf).Union(),
+    &signatures, nullptr, 100000));
+
+  auto event = flatbuffer_service::toConsensusEvent(
+    *flatbuffers::GetRoot<::iroha::Transaction>(fbb.GetBufferPointer()));
+  ASSERT_TRUE(event);
+  const auto eventptr =
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*event).get());
+  const auto wrapped = eventptr->transactions()->Get(0)->tx();
+  const std::vector<uint8_t> body(wrapped->begin(), wrapped->end());
+
+  auto digestEvent = flatbuffer_service::toDigestEvent(*eventptr);
+  ASSERT_TRUE(digestEvent);
+  const auto digestptr =
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*digestEvent).get());
+  ASSERT_EQ(digestptr->transactions()->size(), 0);
+  ASSERT_EQ(digestptr->digests()->size(), 32);
+
+  auto restored = flatbuffer_service::fromDigestEvent(*digestptr, {body});
+  ASSERT_TRUE(restored);
+  const auto restoredptr =
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*restored).get());
+  ASSERT_EQ(restoredptr->transactions()->size(), 1);
+  const auto tx = restoredptr->transactions()->Get(0)->tx_nested_root();
+  ASSERT_STREQ(tx->creatorPubKey()->c_str(), "Creator PubKey");
+  ASSERT_STREQ(tx->command_as_Add()->accPubKey()->c_str(), "AccPubKey");
+
+  auto tampered = body;
+  tampered.back() ^= 1;
+  ASSERT_FALSE(flatbuffer_service::fromDigestEvent(*digestptr, {tampered}));
+  ASSERT_FALSE(flatbuffer_service::fromDigestEvent(*digestptr, {}));
+}
+
+/*********************************************************
+ * withHeight
+ *********************************************************/
+TEST(FlatbufferServiceTest, withHeight_isKeptThroughTheRound) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto currencyBuf = flatbuffer_service::asset::CreateCurrency(
+    "IROHA", "Domain", "Ledger", "Desc", "31415", 4);
+  fbb.Finish(::iroha::CreateTransactionDirect(
+    fbb, "Creator PubKey", iroha::Command::Add,
+    ::iroha::CreateAddDirect(fbb, "AccPubKey", &currencyBuf).Union(),
+    nullptr, nullptr, 100000));
+
+  auto event = flatbuffer_service::toConsensusEvent(
+    *flatbuffers::GetRoot<::iroha::Transaction>(fbb.GetBufferPointer()));
+  ASSERT_TRUE(event);
+  ASSERT_EQ(
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*event).get())->height(),
+    0);
+
+  auto proposed = flatbuffer_service::withHeight(
+    *flatbuffers::GetRoot<::iroha::ConsensusEvent>((*event).get()), 42);
+  ASSERT_TRUE(proposed);
+  auto signedEvent = flatbuffer_service::addSignature(
+    *flatbuffers::GetRoot<::iroha::ConsensusEvent>((*proposed).get()),
+    "PeerPubKey", "signature");
+  ASSERT_TRUE(signedEvent);
+  const auto signedptr =
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*signedEvent).get());
+  ASSERT_EQ(signedptr->height(), 42);
+
+  auto digestEvent = flatbuffer_service::toDigestEvent(*signedptr);
+  ASSERT_TRUE(digestEvent);
+  ASSERT_EQ(
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*digestEvent).get())
+      ->height(),
+    42);
+
+  auto commit = flatbuffer_service::makeCommit(*signedptr);
+  ASSERT_TRUE(commit);
+  ASSERT_EQ(
+    flatbuffers::GetRoot<::iroha::ConsensusEvent>((*commit).get())->height(),
+    42);
+}
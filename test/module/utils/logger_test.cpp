@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include <gtest/gtest.h>
+#include <utils/datetime.hpp>
 #include <utils/logger.hpp>
 
 TEST(logger, debug) {
@@ -126,3 +127,61 @@ TEST(logger, manyMessages) {
   ASSERT_TRUE(cap.find("[test-module]") != std::string::npos);
   ASSERT_TRUE(cap.find("message1 message2 message3 message4 message5") != std::string::npos);
 }
+
+namespace {
+struct counted {
+  int &count;
+};
+std::ostream &operator<<(std::ostream &os, const counted &c) {
+  c.count++;
+  return os << "counted";
+}
+}  // namespace
+
+TEST(logger, disabledLevelIsNotFormatted) {
+  logger::setLogLevel(logger::LogLevel::Error);
+  int count = 0;
+  testing::internal::CaptureStdout();
+  logger::info("test-module") << counted{count};
+  std::string cap = testing::internal::GetCapturedStdout();
+  ASSERT_EQ(count, 0);
+  ASSERT_TRUE(cap == std::string(""));
+}
+
+TEST(logger, longLineIsCut) {
+  logger::setLogLevel(logger::LogLevel::Debug);
+  testing::internal::CaptureStdout();
+  logger::info("test-module") << std::string(4096, 'x') << "tail";
+  std::string cap = testing::internal::GetCapturedStdout();
+  ASSERT_TRUE(cap.find("...") != std::string::npos);
+  ASSERT_TRUE(cap.find("tail") == std::string::npos);
+}
+
+TEST(logger, longCallerIsKept) {
+  logger::setLogLevel(logger::LogLevel::Debug);
+  const std::string caller = "sumeragi::detail::processTransaction::" +
+                             std::string(64, 'c');
+  testing::internal::CaptureStdout();
+  logger::info(caller) << "message1";
+  std::string cap = testing::internal::GetCapturedStdout();
+  ASSERT_TRUE(cap.find("INFO [" + caller + "] message1\n") !=
+              std::string::npos);
+  // "<unixtime> INFO ..." with the time as datetime::unixtime_str() prints it
+  const auto time = std::stoull(cap.substr(0, cap.find(' ')));
+  ASSERT_LE(time, datetime::unixtime());
+  ASSERT_GE(time + 5, datetime::unixtime());
+}
+
+TEST(logger, async) {
+  logger::setLogLevel(logger::LogLevel::Debug);
+  logger::startAsync();
+  testing::internal::CaptureStdout();
+  for (int i = 0; i < 100; i++) {
+    logger::info("test-module") << "async" << i;
+  }
+  logger::flush();
+  std::string cap = testing::internal::GetCapturedStdout();
+  logger::stopAsync();
+  ASSERT_TRUE(cap.find("INFO [test-module] async0") != std::string::npos);
+  ASSERT_TRUE(cap.find("INFO [test-module] async99") != std::string::npos);
+}
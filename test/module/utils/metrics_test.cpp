@@ -0,0 +1,89 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include <utils/metrics.hpp>
+
+TEST(MetricsTest, HistogramBucketsCoverEveryValue) {
+  using metrics::Histogram;
+  for (uint64_t v = 0; v < (uint64_t(1) << 40); v = v * 3 + 1) {
+    const auto b = Histogram::bucketOf(v);
+    ASSERT_LT(b, Histogram::numBuckets);
+    ASSERT_LT(v, Histogram::upperBound(b));
+    if (b > 0) {
+      ASSERT_GE(v, Histogram::upperBound(b - 1));
+    }
+  }
+  ASSERT_LT(Histogram::bucketOf(~uint64_t(0)), Histogram::numBuckets);
+}
+
+TEST(MetricsTest, HistogramQuantile) {
+  metrics::Histogram histogram(1e-6);
+  for (uint64_t v = 1; v <= 1000; v++) histogram.observe(v);
+  ASSERT_EQ(histogram.count(), 1000u);
+  ASSERT_EQ(histogram.sum(), 500500u);
+  // buckets are at most 25% wide
+  const auto p50 = histogram.quantile(0.5);
+  ASSERT_GE(p50, 500u);
+  ASSERT_LE(p50, 625u);
+}
+
+TEST(MetricsTest, RenderTextFormat) {
+  metrics::counter("test_requests_total", "Requests", {{"peer", "a\"b"}})
+      .inc(3);
+  // same name and labels, same counter
+  metrics::counter("test_requests_total", "Requests", {{"peer", "a\"b"}})
+      .inc();
+  metrics::gauge("test_depth", "Depth").set(-2);
+  metrics::collect("test_read", "Read", metrics::Type::Gauge, {},
+                   [] { return 1.5; });
+  metrics::histogram("test_seconds", "Latency").observe(3);
+
+  const auto text = metrics::render();
+  ASSERT_NE(text.find("# TYPE test_requests_total counter\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("test_requests_total{peer=\"a\\\"b\"} 4\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("test_depth -2\n"), std::string::npos);
+  ASSERT_NE(text.find("test_read 1.5\n"), std::string::npos);
+  ASSERT_NE(text.find("# TYPE test_seconds histogram\n"), std::string::npos);
+  ASSERT_NE(text.find("test_seconds_bucket{le=\"3e-06\"} 1\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("test_seconds_bucket{le=\"+Inf\"} 1\n"),
+            std::string::npos);
+  ASSERT_NE(text.find("test_seconds_count 1\n"), std::string::npos);
+}
+
+TEST(MetricsTest, RenderedBucketsAreInclusive) {
+  auto &histogram = metrics::histogram("test_values", "Values", {}, 1);
+  for (uint64_t v : {0, 1, 3, 4, 8, 9}) histogram.observe(v);
+
+  const auto text = metrics::render();
+  // every count covers the values up to and including its le
+  for (const auto line : {"test_values_bucket{le=\"0\"} 1\n",
+                          "test_values_bucket{le=\"1\"} 2\n",
+                          "test_values_bucket{le=\"2\"} 2\n",
+                          "test_values_bucket{le=\"3\"} 3\n",
+                          "test_values_bucket{le=\"4\"} 4\n",
+                          "test_values_bucket{le=\"7\"} 4\n",
+                          "test_values_bucket{le=\"9\"} 6\n",
+                          "test_values_bucket{le=\"+Inf\"} 6\n",
+                          "test_values_sum 25\n"}) {
+    ASSERT_NE(text.find(line), std::string::npos) << line;
+  }
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <utils/priority_pool.hpp>
+
+using scheduling::Lane;
+using scheduling::PriorityPool;
+using scheduling::PriorityPoolOptions;
+
+namespace {
+PriorityPoolOptions singleWorker() {
+  PriorityPoolOptions options;
+  options.threads = 1;
+  options.reserved = 0;
+  return options;
+}
+}  // namespace
+
+TEST(PriorityPoolTest, ConsensusRunsBeforeQueuedIngress) {
+  PriorityPool pool(singleWorker());
+
+  // keep the only worker busy while both lanes fill up
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  ASSERT_TRUE(pool.process(Lane::Ingress, [released] { released.wait(); }));
+
+  std::mutex mutex;
+  std::vector<int> order;
+  std::promise<void> done;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(pool.process(Lane::Ingress, [&, i] {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(10 + i);
+      if (order.size() == 6) done.set_value();
+    }));
+  }
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(pool.process(Lane::Consensus, [&, i] {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+      if (order.size() == 6) done.set_value();
+    }));
+  }
+  release.set_value();
+  done.get_future().wait();
+
+  ASSERT_EQ(order, (std::vector<int>{0, 1, 2, 10, 11, 12}));
+  ASSERT_EQ(pool.stats(Lane::Consensus).executed, 3u);
+  ASSERT_GE(pool.stats(Lane::Ingress).executed, 3u);
+}
+
+TEST(PriorityPoolTest, FullLaneIsRejected) {
+  auto options = singleWorker();
+  options.queueSize = {{4, 1}};
+  PriorityPool pool(options);
+
+  std::promise<void> started, release;
+  auto released = release.get_future().share();
+  ASSERT_TRUE(pool.process(Lane::Ingress, [&started, released] {
+    started.set_value();
+    released.wait();
+  }));
+  started.get_future().wait();
+
+  ASSERT_TRUE(pool.process(Lane::Ingress, [] {}));
+  ASSERT_FALSE(pool.process(Lane::Ingress, [] {}));
+  // the other lane has its own limit
+  ASSERT_TRUE(pool.process(Lane::Consensus, [] {}));
+
+  auto stats = pool.stats(Lane::Ingress);
+  ASSERT_EQ(stats.depth, 1u);
+  ASSERT_EQ(stats.rejected, 1u);
+  release.set_value();
+}
+
+TEST(PriorityPoolTest, MoveOnlyTask) {
+  PriorityPoolOptions options;
+  options.threads = 2;
+  PriorityPool pool(options);
+  ASSERT_EQ(pool.size(), 2u);
+
+  std::promise<int> result;
+  auto value = std::make_unique<int>(42);
+  ASSERT_TRUE(pool.process(Lane::Consensus,
+                           [&result, v = std::move(value)]() mutable {
+                             result.set_value(*v);
+                           }));
+  ASSERT_EQ(result.get_future().get(), 42);
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright Soramitsu Co., Ltd. 2017 All Rights Reserved.
+ * http://soramitsu.co.jp
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utils/tracing.hpp>
+
+namespace {
+const std::string path = "/tmp/iroha_tracing_test.json";
+
+std::string readTrace() {
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+tracing::TraceId idOf(uint8_t first) {
+  tracing::TraceId id{};
+  id[0] = first;
+  id[15] = 1;
+  return id;
+}
+
+std::string hexOf(uint64_t span) {
+  char buf[17];
+  std::snprintf(buf, sizeof(buf), "%016llx",
+                static_cast<unsigned long long>(span));
+  return buf;
+}
+}  // namespace
+
+TEST(TracingTest, SamplingFollowsTheTraceId) {
+  ASSERT_TRUE(tracing::start(path, 0.5, "peer"));
+  // the id read as a fraction: 0x40.. is 0.25, 0xc0.. is 0.75
+  ASSERT_TRUE(tracing::root(idOf(0x40)).sampled);
+  ASSERT_FALSE(tracing::root(idOf(0xc0)).sampled);
+  tracing::stop();
+  ASSERT_FALSE(tracing::root(idOf(0x40)).sampled);
+}
+
+TEST(TracingTest, SpansNestOnTheirThread) {
+  ASSERT_TRUE(tracing::start(path, 1.0, "peer \"a\""));
+  uint64_t outerSpan, innerSpan;
+  {
+    tracing::Span outer("outer", tracing::root(idOf(0x12)));
+    outer.attr("peer", "10.0.0.1");
+    outerSpan = outer.context().span;
+    ASSERT_EQ(tracing::current().span, outerSpan);
+    {
+      tracing::Span inner("inner");
+      innerSpan = inner.context().span;
+      ASSERT_TRUE(inner.context().sampled);
+    }
+    ASSERT_EQ(tracing::current().span, outerSpan);
+  }
+  ASSERT_FALSE(tracing::current().sampled);
+
+  // nothing is recorded off a trace
+  { tracing::Span orphan("orphan"); }
+  tracing::stop();
+
+  const auto trace = readTrace();
+  ASSERT_EQ(trace.front(), '[');
+  ASSERT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+  ASSERT_NE(trace.find("\"name\":\"peer \\\"a\\\"\""), std::string::npos);
+  ASSERT_NE(trace.find("\"trace\":\"12000000000000000000000000000001\""),
+            std::string::npos);
+  ASSERT_NE(trace.find("\"span\":\"" + hexOf(outerSpan) +
+                       "\",\"parent\":\"0000000000000000\",\"peer\":"
+                       "\"10.0.0.1\""),
+            std::string::npos);
+  ASSERT_NE(trace.find("\"span\":\"" + hexOf(innerSpan) + "\",\"parent\":\"" +
+                       hexOf(outerSpan) + "\""),
+            std::string::npos);
+  ASSERT_EQ(trace.find("orphan"), std::string::npos);
+}
+
+TEST(TracingTest, ScopeContinuesATrace) {
+  ASSERT_TRUE(tracing::start(path, 1.0, "peer"));
+  tracing::Context remote = tracing::root(idOf(0x34));
+  remote.span = 42;
+  const auto queued = tracing::now();
+  tracing::record("queue", remote, queued);
+  {
+    tracing::Scope scope(remote);
+    tracing::Span task("task");
+  }
+  ASSERT_FALSE(tracing::current().sampled);
+  tracing::stop();
+
+  const auto trace = readTrace();
+  ASSERT_NE(trace.find("\"name\":\"queue\""), std::string::npos);
+  ASSERT_NE(trace.find("\"name\":\"task\""), std::string::npos);
+  ASSERT_NE(trace.find("\"parent\":\"" + hexOf(42) + "\""), std::string::npos);
+}
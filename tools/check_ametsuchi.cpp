@@ -68,13 +68,13 @@ int main(int argc, char* argv[]) {
         auto msg = response.GetRoot()->message();
         auto assets = response.GetRoot()->assets();
         std::cout << "RPC response: " << msg->str() << std::endl;
-        for(const auto& a: *assets){
-            if(reinterpret_cast<const iroha::Asset*>(a)->asset_type() == iroha::AnyAsset::Currency){
-                std::cout << "ledger:" << reinterpret_cast<const iroha::Asset*>(a)->
-                        asset_as_Currency()->ledger_name()->str()
-                    << " domain:" << reinterpret_cast<const iroha::Asset*>(a)->asset_as_Currency()->domain_name()->str()
-                    << " asset:" << reinterpret_cast<const iroha::Asset*>(a)->asset_as_Currency()->currency_name()->str()
-                    << "   amonut:" << reinterpret_cast<const iroha::Asset*>(a)->asset_as_Currency()->amount()->str() << std::endl;
+        for(const auto& wrapper: *assets){
+            auto a = wrapper->asset_nested_root();
+            if(a->asset_type() == iroha::AnyAsset::Currency){
+                std::cout << "ledger:" << a->asset_as_Currency()->ledger_name()->str()
+                    << " domain:" << a->asset_as_Currency()->domain_name()->str()
+                    << " asset:" << a->asset_as_Currency()->currency_name()->str()
+                    << "   amonut:" << a->asset_as_Currency()->amount()->str() << std::endl;
             }
         }
     } else {
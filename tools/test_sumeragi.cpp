@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 #include <endpoint.grpc.fb.h>
+#include <endpoint_generated.h>
 #include <main_generated.h>
 
 using grpc::Channel;
@@ -30,13 +31,56 @@ using grpc::ServerContext;
 using grpc::ClientContext;
 using grpc::Status;
 
+// sends count copies of tx through ToriiStream, batch of them per message
+int stream(iroha::Sumeragi::Stub& stub, const uint8_t* tx, size_t size,
+           size_t count, size_t batch) {
+  grpc::ClientContext context;
+  flatbuffers::BufferRef<iroha::BatchResponse> response;
+  auto writer = stub.ToriiStream(&context, &response);
+
+  flatbuffers::FlatBufferBuilder fbb;
+  for (size_t sent = 0; sent < count;) {
+    const auto n = std::min(batch, count - sent);
+    fbb.Clear();
+    std::vector<flatbuffers::Offset<iroha::TransactionWrapper>> wrappers;
+    for (size_t i = 0; i < n; i++) {
+      wrappers.push_back(iroha::CreateTransactionWrapper(
+          fbb, fbb.CreateVector(tx, size)));
+    }
+    fbb.Finish(iroha::CreateTransactionBatchDirect(fbb, &wrappers));
+    if (!writer->Write(flatbuffers::BufferRef<iroha::TransactionBatch>(
+            fbb.GetBufferPointer(), fbb.GetSize()))) {
+      break;
+    }
+    sent += n;
+  }
+  writer->WritesDone();
+
+  auto status = writer->Finish();
+  if (!status.ok()) {
+    std::cout << "RPC failed: " << status.error_message() << std::endl;
+    return 1;
+  }
+  const auto codes = response.GetRoot()->codes();
+  const auto accepted =
+      codes == nullptr
+          ? 0
+          : std::count(codes->begin(), codes->end(),
+                       static_cast<uint8_t>(iroha::Code::UNDECIDED));
+  std::cout << "accepted " << accepted << " of " << count << std::endl;
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
-  if (argc != 2) {
+  if (argc < 2 || argc > 4) {
     std::cout << "Plz IP " << std::endl;
-    std::cout << "Usage: test_sumeragi  ip-address " << std::endl;
+    std::cout << "Usage: test_sumeragi  ip-address [count [batch]]"
+              << std::endl;
     return 1;
   }
   std::cout << "IP:" << argv[1] << std::endl;
+  const size_t count = argc > 2 ? std::stoul(argv[2]) : 1;
+  const size_t batch = argc > 3 ? std::max(1ul, std::stoul(argv[3])) : 256;
 
 
   auto channel = grpc::CreateChannel(std::string(argv[1]) + ":50051",
@@ -90,6 +134,10 @@ int main(int argc, char* argv[]) {
       &signatureOffset_vec, &hashBlob, datetime::unixtime(),
       iroha::CreateAttachmentDirect(fbb, "none", &dataBlob));
   fbb.Finish(tx_offset);
+  if (count > 1) {
+    return stream(*stub, fbb.GetBufferPointer(), fbb.GetSize(), count, batch);
+  }
+
   auto tx = flatbuffers::BufferRef<iroha::Transaction>(fbb.GetBufferPointer(),
                                                        fbb.GetSize());
 